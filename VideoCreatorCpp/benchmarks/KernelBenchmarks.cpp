@@ -0,0 +1,413 @@
+// 像素与音频热点算子的微基准测试
+// 用法: VideoCreatorBenchmarks [名称过滤子串]
+// 每个用例先预热一次再计时，输出单次耗时与吞吐，便于将替换实现与当前 swscale/libavfilter 基线对比。
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "engine/RenderEngine.h"
+#include "engine/AudioMixKernels.h"
+#include "engine/TimelineAudioMixer.h"
+#include "decoder/AudioDecoder.h"
+#include "decoder/ImageDecoder.h"
+#include "decoder/VideoDecoder.h"
+#include "filter/EffectProcessor.h"
+#include "ffmpeg_utils/AvFrameWrapper.h"
+
+using namespace VideoCreator;
+
+namespace
+{
+    struct Resolution
+    {
+        const char *name;
+        int width;
+        int height;
+    };
+
+    const Resolution kResolutions[] = {
+        {"720p", 1280, 720},
+        {"1080p", 1920, 1080},
+        {"4K", 3840, 2160},
+    };
+
+    const int kLayerCounts[] = {1, 2, 4, 8};
+
+    const double kPi = 3.14159265358979323846;
+
+    std::string g_filter;
+
+    bool selected(const std::string &name)
+    {
+        return g_filter.empty() || name.find(g_filter) != std::string::npos;
+    }
+
+    // 执行 iterations 次 body，units 为每次迭代处理的单位数（帧或样本），用于换算吞吐
+    void runBenchmark(const std::string &name, int iterations, double units, const char *unitName, const std::function<bool()> &body)
+    {
+        if (!selected(name)) {
+            return;
+        }
+        if (!body()) {
+            std::printf("%-48s FAILED (warmup)\n", name.c_str());
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            if (!body()) {
+                std::printf("%-48s FAILED (iteration %d)\n", name.c_str(), i);
+                return;
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        double totalMs = std::chrono::duration<double, std::milli>(end - start).count();
+        double perIterationMs = totalMs / iterations;
+        double throughput = perIterationMs > 0 ? units / (perIterationMs / 1000.0) : 0.0;
+        std::printf("%-48s %10.3f ms/op %14.1f %s/s\n", name.c_str(), perIterationMs, throughput, unitName);
+    }
+
+    FFmpegUtils::AvFramePtr makePatternFrame(int width, int height, AVPixelFormat format)
+    {
+        auto frame = FFmpegUtils::createAvFrame(width, height, format);
+        if (!frame) {
+            return nullptr;
+        }
+        const int planes = (format == AV_PIX_FMT_YUV420P) ? 3 : 1;
+        for (int plane = 0; plane < planes; ++plane) {
+            const int planeHeight = (plane == 0) ? height : (height + 1) / 2;
+            for (int y = 0; y < planeHeight; ++y) {
+                uint8_t *row = frame->data[plane] + y * frame->linesize[plane];
+                for (int x = 0; x < frame->linesize[plane]; ++x) {
+                    row[x] = static_cast<uint8_t>((x * 7 + y * 3 + plane * 50) & 0xFF);
+                }
+            }
+        }
+        frame->color_range = (format == AV_PIX_FMT_YUV420P) ? AVCOL_RANGE_MPEG : AVCOL_RANGE_JPEG;
+        frame->colorspace = AVCOL_SPC_BT709;
+        return frame;
+    }
+
+    // 生成一个 16-bit PCM 立体声 WAV 文件，作为 AudioDecoder 的输入
+    bool writeSineWav(const std::string &path, int sampleRate, double seconds)
+    {
+        const int channels = 2;
+        const uint32_t totalSamples = static_cast<uint32_t>(sampleRate * seconds);
+        const uint32_t dataBytes = totalSamples * channels * 2;
+        std::ofstream out(path, std::ios::binary);
+        if (!out) {
+            return false;
+        }
+        auto put32 = [&](uint32_t v) { out.write(reinterpret_cast<const char *>(&v), 4); };
+        auto put16 = [&](uint16_t v) { out.write(reinterpret_cast<const char *>(&v), 2); };
+        out.write("RIFF", 4);
+        put32(36 + dataBytes);
+        out.write("WAVEfmt ", 8);
+        put32(16);
+        put16(1);
+        put16(channels);
+        put32(static_cast<uint32_t>(sampleRate));
+        put32(static_cast<uint32_t>(sampleRate * channels * 2));
+        put16(channels * 2);
+        put16(16);
+        out.write("data", 4);
+        put32(dataBytes);
+        for (uint32_t i = 0; i < totalSamples; ++i) {
+            int16_t value = static_cast<int16_t>(std::sin(i * 2.0 * kPi * 440.0 / sampleRate) * 12000);
+            put16(static_cast<uint16_t>(value));
+            put16(static_cast<uint16_t>(value));
+        }
+        return static_cast<bool>(out);
+    }
+
+    void benchmarkScaling()
+    {
+        VideoDecoder videoScaler;
+        ImageDecoder imageScaler;
+        auto videoSource = makePatternFrame(3840, 2160, AV_PIX_FMT_YUV420P);
+        auto imageSource = makePatternFrame(4000, 3000, AV_PIX_FMT_RGB24);
+        if (!videoSource || !imageSource) {
+            std::printf("scale: failed to allocate source frames\n");
+            return;
+        }
+
+        for (const auto &res : kResolutions) {
+            runBenchmark(std::string("scale/VideoDecoder/4K-yuv420p->") + res.name, 30, 1, "frames", [&]() {
+                return static_cast<bool>(videoScaler.scaleFrame(videoSource.get(), res.width, res.height, AV_PIX_FMT_YUV420P));
+            });
+
+            auto sameSizeSource = makePatternFrame(res.width, res.height, AV_PIX_FMT_YUV420P);
+            runBenchmark(std::string("scale/VideoDecoder/identity-") + res.name, 30, 1, "frames", [&]() {
+                return static_cast<bool>(videoScaler.scaleFrame(sameSizeSource.get(), res.width, res.height, AV_PIX_FMT_YUV420P));
+            });
+
+            // 同尺寸 full range 源走原地查表压缩到 limited range
+            auto fullRangeSource = makePatternFrame(res.width, res.height, AV_PIX_FMT_YUV420P);
+            fullRangeSource->color_range = AVCOL_RANGE_JPEG;
+            runBenchmark(std::string("scale/VideoDecoder/identity-fullrange-") + res.name, 30, 1, "frames", [&]() {
+                return static_cast<bool>(videoScaler.scaleFrame(fullRangeSource.get(), res.width, res.height, AV_PIX_FMT_YUV420P));
+            });
+
+            runBenchmark(std::string("scale/ImageDecoder/4000x3000-rgb24->") + res.name, 10, 1, "frames", [&]() {
+                return static_cast<bool>(imageScaler.scaleToSize(imageSource, res.width, res.height, AV_PIX_FMT_YUV420P));
+            });
+
+            // performance.scale_threads：按水平条带并行缩放
+            for (int threads : {2, 4, 8}) {
+                const std::string suffix = std::string("-threads") + std::to_string(threads);
+                VideoDecoder threadedVideoScaler;
+                threadedVideoScaler.setScaleThreads(threads);
+                runBenchmark(std::string("scale/VideoDecoder/4K-yuv420p->") + res.name + suffix, 30, 1, "frames", [&]() {
+                    return static_cast<bool>(threadedVideoScaler.scaleFrame(videoSource.get(), res.width, res.height, AV_PIX_FMT_YUV420P));
+                });
+                ImageDecoder threadedImageScaler;
+                threadedImageScaler.setScaleThreads(threads);
+                runBenchmark(std::string("scale/ImageDecoder/4000x3000-rgb24->") + res.name + suffix, 10, 1, "frames", [&]() {
+                    return static_cast<bool>(threadedImageScaler.scaleToSize(imageSource, res.width, res.height, AV_PIX_FMT_YUV420P));
+                });
+            }
+        }
+    }
+
+    void benchmarkEffects()
+    {
+        const int sequenceFrames = 30;
+        const int fps = 30;
+        for (const auto &res : kResolutions) {
+            auto image = makePatternFrame(res.width, res.height, AV_PIX_FMT_YUV420P);
+            auto other = makePatternFrame(res.width, res.height, AV_PIX_FMT_YUV420P);
+            if (!image || !other) {
+                continue;
+            }
+
+            KenBurnsEffect kenBurns;
+            kenBurns.enabled = true;
+            kenBurns.preset = "zoom_in";
+            runBenchmark(std::string("effect/KenBurns/zoom_in-") + res.name, 3, sequenceFrames, "frames", [&]() {
+                EffectProcessor processor;
+                processor.initialize(res.width, res.height, AV_PIX_FMT_YUV420P, fps);
+                if (!processor.startKenBurnsSequence(kenBurns, image.get(), sequenceFrames)) {
+                    return false;
+                }
+                FFmpegUtils::AvFramePtr frame;
+                for (int i = 0; i < sequenceFrames; ++i) {
+                    if (!processor.fetchKenBurnsFrame(frame)) {
+                        return false;
+                    }
+                }
+                return true;
+            });
+
+            const TransitionType transitions[] = {TransitionType::CROSSFADE, TransitionType::WIPE, TransitionType::SLIDE};
+            for (TransitionType type : transitions) {
+                runBenchmark("effect/Transition/" + transitionTypeToString(type) + "-" + res.name, 3, sequenceFrames, "frames", [&]() {
+                    EffectProcessor processor;
+                    processor.initialize(res.width, res.height, AV_PIX_FMT_YUV420P, fps);
+                    if (!processor.startTransitionSequence(type, image.get(), other.get(), sequenceFrames)) {
+                        return false;
+                    }
+                    FFmpegUtils::AvFramePtr frame;
+                    for (int i = 0; i < sequenceFrames; ++i) {
+                        if (!processor.fetchTransitionFrame(frame)) {
+                            return false;
+                        }
+                    }
+                    return true;
+                });
+            }
+        }
+    }
+
+    void benchmarkMixing()
+    {
+        const int chunkSamples = 1024;
+        const int iterations = 400;
+        for (int layerCount : kLayerCounts) {
+            // 预先填充所有迭代所需的样本，计时只覆盖取样、累加与限幅
+            std::vector<std::deque<float>> layers(static_cast<size_t>(layerCount) * 2);
+            for (auto &queue : layers) {
+                for (int i = 0; i < chunkSamples * (iterations + 1); ++i) {
+                    queue.push_back(std::sin(i * 0.01f) * 0.3f);
+                }
+            }
+            std::vector<float> left(chunkSamples);
+            std::vector<float> right(chunkSamples);
+            std::vector<float> outLeft(chunkSamples);
+            std::vector<float> outRight(chunkSamples);
+
+            runBenchmark("audio/AudioMixKernels/accumulate-layers-" + std::to_string(layerCount), iterations, chunkSamples, "samples", [&]() {
+                std::fill(left.begin(), left.end(), 0.0f);
+                std::fill(right.begin(), right.end(), 0.0f);
+                for (int layer = 0; layer < layerCount; ++layer) {
+                    AudioMixKernels::accumulateFromQueue(layers[layer * 2], left.data(), chunkSamples);
+                    AudioMixKernels::accumulateFromQueue(layers[layer * 2 + 1], right.data(), chunkSamples);
+                }
+                AudioMixKernels::clampToPlanar(left.data(), outLeft.data(), chunkSamples);
+                AudioMixKernels::clampToPlanar(right.data(), outRight.data(), chunkSamples);
+                return true;
+            });
+
+            // 非单位音量 + 淡入：覆盖图层增益包络路径（约一半迭代处于淡入区间）
+            for (auto &queue : layers) {
+                queue.clear();
+                for (int i = 0; i < chunkSamples * (iterations + 1); ++i) {
+                    queue.push_back(std::sin(i * 0.01f) * 0.3f);
+                }
+            }
+            const auto envelope = AudioMixKernels::GainEnvelope::fromSeconds(0.6, chunkSamples * iterations / 2.0 / 44100.0, 0.0, 0.0, 44100);
+            std::vector<float> gains(chunkSamples);
+            int64_t position = 0;
+            runBenchmark("audio/AudioMixKernels/gain-layers-" + std::to_string(layerCount), iterations, chunkSamples, "samples", [&]() {
+                std::fill(left.begin(), left.end(), 0.0f);
+                std::fill(right.begin(), right.end(), 0.0f);
+                AudioMixKernels::fillGain(envelope, position, gains.data(), chunkSamples);
+                for (int layer = 0; layer < layerCount; ++layer) {
+                    AudioMixKernels::accumulateFromQueueWithGain(layers[layer * 2], left.data(), gains.data(), chunkSamples);
+                    AudioMixKernels::accumulateFromQueueWithGain(layers[layer * 2 + 1], right.data(), gains.data(), chunkSamples);
+                }
+                position += chunkSamples;
+                AudioMixKernels::clampToPlanar(left.data(), outLeft.data(), chunkSamples);
+                AudioMixKernels::clampToPlanar(right.data(), outRight.data(), chunkSamples);
+                return true;
+            });
+        }
+    }
+
+    void benchmarkAudioDecode(const std::filesystem::path &workDir)
+    {
+        const double seconds = 10.0;
+        const int sampleRates[] = {44100, 48000};
+        for (int sampleRate : sampleRates) {
+            const std::string wavPath = (workDir / ("bench_" + std::to_string(sampleRate) + ".wav")).string();
+            if (!writeSineWav(wavPath, sampleRate, seconds)) {
+                std::printf("audio: failed to write %s\n", wavPath.c_str());
+                continue;
+            }
+            // 输出 44100 Hz（旧的固定采样率）与输出源采样率两种情况；后者跳过采样率转换
+            std::vector<int> outputRates{44100};
+            if (sampleRate != 44100) {
+                outputRates.push_back(sampleRate);
+            }
+            for (int outputRate : outputRates) {
+                const std::string name = "audio/AudioDecoder::decodeFrame/" + std::to_string(sampleRate) + "Hz->" + std::to_string(outputRate) + "Hz";
+                runBenchmark(name, 5, seconds, "audio-seconds", [&]() {
+                    AudioDecoder decoder;
+                    if (!decoder.open(wavPath, outputRate)) {
+                        return false;
+                    }
+                    while (true) {
+                        FFmpegUtils::AvFramePtr frame;
+                        int ret = decoder.decodeFrame(frame);
+                        if (ret == 0) {
+                            return true;
+                        }
+                        if (ret < 0) {
+                            return false;
+                        }
+                    }
+                });
+            }
+        }
+    }
+
+    // 单场景工程：旁白 + (layerCount - 1) 个 audio_layers，全部取自同一 WAV
+    ProjectConfig makeAudioProject(const std::string &wavPath, double seconds, int layerCount)
+    {
+        ProjectConfig config;
+        SceneConfig scene;
+        scene.id = 1;
+        scene.duration = seconds;
+        scene.resources.audio.path = wavPath;
+        for (int layer = 1; layer < layerCount; ++layer) {
+            AudioConfig audioLayer;
+            audioLayer.path = wavPath;
+            audioLayer.volume = 0.5;
+            scene.resources.audio_layers.push_back(audioLayer);
+        }
+        config.scenes.push_back(scene);
+        return config;
+    }
+
+    void benchmarkTimelineMixing(const std::filesystem::path &workDir)
+    {
+        const int sampleRate = 44100;
+        const double seconds = 10.0;
+        const std::string wavPath = (workDir / "bench_timeline.wav").string();
+        if (!writeSineWav(wavPath, sampleRate, seconds)) {
+            std::printf("audio: failed to write %s\n", wavPath.c_str());
+            return;
+        }
+        // 渲染与预览共用的混音路径：场景图层解码、增益、累加与限幅
+        const int chunkSamples = 1024;
+        std::vector<float> left(chunkSamples);
+        std::vector<float> right(chunkSamples);
+        for (int layerCount : kLayerCounts) {
+            const ProjectConfig config = makeAudioProject(wavPath, seconds, layerCount);
+            runBenchmark("audio/TimelineAudioMixer::read/layers-" + std::to_string(layerCount), 3, seconds, "audio-seconds", [&]() {
+                TimelineAudioMixer mixer;
+                if (!mixer.open(config, sampleRate)) {
+                    return false;
+                }
+                while (true) {
+                    const int produced = mixer.read(chunkSamples, left.data(), right.data());
+                    if (produced <= 0) {
+                        return produced == 0;
+                    }
+                }
+            });
+        }
+    }
+
+    void benchmarkAudioEncode(const std::filesystem::path &workDir)
+    {
+        const int sampleRate = 44100;
+        const double seconds = 10.0;
+        const std::string wavPath = (workDir / "bench_encode.wav").string();
+        if (!writeSineWav(wavPath, sampleRate, seconds)) {
+            std::printf("audio: failed to write %s\n", wavPath.c_str());
+            return;
+        }
+        // 纯音频导出经 sendBufferedAudioFrames 编码整条时间线，不创建视频流
+        ProjectConfig config = makeAudioProject(wavPath, seconds, 1);
+        config.output.mode = "m4a";
+        config.project.output_path = (workDir / "bench_audio_encode.m4a").string();
+
+        runBenchmark("audio/sendBufferedAudioFrames/render-m4a", 3, seconds, "audio-seconds", [&]() {
+            RenderEngine engine;
+            if (!engine.initialize(config)) {
+                std::printf("audio/sendBufferedAudioFrames: initialize failed: %s\n", engine.errorString().c_str());
+                return false;
+            }
+            return engine.render();
+        });
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1) {
+        g_filter = argv[1];
+    }
+
+    std::error_code ec;
+    std::filesystem::path workDir = std::filesystem::temp_directory_path(ec) / "videocreator_bench";
+    std::filesystem::create_directories(workDir, ec);
+
+    std::printf("VideoCreatorCpp kernel benchmarks%s%s\n", g_filter.empty() ? "" : " | filter: ", g_filter.c_str());
+    benchmarkScaling();
+    benchmarkEffects();
+    benchmarkMixing();
+    benchmarkTimelineMixing(workDir);
+    benchmarkAudioDecode(workDir);
+    benchmarkAudioEncode(workDir);
+
+    std::filesystem::remove_all(workDir, ec);
+    return 0;
+}
@@ -1,6 +1,8 @@
 #include "VideoCreatorAPI.h"
 
 #include <mutex>
+#include <cstdio>
+#include <cstring>
 #include <QString>
 
 #include "model/ConfigLoader.h"
@@ -38,9 +40,13 @@ namespace VideoCreator
             return true;
         }
 
-        bool renderWithConfig(const ProjectConfig &config, std::string *error)
+        bool renderWithConfig(const ProjectConfig &config, std::string *error, const OutputSink *sink = nullptr)
         {
             RenderEngine engine;
+            if (sink)
+            {
+                engine.setOutputSink(*sink);
+            }
             if (!engine.initialize(config))
             {
                 if (error)
@@ -59,6 +65,67 @@ namespace VideoCreator
             }
             return true;
         }
+
+        bool loadConfigFromString(const std::string &json_string, ProjectConfig &config, std::string *error)
+        {
+            ConfigLoader loader;
+            if (!loader.loadFromString(QString::fromStdString(json_string), config))
+            {
+                if (error)
+                {
+                    *error = loader.errorString().toStdString();
+                }
+                return false;
+            }
+            return true;
+        }
+
+        // 可增长的内存输出，支持定位以便封装器回写 moov
+        class BufferSink
+        {
+        public:
+            explicit BufferSink(std::vector<uint8_t> &buffer) : m_buffer(buffer), m_position(0) {}
+
+            int write(const uint8_t *data, int size)
+            {
+                const size_t end = m_position + static_cast<size_t>(size);
+                if (end > m_buffer.size())
+                {
+                    m_buffer.resize(end);
+                }
+                std::memcpy(m_buffer.data() + m_position, data, static_cast<size_t>(size));
+                m_position = end;
+                return size;
+            }
+
+            int64_t seek(int64_t offset, int whence)
+            {
+                int64_t base = 0;
+                if (whence == SEEK_CUR)
+                {
+                    base = static_cast<int64_t>(m_position);
+                }
+                else if (whence == SEEK_END)
+                {
+                    base = static_cast<int64_t>(m_buffer.size());
+                }
+                else if (whence != SEEK_SET)
+                {
+                    return -1;
+                }
+                const int64_t target = base + offset;
+                if (target < 0)
+                {
+                    return -1;
+                }
+                m_position = static_cast<size_t>(target);
+                return target;
+            }
+
+        private:
+            std::vector<uint8_t> &m_buffer;
+            size_t m_position;
+        };
     } // namespace
 
     bool RenderFromJson(const std::string &config_path, std::string *error)
@@ -102,4 +169,49 @@ namespace VideoCreator
 
         return renderWithConfig(config, error);
     }
+
+    bool RenderToBuffer(const std::string &json_string, std::vector<uint8_t> &output, std::string *error)
+    {
+        if (!ensureFFmpegInitialized(error))
+        {
+            return false;
+        }
+
+        ProjectConfig config;
+        if (!loadConfigFromString(json_string, config, error))
+        {
+            return false;
+        }
+
+        output.clear();
+        BufferSink bufferSink(output);
+        OutputSink sink;
+        sink.write = [&bufferSink](const uint8_t *data, int size) { return bufferSink.write(data, size); };
+        sink.seek = [&bufferSink](int64_t offset, int whence) { return bufferSink.seek(offset, whence); };
+        return renderWithConfig(config, error, &sink);
+    }
+
+    bool RenderToSink(const std::string &json_string, const OutputSink &sink, std::string *error)
+    {
+        if (!sink.write)
+        {
+            if (error)
+            {
+                *error = "OutputSink.write is not set";
+            }
+            return false;
+        }
+        if (!ensureFFmpegInitialized(error))
+        {
+            return false;
+        }
+
+        ProjectConfig config;
+        if (!loadConfigFromString(json_string, config, error))
+        {
+            return false;
+        }
+
+        return renderWithConfig(config, error, &sink);
+    }
 } // namespace VideoCreator
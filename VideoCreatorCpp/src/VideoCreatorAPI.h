@@ -2,6 +2,10 @@
 #define VIDEO_CREATOR_API_H
 
 #include <string>
+#include <vector>
+#include <cstdint>
+
+#include "engine/OutputSink.h"
 
 namespace VideoCreator
 {
@@ -10,6 +14,12 @@ namespace VideoCreator
 
     // 从 JSON 字符串渲染视频，返回成功/失败，错误信息写入 error（可选）
     bool RenderFromJsonString(const std::string &json_string, std::string *error = nullptr);
+
+    // 从 JSON 字符串渲染到内存缓冲区（可寻址，输出普通 MP4；配置 fragmented_mp4 时输出分片 MP4），忽略 output_path
+    bool RenderToBuffer(const std::string &json_string, std::vector<uint8_t> &output, std::string *error = nullptr);
+
+    // 从 JSON 字符串渲染到自定义输出目标，忽略 output_path；sink.seek 为空时输出分片 MP4
+    bool RenderToSink(const std::string &json_string, const OutputSink &sink, std::string *error = nullptr);
 }
 
 #endif // VIDEO_CREATOR_API_H
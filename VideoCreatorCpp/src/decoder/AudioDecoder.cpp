@@ -1,7 +1,6 @@
 #include "AudioDecoder.h"
 #include "ffmpeg_utils/AvPacketWrapper.h"
 #include <QDebug>
-#include <sstream>
 #include <cmath>
 
 namespace VideoCreator
@@ -9,8 +8,7 @@ namespace VideoCreator
 
     AudioDecoder::AudioDecoder()
         : m_formatContext(nullptr), m_codecContext(nullptr), m_audioStreamIndex(-1),
-          m_swrCtx(nullptr), m_filterGraph(nullptr), m_bufferSrcCtx(nullptr), m_bufferSinkCtx(nullptr),
-          m_effectsEnabled(false), m_sampleRate(0), m_channels(0), m_sampleFormat(AV_SAMPLE_FMT_NONE), m_duration(0)
+          m_swrCtx(nullptr), m_sampleRate(0), m_outputSampleRate(44100), m_channels(0), m_sampleFormat(AV_SAMPLE_FMT_NONE), m_duration(0)
     {
     }
 
@@ -19,8 +17,10 @@ namespace VideoCreator
         cleanup();
     }
 
-    bool AudioDecoder::open(const std::string &filePath)
+    bool AudioDecoder::open(const std::string &filePath, int outputSampleRate)
     {
+        m_outputSampleRate = outputSampleRate > 0 ? outputSampleRate : 44100;
+
         // 打开输入文件
         if (avformat_open_input(&m_formatContext, filePath.c_str(), nullptr, nullptr) < 0)
         {
@@ -88,27 +88,39 @@ namespace VideoCreator
         m_sampleFormat = m_codecContext->sample_fmt;
         m_duration = audioStream->duration;
 
-        // 初始化 SwrContext
+        // SwrContext 延迟到第一个格式不匹配的帧再创建，48 kHz 素材配 48 kHz 工程时全程直通
+        return true;
+    }
+
+    bool AudioDecoder::matchesOutputFormat(const AVFrame *frame) const
+    {
+        return frame->format == AV_SAMPLE_FMT_FLTP
+            && frame->sample_rate == m_outputSampleRate
+            && frame->ch_layout.nb_channels == 2;
+    }
+
+    bool AudioDecoder::initResampler(const AVFrame *frame)
+    {
         m_swrCtx = swr_alloc();
         if (!m_swrCtx)
         {
             m_errorString = "无法分配 SwrContext";
-            cleanup();
             return false;
         }
-        
+
         AVChannelLayout in_ch_layout, out_ch_layout;
-        av_channel_layout_default(&in_ch_layout, m_codecContext->ch_layout.nb_channels);
+        const int inChannels = frame->ch_layout.nb_channels > 0 ? frame->ch_layout.nb_channels : m_channels;
+        av_channel_layout_default(&in_ch_layout, inChannels);
         av_channel_layout_default(&out_ch_layout, 2);
 
         av_opt_set_chlayout(m_swrCtx, "in_chlayout", &in_ch_layout, 0);
-        av_opt_set_int(m_swrCtx, "in_sample_rate", m_sampleRate, 0);
-        av_opt_set_sample_fmt(m_swrCtx, "in_sample_fmt", m_sampleFormat, 0);
-        
+        av_opt_set_int(m_swrCtx, "in_sample_rate", frame->sample_rate > 0 ? frame->sample_rate : m_sampleRate, 0);
+        av_opt_set_sample_fmt(m_swrCtx, "in_sample_fmt", static_cast<AVSampleFormat>(frame->format), 0);
+
         av_opt_set_chlayout(m_swrCtx, "out_chlayout", &out_ch_layout, 0);
-        av_opt_set_int(m_swrCtx, "out_sample_rate", 44100, 0);
+        av_opt_set_int(m_swrCtx, "out_sample_rate", m_outputSampleRate, 0);
         av_opt_set_sample_fmt(m_swrCtx, "out_sample_fmt", AV_SAMPLE_FMT_FLTP, 0);
-        
+
         av_channel_layout_uninit(&in_ch_layout);
         av_channel_layout_uninit(&out_ch_layout);
 
@@ -116,121 +128,8 @@ namespace VideoCreator
         {
             m_errorString = "无法初始化 SwrContext";
             swr_free(&m_swrCtx);
-            cleanup();
-            return false;
-        }
-
-        return true;
-    }
-
-    bool AudioDecoder::applyVolumeEffect(const SceneConfig& sceneConfig)
-    {
-        double trackDuration = sceneConfig.duration > 0 ? sceneConfig.duration : getDuration();
-        const VolumeMixEffect* effect = sceneConfig.effects.volume_mix.enabled ? &sceneConfig.effects.volume_mix : nullptr;
-        return applyVolumeEffect(sceneConfig.resources.audio.volume, effect, trackDuration);
-    }
-
-    bool AudioDecoder::applyVolumeEffect(double baseVolume, const VolumeMixEffect* effect, double trackDurationSeconds)
-    {
-        const bool effectEnabled = effect && effect->enabled;
-        const bool volumeEnabled = std::abs(baseVolume - 1.0) > 1e-3;
-        m_effectsEnabled = effectEnabled || volumeEnabled;
-        if (m_effectsEnabled)
-        {
-            return initFilterGraph(baseVolume, effectEnabled ? effect : nullptr, trackDurationSeconds);
-        }
-        return true;
-    }
-
-    bool AudioDecoder::initFilterGraph(double baseVolume, const VolumeMixEffect* effect, double trackDurationSeconds)
-    {
-        if (m_filterGraph) {
-            avfilter_graph_free(&m_filterGraph);
-            m_filterGraph = nullptr;
-            m_bufferSrcCtx = nullptr;
-            m_bufferSinkCtx = nullptr;
-        }
-
-        m_filterGraph = avfilter_graph_alloc();
-        if (!m_filterGraph) {
-            m_errorString = "Failed to allocate filter graph";
-            return false;
-        }
-
-        const AVFilter *abuffer_src = avfilter_get_by_name("abuffer");
-        const AVFilter *abuffer_sink = avfilter_get_by_name("abuffersink");
-
-        AVChannelLayout out_ch_layout;
-        int64_t out_sample_rate;
-        av_opt_get_chlayout(m_swrCtx, "out_chlayout", 0, &out_ch_layout);
-        av_opt_get_int(m_swrCtx, "out_sample_rate", 0, &out_sample_rate);
-
-        std::stringstream args;
-        args << "time_base=1/" << out_sample_rate
-             << ":sample_rate=" << out_sample_rate
-             << ":sample_fmt=" << av_get_sample_fmt_name(AV_SAMPLE_FMT_FLTP)
-             << ":channel_layout=" << out_ch_layout.u.mask;
-
-        int ret = avfilter_graph_create_filter(&m_bufferSrcCtx, abuffer_src, "in", args.str().c_str(), nullptr, m_filterGraph);
-        if (ret < 0) {
-            m_errorString = "Failed to create source filter";
-            av_channel_layout_uninit(&out_ch_layout);
-            return false;
-        }
-        av_channel_layout_uninit(&out_ch_layout);
-
-        ret = avfilter_graph_create_filter(&m_bufferSinkCtx, abuffer_sink, "out", nullptr, nullptr, m_filterGraph);
-        if (ret < 0) {
-            m_errorString = "Failed to create sink filter";
-            return false;
-        }
-
-        std::stringstream filter_spec;
-        if (effect && effect->enabled) {
-            if (effect->fade_in > 0) {
-                filter_spec << "afade=t=in:d=" << effect->fade_in << ",";
-            }
-            if (effect->fade_out > 0) {
-                double referenceDuration = trackDurationSeconds > 0 ? trackDurationSeconds : getDuration();
-                double fadeStart = referenceDuration > effect->fade_out ? (referenceDuration - effect->fade_out) : 0.0;
-                filter_spec << "afade=t=out:st=" << fadeStart << ":d=" << effect->fade_out << ",";
-            }
-        }
-        filter_spec << "volume=" << baseVolume;
-
-        AVFilterInOut *outputs = avfilter_inout_alloc();
-        AVFilterInOut *inputs = avfilter_inout_alloc();
-        if (!outputs || !inputs) {
-            m_errorString = "Failed to allocate filter inout";
-            avfilter_inout_free(&outputs);
-            avfilter_inout_free(&inputs);
             return false;
         }
-
-        outputs->name = av_strdup("in");
-        outputs->filter_ctx = m_bufferSrcCtx;
-        outputs->pad_idx = 0;
-        outputs->next = nullptr;
-
-        inputs->name = av_strdup("out");
-        inputs->filter_ctx = m_bufferSinkCtx;
-        inputs->pad_idx = 0;
-        inputs->next = nullptr;
-
-        ret = avfilter_graph_parse_ptr(m_filterGraph, filter_spec.str().c_str(), &inputs, &outputs, nullptr);
-        if (ret < 0) {
-            m_errorString = "Failed to parse filter chain";
-            avfilter_inout_free(&outputs);
-            avfilter_inout_free(&inputs);
-            return false;
-        }
-
-        ret = avfilter_graph_config(m_filterGraph, nullptr);
-        if (ret < 0) {
-            m_errorString = "Failed to configure filter graph";
-            return false;
-        }
-
         return true;
     }
 
@@ -255,39 +154,9 @@ namespace VideoCreator
             return -1;
         }
 
-        bool decoderDrained = false;
-
         while (true) {
-            if (m_effectsEnabled) {
-                auto filteredFrame = FFmpegUtils::createAvFrame();
-                if (!filteredFrame) {
-                    m_errorString = "Failed to allocate filtered frame";
-                    return -1;
-                }
-                int ret = av_buffersink_get_frame(m_bufferSinkCtx, filteredFrame.get());
-                if (ret == 0) {
-                    outFrame = std::move(filteredFrame);
-                    return 1;
-                }
-                if (ret == AVERROR_EOF && decoderDrained) {
-                    return 0;
-                }
-                if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
-                    m_errorString = "Failed to pull frame from filter graph";
-                    return -1;
-                }
-            }
-
             int ret = avcodec_receive_frame(m_codecContext, rawFrame.get());
             if (ret == AVERROR_EOF) {
-                decoderDrained = true;
-                if (m_effectsEnabled) {
-                    if (av_buffersrc_add_frame(m_bufferSrcCtx, nullptr) < 0) {
-                        m_errorString = "Failed to signal EOF to filter graph";
-                        return -1;
-                    }
-                    continue;
-                }
                 return 0;
             }
             if (ret == AVERROR(EAGAIN)) {
@@ -316,32 +185,37 @@ namespace VideoCreator
                 return -1;
             }
 
+            const AVRational outputTimeBase{1, m_outputSampleRate};
+            if (matchesOutputFormat(rawFrame.get())) {
+                // 直通：源已是输出格式，跳过 swr_convert 与额外的帧拷贝
+                if (rawFrame->pts != AV_NOPTS_VALUE) {
+                    rawFrame->pts = av_rescale_q(rawFrame->pts, m_formatContext->streams[m_audioStreamIndex]->time_base, outputTimeBase);
+                }
+                outFrame = std::move(rawFrame);
+                return 1;
+            }
+
+            if (!m_swrCtx && !initResampler(rawFrame.get())) {
+                return -1;
+            }
+
             auto resampled_frame = FFmpegUtils::createAvFrame();
             if (!resampled_frame) {
                 m_errorString = "Failed to allocate resampled frame";
                 return -1;
             }
 
-            AVChannelLayout out_ch_layout;
-            int64_t out_sample_rate;
-            AVSampleFormat out_sample_fmt;
-            av_opt_get_chlayout(m_swrCtx, "out_chlayout", 0, &out_ch_layout);
-            av_opt_get_int(m_swrCtx, "out_sample_rate", 0, &out_sample_rate);
-            av_opt_get_sample_fmt(m_swrCtx, "out_sample_fmt", 0, &out_sample_fmt);
-
-            resampled_frame->nb_samples = static_cast<int>(av_rescale_rnd(swr_get_delay(m_swrCtx, rawFrame->sample_rate) + rawFrame->nb_samples, out_sample_rate, rawFrame->sample_rate, AV_ROUND_UP));
-            resampled_frame->ch_layout = out_ch_layout;
-            resampled_frame->format = out_sample_fmt;
-            resampled_frame->sample_rate = static_cast<int>(out_sample_rate);
+            resampled_frame->nb_samples = static_cast<int>(av_rescale_rnd(swr_get_delay(m_swrCtx, rawFrame->sample_rate) + rawFrame->nb_samples, m_outputSampleRate, rawFrame->sample_rate, AV_ROUND_UP));
+            av_channel_layout_default(&resampled_frame->ch_layout, 2);
+            resampled_frame->format = AV_SAMPLE_FMT_FLTP;
+            resampled_frame->sample_rate = m_outputSampleRate;
 
             if (av_frame_get_buffer(resampled_frame.get(), 0) < 0) {
-                av_channel_layout_uninit(&out_ch_layout);
                 m_errorString = "Failed to allocate buffer for resampled audio";
                 return -1;
             }
 
             int converted_samples = swr_convert(m_swrCtx, resampled_frame->data, resampled_frame->nb_samples, (const uint8_t **)rawFrame->data, rawFrame->nb_samples);
-            av_channel_layout_uninit(&out_ch_layout);
             if (converted_samples < 0) {
                 m_errorString = "swr_convert failed";
                 return -1;
@@ -349,19 +223,11 @@ namespace VideoCreator
             resampled_frame->nb_samples = converted_samples;
 
             if (rawFrame->pts != AV_NOPTS_VALUE) {
-                resampled_frame->pts = av_rescale_q(rawFrame->pts, m_formatContext->streams[m_audioStreamIndex]->time_base, AVRational{1, static_cast<int>(out_sample_rate)});
+                resampled_frame->pts = av_rescale_q(rawFrame->pts, m_formatContext->streams[m_audioStreamIndex]->time_base, outputTimeBase);
             }
 
-            if (m_effectsEnabled) {
-                if (av_buffersrc_add_frame(m_bufferSrcCtx, resampled_frame.get()) < 0) {
-                    m_errorString = "Failed to send frame to filter graph";
-                    return -1;
-                }
-                continue;
-            } else {
-                outFrame = std::move(resampled_frame);
-                return 1;
-            }
+            outFrame = std::move(resampled_frame);
+            return 1;
         }
     }
 
@@ -399,10 +265,6 @@ namespace VideoCreator
             swr_free(&m_swrCtx);
             m_swrCtx = nullptr;
         }
-        if (m_filterGraph) {
-            avfilter_graph_free(&m_filterGraph);
-            m_filterGraph = nullptr; // m_bufferSrcCtx and m_bufferSinkCtx are freed with the graph
-        }
         m_audioStreamIndex = -1;
     }
 
@@ -17,14 +17,10 @@ namespace VideoCreator
         AudioDecoder();
         ~AudioDecoder();
 
-        // 打开音频文件
-        bool open(const std::string &filePath);
+        // 打开音频文件，输出统一为 outputSampleRate 的 FLTP 立体声
+        bool open(const std::string &filePath, int outputSampleRate = 44100);
 
-        // 应用音量效果
-        bool applyVolumeEffect(const SceneConfig& sceneConfig);
-        bool applyVolumeEffect(double baseVolume, const VolumeMixEffect* effect, double trackDurationSeconds);
-
-        // 尝试解码下一帧音频，重采样并应用效果后返回
+        // 尝试解码下一帧音频，重采样后返回
         // 返回值: >0 表示成功, 0 表示文件结束(EOF), <0 表示错误
         int decodeFrame(FFmpegUtils::AvFramePtr &frame);
 
@@ -34,6 +30,10 @@ namespace VideoCreator
         // 获取音频采样格式
         AVSampleFormat getSampleFormat() const { return m_sampleFormat; }
 
+        // 源采样率 / 输出采样率
+        int getSampleRate() const { return m_sampleRate; }
+        int getOutputSampleRate() const { return m_outputSampleRate; }
+
         // 获取音频时长（秒）
         double getDuration() const;
 
@@ -44,23 +44,21 @@ namespace VideoCreator
         std::string getErrorString() const { return m_errorString; }
 
     private:
-        // 初始化Filter Graph
-        bool initFilterGraph(double baseVolume, const VolumeMixEffect* effect, double trackDurationSeconds);
+        // 解码帧已是输出格式（FLTP 立体声、采样率一致）时无需 swr_convert
+        bool matchesOutputFormat(const AVFrame *frame) const;
+
+        // 按首个需要转换的帧初始化 SwrContext（直通的源永远不会创建）
+        bool initResampler(const AVFrame *frame);
 
         // FFmpeg资源
         AVFormatContext *m_formatContext;
         AVCodecContext *m_codecContext;
         int m_audioStreamIndex;
         struct SwrContext *m_swrCtx;
-        
-        // Filter graph 资源
-        AVFilterGraph *m_filterGraph;
-        AVFilterContext *m_bufferSrcCtx;
-        AVFilterContext *m_bufferSinkCtx;
-        bool m_effectsEnabled = false; // 是否启用效果
 
         // 音频信息
         int m_sampleRate;
+        int m_outputSampleRate;
         int m_channels;
         AVSampleFormat m_sampleFormat;
         int64_t m_duration;
@@ -0,0 +1,99 @@
+#include "FrameScaler.h"
+#include <algorithm>
+
+namespace VideoCreator
+{
+
+    FrameScaler::~FrameScaler()
+    {
+        reset();
+    }
+
+    void FrameScaler::setThreadCount(int threads)
+    {
+        threads = std::max(1, threads);
+        if (threads != m_threads)
+        {
+            m_threads = threads;
+            reset();
+        }
+    }
+
+    void FrameScaler::reset()
+    {
+        if (m_context)
+        {
+            sws_freeContext(m_context);
+            m_context = nullptr;
+        }
+        m_srcWidth = m_srcHeight = m_dstWidth = m_dstHeight = 0;
+        m_srcFormat = m_dstFormat = AV_PIX_FMT_NONE;
+    }
+
+    bool FrameScaler::ensureContext(const AVFrame *src, const AVFrame *dst)
+    {
+        if (m_context && src->width == m_srcWidth && src->height == m_srcHeight && src->format == m_srcFormat &&
+            dst->width == m_dstWidth && dst->height == m_dstHeight && dst->format == m_dstFormat)
+        {
+            return true;
+        }
+
+        reset();
+        // sws_getCachedContext 无法设置 threads，这里通过 AVOption 创建上下文
+        m_context = sws_alloc_context();
+        if (!m_context)
+        {
+            m_errorString = "创建视频缩放上下文失败";
+            return false;
+        }
+        av_opt_set_int(m_context, "srcw", src->width, 0);
+        av_opt_set_int(m_context, "srch", src->height, 0);
+        av_opt_set_int(m_context, "src_format", src->format, 0);
+        av_opt_set_int(m_context, "dstw", dst->width, 0);
+        av_opt_set_int(m_context, "dsth", dst->height, 0);
+        av_opt_set_int(m_context, "dst_format", dst->format, 0);
+        av_opt_set_int(m_context, "sws_flags", SWS_BILINEAR, 0);
+        av_opt_set_int(m_context, "threads", m_threads, 0);
+        if (sws_init_context(m_context, nullptr, nullptr) < 0)
+        {
+            sws_freeContext(m_context);
+            m_context = nullptr;
+            m_errorString = "初始化视频缩放上下文失败";
+            return false;
+        }
+
+        m_srcWidth = src->width;
+        m_srcHeight = src->height;
+        m_srcFormat = src->format;
+        m_dstWidth = dst->width;
+        m_dstHeight = dst->height;
+        m_dstFormat = dst->format;
+        return true;
+    }
+
+    bool FrameScaler::scale(const AVFrame *src, AVFrame *dst, bool srcFullRange, int colorspace)
+    {
+        if (!src || !dst)
+        {
+            m_errorString = "缩放输入或输出帧为空";
+            return false;
+        }
+        if (!ensureContext(src, dst))
+        {
+            return false;
+        }
+
+        // 对多线程上下文，libswscale 会把色彩参数同步到每个条带的内部上下文
+        const int *coeffs = sws_getCoefficients(colorspace);
+        sws_setColorspaceDetails(m_context, coeffs, srcFullRange ? 1 : 0, coeffs, 0, 0, 0, 0);
+
+        // sws_scale_frame 走 send/receive slice 接口，只有它会把条带分发到线程池；sws_scale 始终单线程
+        if (sws_scale_frame(m_context, dst, src) < 0)
+        {
+            m_errorString = "视频缩放失败";
+            return false;
+        }
+        return true;
+    }
+
+} // namespace VideoCreator
@@ -0,0 +1,47 @@
+#ifndef FRAME_SCALER_H
+#define FRAME_SCALER_H
+
+#include <string>
+#include "ffmpeg_utils/FFmpegHeaders.h"
+
+namespace VideoCreator
+{
+
+    // 带缓存的 swscale 上下文，VideoDecoder 与 ImageDecoder 共用
+    // 线程数大于 1 时启用 libswscale 的 threads 选项：目标帧按水平条带切分，各条带使用独立的内部上下文并行缩放
+    class FrameScaler
+    {
+    public:
+        FrameScaler() = default;
+        ~FrameScaler();
+
+        FrameScaler(const FrameScaler &) = delete;
+        FrameScaler &operator=(const FrameScaler &) = delete;
+
+        // 设置缩放线程数（至少为 1），下次缩放时按新线程数重建上下文
+        void setThreadCount(int threads);
+        int threadCount() const { return m_threads; }
+
+        // 将 src 缩放/转换到已分配好的 dst；两侧使用相同的 YUV 系数，只做 srcFullRange -> limited range 的范围转换
+        bool scale(const AVFrame *src, AVFrame *dst, bool srcFullRange, int colorspace);
+
+        void reset();
+        std::string getErrorString() const { return m_errorString; }
+
+    private:
+        bool ensureContext(const AVFrame *src, const AVFrame *dst);
+
+        SwsContext *m_context = nullptr;
+        int m_threads = 1;
+        int m_srcWidth = 0;
+        int m_srcHeight = 0;
+        int m_srcFormat = AV_PIX_FMT_NONE;
+        int m_dstWidth = 0;
+        int m_dstHeight = 0;
+        int m_dstFormat = AV_PIX_FMT_NONE;
+        std::string m_errorString;
+    };
+
+} // namespace VideoCreator
+
+#endif // FRAME_SCALER_H
@@ -7,7 +7,7 @@ namespace VideoCreator
 
     ImageDecoder::ImageDecoder()
         : m_formatContext(nullptr), m_codecContext(nullptr), m_videoStreamIndex(-1),
-          m_width(0), m_height(0), m_pixelFormat(AV_PIX_FMT_NONE), m_swsContext(nullptr), m_cachedFrame(nullptr)
+          m_width(0), m_height(0), m_pixelFormat(AV_PIX_FMT_NONE), m_cachedFrame(nullptr)
     {
     }
 
@@ -195,32 +195,16 @@ namespace VideoCreator
             return nullptr;
         }
     
-        // 创建缩放上下文
-        m_swsContext = sws_getCachedContext(m_swsContext,
-                                           frame->width, frame->height, (AVPixelFormat)frame->format,
-                                           targetWidth, targetHeight, targetFormat,
-                                           SWS_BILINEAR, nullptr, nullptr, nullptr);
-        if (!m_swsContext)
-        {
-            m_errorString = "无法创建缩放上下文";
-            return nullptr;
-        }
-    
         // --- 开始颜色空间修复 ---
         // 确定源色彩范围 (0 for limited/MPEG, 1 for full/JPEG)
         int srcRange = (frame->color_range == AVCOL_RANGE_MPEG) ? 0 : 1;
-        // 目标色彩范围总是 limited range for video pipeline
-        int dstRange = 0;
+        // 目标色彩范围总是 limited range for video pipeline（由 FrameScaler 固定）
     
         // 获取色彩矩阵系数, 基于色彩空间 (e.g., BT.709, BT.601)
         int colorspace = frame->colorspace;
         if (colorspace == AVCOL_SPC_UNSPECIFIED) {
             colorspace = (frame->height >= 720) ? AVCOL_SPC_BT709 : AVCOL_SPC_SMPTE170M;
         }
-        const int *coeffs = sws_getCoefficients(colorspace);
-    
-        // 设置色彩空间和范围转换细节
-        sws_setColorspaceDetails(m_swsContext, coeffs, srcRange, coeffs, dstRange, 0, 0, 0);
         // --- 结束颜色空间修复 ---
     
         // 创建目标帧
@@ -231,14 +215,10 @@ namespace VideoCreator
             return nullptr;
         }
     
-        // 执行缩放
-        int result = sws_scale(m_swsContext,
-                              frame->data, frame->linesize,
-                              0, frame->height,
-                              scaledFrame->data, scaledFrame->linesize);
-        if (result <= 0)
+        // 执行缩放（色彩矩阵系数与范围转换在 FrameScaler 内设置）
+        if (!m_scaler.scale(frame.get(), scaledFrame.get(), srcRange == 1, colorspace))
         {
-            m_errorString = "缩放失败";
+            m_errorString = m_scaler.getErrorString();
             return nullptr;
         }
     
@@ -255,11 +235,7 @@ namespace VideoCreator
     {
         m_cachedFrame.reset(); // 清除缓存
     
-        if (m_swsContext)
-        {
-            sws_freeContext(m_swsContext);
-            m_swsContext = nullptr;
-        }
+        m_scaler.reset();
     
         if (m_codecContext)
         {
@@ -5,6 +5,7 @@
 #include <memory>
 #include "ffmpeg_utils/FFmpegHeaders.h"
 #include "ffmpeg_utils/AvFrameWrapper.h"
+#include "FrameScaler.h"
 
 namespace VideoCreator
 {
@@ -27,6 +28,9 @@ namespace VideoCreator
         // 缩放图片到指定尺寸
         FFmpegUtils::AvFramePtr scaleToSize(FFmpegUtils::AvFramePtr& frame, int targetWidth, int targetHeight, AVPixelFormat targetFormat = AV_PIX_FMT_YUV420P);
 
+        // 设置缩放线程数（按水平条带并行）
+        void setScaleThreads(int threads) { m_scaler.setThreadCount(threads); }
+
         // 获取图片信息
         int getWidth() const { return m_width; }
         int getHeight() const { return m_height; }
@@ -43,7 +47,7 @@ namespace VideoCreator
         AVFormatContext *m_formatContext;
         AVCodecContext *m_codecContext;
         int m_videoStreamIndex;
-        SwsContext *m_swsContext;
+        FrameScaler m_scaler;
 
         // 图片信息
         int m_width;
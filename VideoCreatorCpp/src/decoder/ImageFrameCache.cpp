@@ -0,0 +1,182 @@
+#include "ImageFrameCache.h"
+#include <filesystem>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace VideoCreator
+{
+
+    namespace
+    {
+        struct FileStamp
+        {
+            std::uintmax_t size = 0;
+            std::filesystem::file_time_type modified;
+        };
+
+        bool readFileStamp(const std::string &path, FileStamp &stamp)
+        {
+            std::error_code ec;
+            const std::filesystem::path filePath = std::filesystem::u8path(path);
+            stamp.size = std::filesystem::file_size(filePath, ec);
+            if (ec)
+            {
+                return false;
+            }
+            stamp.modified = std::filesystem::last_write_time(filePath, ec);
+            return !ec;
+        }
+
+        struct CacheEntry
+        {
+            std::string key;
+            FileStamp stamp;
+            FFmpegUtils::AvFramePtr frame;
+            size_t bytes = 0;
+        };
+
+        struct CacheState
+        {
+            std::mutex mutex;
+            size_t capacity = 0;
+            size_t usedBytes = 0;
+            std::list<CacheEntry> entries; // 表头为最近使用
+            std::unordered_map<std::string, std::list<CacheEntry>::iterator> index;
+        };
+
+        CacheState &state()
+        {
+            static CacheState cacheState;
+            return cacheState;
+        }
+
+        std::string cacheKey(const std::string &path, int width, int height)
+        {
+            return path + '|' + std::to_string(width) + 'x' + std::to_string(height);
+        }
+
+        void erase(CacheState &cache, std::list<CacheEntry>::iterator it)
+        {
+            cache.usedBytes -= it->bytes;
+            cache.index.erase(it->key);
+            cache.entries.erase(it);
+        }
+
+        void evictToCapacity(CacheState &cache)
+        {
+            while (cache.usedBytes > cache.capacity && !cache.entries.empty())
+            {
+                erase(cache, std::prev(cache.entries.end()));
+            }
+        }
+    } // namespace
+
+    void ImageFrameCache::setCapacity(size_t bytes)
+    {
+        CacheState &cache = state();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        cache.capacity = bytes;
+        evictToCapacity(cache);
+    }
+
+    size_t ImageFrameCache::capacity()
+    {
+        CacheState &cache = state();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        return cache.capacity;
+    }
+
+    FFmpegUtils::AvFramePtr ImageFrameCache::find(const std::string &path, int width, int height)
+    {
+        CacheState &cache = state();
+        {
+            std::lock_guard<std::mutex> lock(cache.mutex);
+            if (cache.capacity == 0 || cache.entries.empty())
+            {
+                return nullptr;
+            }
+        }
+
+        // 在锁外读取文件信息，避免慢速存储阻塞其他渲染线程
+        FileStamp stamp;
+        if (!readFileStamp(path, stamp))
+        {
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto indexIt = cache.index.find(cacheKey(path, width, height));
+        if (indexIt == cache.index.end())
+        {
+            return nullptr;
+        }
+        auto entryIt = indexIt->second;
+        if (entryIt->stamp.size != stamp.size || entryIt->stamp.modified != stamp.modified)
+        {
+            erase(cache, entryIt);
+            return nullptr;
+        }
+        cache.entries.splice(cache.entries.begin(), cache.entries, entryIt);
+        return FFmpegUtils::copyAvFrame(entryIt->frame.get());
+    }
+
+    void ImageFrameCache::insert(const std::string &path, int width, int height, const AVFrame *frame)
+    {
+        if (!frame)
+        {
+            return;
+        }
+        CacheState &cache = state();
+        {
+            std::lock_guard<std::mutex> lock(cache.mutex);
+            if (cache.capacity == 0)
+            {
+                return;
+            }
+        }
+
+        FileStamp stamp;
+        if (!readFileStamp(path, stamp))
+        {
+            return;
+        }
+        const int frameBytes = av_image_get_buffer_size(static_cast<AVPixelFormat>(frame->format), frame->width, frame->height, 1);
+        if (frameBytes <= 0)
+        {
+            return;
+        }
+        FFmpegUtils::AvFramePtr reference = FFmpegUtils::copyAvFrame(frame);
+        if (!reference)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        if (static_cast<size_t>(frameBytes) > cache.capacity)
+        {
+            return;
+        }
+        const std::string key = cacheKey(path, width, height);
+        auto indexIt = cache.index.find(key);
+        if (indexIt != cache.index.end())
+        {
+            erase(cache, indexIt->second);
+        }
+        cache.entries.push_front({key, stamp, std::move(reference), static_cast<size_t>(frameBytes)});
+        cache.index[key] = cache.entries.begin();
+        cache.usedBytes += static_cast<size_t>(frameBytes);
+        evictToCapacity(cache);
+    }
+
+    void ImageFrameCache::clear()
+    {
+        CacheState &cache = state();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        cache.entries.clear();
+        cache.index.clear();
+        cache.usedBytes = 0;
+    }
+
+} // namespace VideoCreator
@@ -0,0 +1,32 @@
+#ifndef IMAGE_FRAME_CACHE_H
+#define IMAGE_FRAME_CACHE_H
+
+#include <string>
+#include <cstddef>
+#include "ffmpeg_utils/FFmpegHeaders.h"
+#include "ffmpeg_utils/AvFrameWrapper.h"
+
+namespace VideoCreator
+{
+
+    // 进程级的已缩放图片帧缓存（LRU，按字节计容量），线程安全
+    // 常驻进程（守护模式）在任务之间复用相同图片素材的解码与缩放结果；默认容量为 0，即不缓存
+    class ImageFrameCache
+    {
+    public:
+        // 设置容量（字节），超出时淘汰最久未使用的帧；0 表示关闭并清空
+        static void setCapacity(size_t bytes);
+        static size_t capacity();
+
+        // 命中时返回共享数据缓冲区的帧引用，调用方只读；文件大小或修改时间变化视为未命中
+        static FFmpegUtils::AvFramePtr find(const std::string &path, int width, int height);
+
+        // 缓存缩放到 width x height 的帧；路径不是本地文件（如网络地址）时不缓存
+        static void insert(const std::string &path, int width, int height, const AVFrame *frame);
+
+        static void clear();
+    };
+
+} // namespace VideoCreator
+
+#endif // IMAGE_FRAME_CACHE_H
@@ -1,13 +1,15 @@
 #include "VideoDecoder.h"
 #include <QDebug>
+#include <cmath>
 #include "ffmpeg_utils/AvPacketWrapper.h"
 
 namespace VideoCreator
 {
 
     VideoDecoder::VideoDecoder()
-        : m_formatContext(nullptr), m_codecContext(nullptr), m_swsContext(nullptr),
-          m_videoStreamIndex(-1), m_timeBase{1, 1}, m_frameRate(0.0), m_duration(0)
+        : m_formatContext(nullptr), m_codecContext(nullptr),
+          m_videoStreamIndex(-1), m_timeBase{1, 1}, m_frameRate(0.0), m_duration(0),
+          m_startPts(0), m_outputFrameRate(0)
     {
     }
 
@@ -71,6 +73,7 @@ namespace VideoCreator
         }
 
         m_timeBase = videoStream->time_base;
+        m_startPts = (videoStream->start_time != AV_NOPTS_VALUE) ? videoStream->start_time : 0;
         if (videoStream->duration != AV_NOPTS_VALUE)
         {
             m_duration = videoStream->duration;
@@ -138,6 +141,11 @@ namespace VideoCreator
 
                 if (packet->stream_index == m_videoStreamIndex)
                 {
+                    if (m_outputFrameRate > 0 && m_frameRate > m_outputFrameRate)
+                    {
+                        // 帧线程模式下 skip_frame 在提交每个包时同步到工作线程，可以逐包切换
+                        m_codecContext->skip_frame = isDroppedByRateConversion(packet.get()) ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+                    }
                     ret = avcodec_send_packet(m_codecContext, packet.get());
                     av_packet_unref(packet.get());
                     if (ret < 0)
@@ -152,34 +160,166 @@ namespace VideoCreator
         }
     }
 
-    FFmpegUtils::AvFramePtr VideoDecoder::scaleFrame(const AVFrame *frame, int targetWidth, int targetHeight, AVPixelFormat targetFormat)
+    bool VideoDecoder::frameTime(const AVFrame *frame, double &seconds) const
     {
-        if (!frame)
+        if (!frame || frame->best_effort_timestamp == AV_NOPTS_VALUE)
         {
-            m_errorString = "源视频帧为空";
+            return false;
+        }
+        seconds = (frame->best_effort_timestamp - m_startPts) * av_q2d(m_timeBase);
+        return true;
+    }
+
+    int64_t VideoDecoder::frameSlot(const AVFrame *frame, double previousTime, double &seconds) const
+    {
+        if (!frameTime(frame, seconds))
+        {
+            seconds = previousTime >= 0 ? previousTime + sourceFrameDuration() : 0.0;
+        }
+        return slotAt(seconds);
+    }
+
+    int64_t VideoDecoder::slotAt(double seconds) const
+    {
+        return std::llround(seconds * m_outputFrameRate);
+    }
+
+    double VideoDecoder::sourceFrameDuration() const
+    {
+        if (m_frameRate > 0)
+        {
+            return 1.0 / m_frameRate;
+        }
+        return m_outputFrameRate > 0 ? 1.0 / m_outputFrameRate : 0.0;
+    }
+
+    bool VideoDecoder::isDroppedByRateConversion(const AVPacket *packet) const
+    {
+        if (packet->pts == AV_NOPTS_VALUE)
+        {
+            return false;
+        }
+        // 下一源帧落在同一槽位时本帧不会被输出
+        const double time = (packet->pts - m_startPts) * av_q2d(m_timeBase);
+        return slotAt(time) == slotAt(time + sourceFrameDuration());
+    }
+
+    bool VideoDecoder::seek(double seconds)
+    {
+        if (!m_formatContext || !m_codecContext)
+        {
+            m_errorString = "视频解码器未初始化";
+            return false;
+        }
+
+        // seconds 相对于首帧，与 frameTime 一致；流的起始时间不为 0 时需加回 m_startPts
+        const int64_t timestamp = m_startPts + av_rescale_q(std::llround(seconds * AV_TIME_BASE), AV_TIME_BASE_Q, m_timeBase);
+        if (av_seek_frame(m_formatContext, m_videoStreamIndex, timestamp, AVSEEK_FLAG_BACKWARD) < 0)
+        {
+            m_errorString = "视频跳转失败";
+            return false;
+        }
+        avcodec_flush_buffers(m_codecContext);
+        return true;
+    }
+
+    namespace
+    {
+        // 未标注色彩空间时按分辨率推断（与 scaleFrame 一直以来的约定一致）
+        int resolveColorspace(const AVFrame *frame)
+        {
+            if (frame->colorspace == AVCOL_SPC_UNSPECIFIED)
+            {
+                return (frame->height >= 720) ? AVCOL_SPC_BT709 : AVCOL_SPC_SMPTE170M;
+            }
+            return frame->colorspace;
+        }
+
+        // 输出帧统一标记为 limited range，色彩原色/传输特性按分辨率标注
+        void tagOutputColor(AVFrame *dst, const AVFrame *src, int colorspace)
+        {
+            dst->colorspace = static_cast<AVColorSpace>(colorspace);
+            dst->color_range = AVCOL_RANGE_MPEG;
+            dst->color_primaries = (src->height >= 720) ? AVCOL_PRI_BT709 : AVCOL_PRI_SMPTE170M;
+            dst->color_trc = (src->height >= 720) ? AVCOL_TRC_BT709 : AVCOL_TRC_SMPTE170M;
+            dst->sample_aspect_ratio = AVRational{1, 1};
+        }
+
+        // 8 位 YUV 从 full range 压缩到 limited range 的查找表：Y 映射到 16-235，UV 映射到 16-240
+        struct RangeLut
+        {
+            uint8_t luma[256];
+            uint8_t chroma[256];
+            RangeLut()
+            {
+                for (int i = 0; i < 256; ++i)
+                {
+                    luma[i] = static_cast<uint8_t>((i * 219 + 127) / 255 + 16);
+                    chroma[i] = static_cast<uint8_t>(((i - 128) * 224 + (i >= 128 ? 127 : -127)) / 255 + 128);
+                }
+            }
+        };
+
+        void applyLut(uint8_t *data, int linesize, int width, int height, const uint8_t *lut)
+        {
+            for (int y = 0; y < height; ++y)
+            {
+                uint8_t *row = data + static_cast<ptrdiff_t>(y) * linesize;
+                for (int x = 0; x < width; ++x)
+                {
+                    row[x] = lut[row[x]];
+                }
+            }
+        }
+    } // namespace
+
+    FFmpegUtils::AvFramePtr VideoDecoder::passthroughFrame(const AVFrame *frame)
+    {
+        // 共享解码器输出的缓冲区引用，不做 sws_scale 也不拷贝像素
+        auto outFrame = FFmpegUtils::copyAvFrame(frame);
+        if (!outFrame)
+        {
+            m_errorString = "引用解码帧失败";
             return nullptr;
         }
 
-        m_swsContext = sws_getCachedContext(m_swsContext,
-                                            frame->width, frame->height, (AVPixelFormat)frame->format,
-                                            targetWidth, targetHeight, targetFormat,
-                                            SWS_BILINEAR, nullptr, nullptr, nullptr);
-        if (!m_swsContext)
+        if (frame->color_range != AVCOL_RANGE_MPEG)
+        {
+            // 与 sws 路径的约定一致：未标注 limited range 的源按 full range 处理，原地压缩到 limited range
+            // 解码器仍持有参考帧时 make_writable 会复制一次，但仍省去整帧的格式转换
+            if (av_frame_make_writable(outFrame.get()) < 0)
+            {
+                m_errorString = "无法写入解码帧";
+                return nullptr;
+            }
+            static const RangeLut lut;
+            const int chromaWidth = (frame->width + 1) / 2;
+            const int chromaHeight = (frame->height + 1) / 2;
+            applyLut(outFrame->data[0], outFrame->linesize[0], frame->width, frame->height, lut.luma);
+            applyLut(outFrame->data[1], outFrame->linesize[1], chromaWidth, chromaHeight, lut.chroma);
+            applyLut(outFrame->data[2], outFrame->linesize[2], chromaWidth, chromaHeight, lut.chroma);
+        }
+
+        // 两条路径使用相同的 YUV 系数，色彩空间差异只体现在标注上
+        tagOutputColor(outFrame.get(), frame, resolveColorspace(frame));
+        return outFrame;
+    }
+
+    FFmpegUtils::AvFramePtr VideoDecoder::scaleFrame(const AVFrame *frame, int targetWidth, int targetHeight, AVPixelFormat targetFormat)
+    {
+        if (!frame)
         {
-            m_errorString = "创建视频缩放上下文失败";
+            m_errorString = "源视频帧为空";
             return nullptr;
         }
 
-        int srcRange = (frame->color_range == AVCOL_RANGE_MPEG) ? 0 : 1;
-        int dstRange = 0;
-        int colorspace = frame->colorspace;
-        if (colorspace == AVCOL_SPC_UNSPECIFIED)
+        if (frame->width == targetWidth && frame->height == targetHeight &&
+            frame->format == targetFormat && targetFormat == AV_PIX_FMT_YUV420P)
         {
-            colorspace = (frame->height >= 720) ? AVCOL_SPC_BT709 : AVCOL_SPC_SMPTE170M;
+            return passthroughFrame(frame);
         }
-        const int *coeffs = sws_getCoefficients(colorspace);
-        sws_setColorspaceDetails(m_swsContext, coeffs, srcRange, coeffs, dstRange, 0, 0, 0);
 
+        const int colorspace = resolveColorspace(frame);
         auto scaledFrame = FFmpegUtils::createAvFrame(targetWidth, targetHeight, targetFormat);
         if (!scaledFrame)
         {
@@ -187,22 +327,13 @@ namespace VideoCreator
             return nullptr;
         }
 
-        int result = sws_scale(m_swsContext,
-                               frame->data, frame->linesize,
-                               0, frame->height,
-                               scaledFrame->data, scaledFrame->linesize);
-        if (result <= 0)
+        if (!m_scaler.scale(frame, scaledFrame.get(), frame->color_range != AVCOL_RANGE_MPEG, colorspace))
         {
-            m_errorString = "视频缩放失败";
+            m_errorString = m_scaler.getErrorString();
             return nullptr;
         }
 
-        scaledFrame->colorspace = static_cast<AVColorSpace>(colorspace);
-        scaledFrame->color_range = AVCOL_RANGE_MPEG;
-        scaledFrame->color_primaries = (frame->height >= 720) ? AVCOL_PRI_BT709 : AVCOL_PRI_SMPTE170M;
-        scaledFrame->color_trc = (frame->height >= 720) ? AVCOL_TRC_BT709 : AVCOL_TRC_SMPTE170M;
-        scaledFrame->sample_aspect_ratio = AVRational{1, 1};
-
+        tagOutputColor(scaledFrame.get(), frame, colorspace);
         return scaledFrame;
     }
 
@@ -228,11 +359,7 @@ namespace VideoCreator
 
     void VideoDecoder::cleanup()
     {
-        if (m_swsContext)
-        {
-            sws_freeContext(m_swsContext);
-            m_swsContext = nullptr;
-        }
+        m_scaler.reset();
         if (m_codecContext)
         {
             avcodec_free_context(&m_codecContext);
@@ -245,6 +372,7 @@ namespace VideoCreator
         }
         m_videoStreamIndex = -1;
         m_duration = 0;
+        m_startPts = 0;
     }
 
 } // namespace VideoCreator
@@ -4,6 +4,7 @@
 #include <string>
 #include "ffmpeg_utils/FFmpegHeaders.h"
 #include "ffmpeg_utils/AvFrameWrapper.h"
+#include "FrameScaler.h"
 
 namespace VideoCreator
 {
@@ -19,9 +20,29 @@ namespace VideoCreator
         // 解码下一帧原始画面
         int decodeFrame(FFmpegUtils::AvFramePtr &frame);
 
-        // 将帧缩放/转换成目标尺寸与像素格式
+        // 设置输出帧率：源帧率更高时，解码前对按时间戳映射后会被丢弃的包设置 skip_frame = AVDISCARD_NONREF，跳过其中的非参考帧
+        void setOutputFrameRate(int fps) { m_outputFrameRate = fps; }
+
+        // 帧相对视频流起点的显示时间（秒）；帧没有时间戳时返回 false
+        bool frameTime(const AVFrame *frame, double &seconds) const;
+
+        // 帧率转换的槽位映射（RenderEngine 与 FrameRenderer 共用）：显示时间为 t 的源帧从输出槽位 round(t * 输出帧率)
+        // 开始，占据到下一源帧的槽位为止。帧没有时间戳时按上一帧时间 previousTime 加一个源帧时长推算，
+        // previousTime < 0 表示没有上一帧；seconds 返回采用的帧时间
+        int64_t frameSlot(const AVFrame *frame, double previousTime, double &seconds) const;
+        int64_t slotAt(double seconds) const;
+        // 源帧时长（秒）；源帧率未知时取输出帧时长
+        double sourceFrameDuration() const;
+
+        // 跳转到 seconds 之前最近的关键帧，之后 decodeFrame 从该 GOP 开始输出
+        bool seek(double seconds);
+
+        // 将帧缩放/转换成目标尺寸与像素格式；尺寸与格式已一致时直接返回解码帧的引用
         FFmpegUtils::AvFramePtr scaleFrame(const AVFrame *frame, int targetWidth, int targetHeight, AVPixelFormat targetFormat = AV_PIX_FMT_YUV420P);
 
+        // 设置缩放线程数（按水平条带并行）
+        void setScaleThreads(int threads) { m_scaler.setThreadCount(threads); }
+
         double getDuration() const;
         double getFrameRate() const { return m_frameRate; }
         void close();
@@ -34,14 +55,22 @@ namespace VideoCreator
     private:
         AVFormatContext *m_formatContext;
         AVCodecContext *m_codecContext;
-        SwsContext *m_swsContext;
+        FrameScaler m_scaler;
         int m_videoStreamIndex;
         AVRational m_timeBase;
         double m_frameRate;
         int64_t m_duration;
+        int64_t m_startPts;
+        int m_outputFrameRate;
 
         std::string m_errorString;
 
+        // 帧率转换时该包对应的帧是否会被同一输出槽位的下一帧替换
+        bool isDroppedByRateConversion(const AVPacket *packet) const;
+
+        // 尺寸与像素格式一致时的直通：只修正色彩标注，full range 源原地查表压缩
+        FFmpegUtils::AvFramePtr passthroughFrame(const AVFrame *frame);
+
         void cleanup();
     };
 
@@ -0,0 +1,95 @@
+#include "AdmissionController.h"
+#include <algorithm>
+
+namespace VideoCreator
+{
+
+    AdmissionController::AdmissionController(int64_t budgetBytes, int maxJobs)
+        : m_budget(std::max<int64_t>(0, budgetBytes)), m_maxJobs(std::max(1, maxJobs))
+    {
+    }
+
+    void AdmissionController::setBudget(int64_t bytes)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_budget = std::max<int64_t>(0, bytes);
+        }
+        m_cv.notify_all();
+    }
+
+    void AdmissionController::setMaxJobs(int jobs)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_maxJobs = std::max(1, jobs);
+        }
+        m_cv.notify_all();
+    }
+
+    bool AdmissionController::canAdmit(int64_t bytes) const
+    {
+        if (m_running == 0) {
+            return true;
+        }
+        if (m_running >= m_maxJobs) {
+            return false;
+        }
+        return m_budget == 0 || m_reserved + bytes <= m_budget;
+    }
+
+    bool AdmissionController::acquire(int64_t bytes)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&]() { return m_stopped || canAdmit(bytes); });
+        if (m_stopped) {
+            return false;
+        }
+        m_reserved += bytes;
+        ++m_running;
+        return true;
+    }
+
+    bool AdmissionController::tryAcquire(int64_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopped || !canAdmit(bytes)) {
+            return false;
+        }
+        m_reserved += bytes;
+        ++m_running;
+        return true;
+    }
+
+    void AdmissionController::release(int64_t bytes)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_reserved = std::max<int64_t>(0, m_reserved - bytes);
+            m_running = std::max(0, m_running - 1);
+        }
+        m_cv.notify_all();
+    }
+
+    void AdmissionController::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopped = true;
+        }
+        m_cv.notify_all();
+    }
+
+    int64_t AdmissionController::reservedBytes() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_reserved;
+    }
+
+    int AdmissionController::runningJobs() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_running;
+    }
+
+} // namespace VideoCreator
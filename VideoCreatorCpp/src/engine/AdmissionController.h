@@ -0,0 +1,49 @@
+#ifndef ADMISSION_CONTROLLER_H
+#define ADMISSION_CONTROLLER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace VideoCreator
+{
+
+    // 并发渲染任务的准入控制：运行中任务的预计峰值内存（MemoryEstimate）之和不超过预算时才开始新任务
+    // 单个任务的预计值超过整个预算时，只在没有其他任务运行时放行，避免永远等待
+    class AdmissionController
+    {
+    public:
+        // budgetBytes 为 0 表示不限内存，只限制并发数
+        explicit AdmissionController(int64_t budgetBytes = 0, int maxJobs = 1);
+
+        void setBudget(int64_t bytes);
+        void setMaxJobs(int jobs);
+
+        // 阻塞直到预算允许并登记该任务；stop 之后返回 false
+        bool acquire(int64_t bytes);
+        // 不阻塞，预算不足时返回 false
+        bool tryAcquire(int64_t bytes);
+        // 任务结束时归还登记的内存
+        void release(int64_t bytes);
+
+        // 唤醒所有等待者，之后的 acquire 均返回 false
+        void stop();
+
+        int64_t reservedBytes() const;
+        int runningJobs() const;
+
+    private:
+        bool canAdmit(int64_t bytes) const;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cv;
+        int64_t m_budget;
+        int m_maxJobs;
+        int64_t m_reserved = 0;
+        int m_running = 0;
+        bool m_stopped = false;
+    };
+
+} // namespace VideoCreator
+
+#endif // ADMISSION_CONTROLLER_H
@@ -0,0 +1,243 @@
+#ifndef AUDIO_MIX_KERNELS_H
+#define AUDIO_MIX_KERNELS_H
+
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace VideoCreator
+{
+    // 混音热路径的基础算子，RenderEngine 与微基准测试共用同一份实现
+    namespace AudioMixKernels
+    {
+        // 从图层缓冲队列取出 count 个样本并累加到 dst
+        inline void accumulateFromQueue(std::deque<float> &source, float *dst, int count)
+        {
+            for (int i = 0; i < count; ++i) {
+                dst[i] += source.front();
+                source.pop_front();
+            }
+        }
+
+        // 图层增益包络：基础音量 × 线性淡入 × 线性淡出（与 afade 默认的 tri 曲线一致）
+        // 位置以图层自身已播放的样本数计，不含 start_offset 延迟
+        struct GainEnvelope
+        {
+            float baseGain = 1.0f;
+            int64_t fadeInSamples = 0;   // 0 表示无淡入
+            int64_t fadeOutStart = 0;    // 淡出起点
+            int64_t fadeOutSamples = 0;  // 0 表示无淡出
+
+            bool isUnity() const
+            {
+                return baseGain == 1.0f && fadeInSamples <= 0 && fadeOutSamples <= 0;
+            }
+
+            // [position, position + count) 是否完全处于恒定增益区间
+            bool isConstant(int64_t position, int count) const
+            {
+                const bool pastFadeIn = fadeInSamples <= 0 || position >= fadeInSamples;
+                const bool beforeFadeOut = fadeOutSamples <= 0 || position + count <= fadeOutStart;
+                return pastFadeIn && beforeFadeOut;
+            }
+
+            float gainAt(int64_t position) const
+            {
+                float gain = baseGain;
+                if (fadeInSamples > 0 && position < fadeInSamples) {
+                    gain *= static_cast<float>(position) / static_cast<float>(fadeInSamples);
+                }
+                if (fadeOutSamples > 0 && position >= fadeOutStart) {
+                    const int64_t remaining = fadeOutStart + fadeOutSamples - position;
+                    gain *= remaining > 0 ? static_cast<float>(remaining) / static_cast<float>(fadeOutSamples) : 0.0f;
+                }
+                return gain;
+            }
+
+            static GainEnvelope fromSeconds(double volume, double fadeIn, double fadeOut, double trackDuration, int sampleRate)
+            {
+                GainEnvelope envelope;
+                envelope.baseGain = static_cast<float>(volume);
+                if (fadeIn > 0) {
+                    envelope.fadeInSamples = static_cast<int64_t>(std::llround(fadeIn * sampleRate));
+                }
+                if (fadeOut > 0) {
+                    const double fadeStart = trackDuration > fadeOut ? (trackDuration - fadeOut) : 0.0;
+                    envelope.fadeOutStart = static_cast<int64_t>(std::llround(fadeStart * sampleRate));
+                    envelope.fadeOutSamples = static_cast<int64_t>(std::llround(fadeOut * sampleRate));
+                }
+                return envelope;
+            }
+        };
+
+        // 按块生成增益：恒定区间只填一个标量，淡入淡出区间逐样本计算
+        inline void fillGain(const GainEnvelope &envelope, int64_t position, float *gains, int count)
+        {
+            if (envelope.isConstant(position, count)) {
+                std::fill(gains, gains + count, envelope.baseGain);
+                return;
+            }
+            for (int i = 0; i < count; ++i) {
+                gains[i] = envelope.gainAt(position + i);
+            }
+        }
+
+        // 从图层缓冲队列取出 count 个样本，乘以逐样本增益后累加到 dst
+        inline void accumulateFromQueueWithGain(std::deque<float> &source, float *dst, const float *gains, int count)
+        {
+            for (int i = 0; i < count; ++i) {
+                dst[i] += source.front() * gains[i];
+                source.pop_front();
+            }
+        }
+
+        // 将 other 逐样本乘入 gains
+        inline void multiplyGains(float *gains, const float *other, int count)
+        {
+            for (int i = 0; i < count; ++i) {
+                gains[i] *= other[i];
+            }
+        }
+
+        // 旁白驱动的闪避状态：按块计算旁白 RMS，经 attack/release 平滑后得到图层增益
+        struct Ducker
+        {
+            static constexpr int kDetectionBlock = 256;
+
+            bool enabled = false;
+            float reductionGain = 1.0f; // 旁白有声时的目标增益
+            float threshold = 0.0f;     // RMS 线性阈值
+            float attackSamples = 1.0f;
+            float releaseSamples = 1.0f;
+            float currentGain = 1.0f;   // 跨块保持的平滑增益
+
+            static Ducker fromSettings(double amountDb, double thresholdDb, double attackSeconds, double releaseSeconds, int sampleRate)
+            {
+                Ducker ducker;
+                ducker.enabled = true;
+                ducker.reductionGain = static_cast<float>(std::pow(10.0, std::min(0.0, amountDb) / 20.0));
+                ducker.threshold = static_cast<float>(std::pow(10.0, thresholdDb / 20.0));
+                ducker.attackSamples = static_cast<float>(std::max(1.0, attackSeconds * sampleRate));
+                ducker.releaseSamples = static_cast<float>(std::max(1.0, releaseSeconds * sampleRate));
+                return ducker;
+            }
+        };
+
+        // 根据旁白（侧链）样本计算 count 个闪避增益；块内在上一块与本块增益之间线性过渡，避免拉链噪声
+        inline void computeDuckingGains(Ducker &ducker, const float *sidechainLeft, const float *sidechainRight, int count, float *gains)
+        {
+            for (int blockStart = 0; blockStart < count; blockStart += Ducker::kDetectionBlock) {
+                const int blockSize = std::min(Ducker::kDetectionBlock, count - blockStart);
+                float energy = 0.0f;
+                for (int i = 0; i < blockSize; ++i) {
+                    const float l = sidechainLeft[blockStart + i];
+                    const float r = sidechainRight[blockStart + i];
+                    energy += l * l + r * r;
+                }
+                const float rms = std::sqrt(energy / static_cast<float>(2 * blockSize));
+                const float target = rms > ducker.threshold ? ducker.reductionGain : 1.0f;
+                const float timeConstant = target < ducker.currentGain ? ducker.attackSamples : ducker.releaseSamples;
+                const float coefficient = std::exp(-static_cast<float>(blockSize) / timeConstant);
+                const float nextGain = target + (ducker.currentGain - target) * coefficient;
+
+                const float step = (nextGain - ducker.currentGain) / static_cast<float>(blockSize);
+                for (int i = 0; i < blockSize; ++i) {
+                    gains[blockStart + i] = ducker.currentGain + step * static_cast<float>(i + 1);
+                }
+                ducker.currentGain = nextGain;
+            }
+        }
+
+        // 保留最近 capacity 个样本的双声道环形缓冲（转场交叉淡化用的前一场景尾部）
+        class AudioTailBuffer
+        {
+        public:
+            void reset(size_t capacity)
+            {
+                m_left.assign(capacity, 0.0f);
+                m_right.assign(capacity, 0.0f);
+                m_writePos = 0;
+                m_size = 0;
+            }
+
+            size_t capacity() const { return m_left.size(); }
+            size_t size() const { return m_size; }
+
+            // 追加样本，超出容量时覆盖最旧的部分；left/right 为空表示静音
+            void push(const float *left, const float *right, int count)
+            {
+                const size_t cap = m_left.size();
+                if (cap == 0 || count <= 0) {
+                    return;
+                }
+                size_t offset = 0;
+                size_t remaining = static_cast<size_t>(count);
+                if (remaining > cap) {
+                    offset = remaining - cap;
+                    remaining = cap;
+                }
+                while (remaining > 0) {
+                    const size_t chunk = std::min(remaining, cap - m_writePos);
+                    if (left && right) {
+                        std::copy(left + offset, left + offset + chunk, m_left.begin() + m_writePos);
+                        std::copy(right + offset, right + offset + chunk, m_right.begin() + m_writePos);
+                    } else {
+                        std::fill(m_left.begin() + m_writePos, m_left.begin() + m_writePos + chunk, 0.0f);
+                        std::fill(m_right.begin() + m_writePos, m_right.begin() + m_writePos + chunk, 0.0f);
+                    }
+                    m_writePos = (m_writePos + chunk) % cap;
+                    offset += chunk;
+                    remaining -= chunk;
+                }
+                m_size = std::min(cap, m_size + static_cast<size_t>(count));
+            }
+
+            // 按时间顺序读取第 index 个保留样本（0 为最旧）
+            float left(size_t index) const { return m_left[physicalIndex(index)]; }
+            float right(size_t index) const { return m_right[physicalIndex(index)]; }
+
+        private:
+            size_t physicalIndex(size_t index) const
+            {
+                const size_t cap = m_left.size();
+                return (m_writePos + cap - m_size + index) % cap;
+            }
+
+            std::vector<float> m_left;
+            std::vector<float> m_right;
+            size_t m_writePos = 0;
+            size_t m_size = 0;
+        };
+
+        // 线性交叉淡化：dst = tail × (1 - t) + dst × t，position 为转场内的样本位置
+        inline void crossfadeWithTail(const AudioTailBuffer &tail, int64_t position, int64_t totalSamples, float *dstLeft, float *dstRight, int count)
+        {
+            const size_t tailSize = tail.size();
+            for (int i = 0; i < count; ++i) {
+                const int64_t pos = position + i;
+                const float t = totalSamples > 0 ? std::min(1.0f, static_cast<float>(pos) / static_cast<float>(totalSamples)) : 1.0f;
+                float fromLeft = 0.0f;
+                float fromRight = 0.0f;
+                if (pos < static_cast<int64_t>(tailSize)) {
+                    fromLeft = tail.left(static_cast<size_t>(pos));
+                    fromRight = tail.right(static_cast<size_t>(pos));
+                }
+                dstLeft[i] = fromLeft * (1.0f - t) + dstLeft[i] * t;
+                dstRight[i] = fromRight * (1.0f - t) + dstRight[i] * t;
+            }
+        }
+
+        // 将混音结果限幅到 [-1, 1] 并写入编码器的平面声道
+        inline void clampToPlanar(const float *source, float *dst, int count)
+        {
+            for (int i = 0; i < count; ++i) {
+                dst[i] = std::clamp(source[i], -1.0f, 1.0f);
+            }
+        }
+    } // namespace AudioMixKernels
+
+} // namespace VideoCreator
+
+#endif // AUDIO_MIX_KERNELS_H
@@ -0,0 +1,379 @@
+#include "FrameRenderer.h"
+#include "decoder/ImageDecoder.h"
+#include "decoder/VideoDecoder.h"
+#include "filter/EffectProcessor.h"
+#include <algorithm>
+#include <cmath>
+
+namespace VideoCreator
+{
+
+    namespace
+    {
+        constexpr int kSampleRate = 48000; // 只用于构建时间线，单帧合成不涉及音频
+
+        // 向后跳转不超过该秒数时继续解码而不重新定位（拖动预览通常是小步前进）
+        constexpr double kMaxDecodeAheadSeconds = 2.0;
+    } // namespace
+
+    // 打开的视频素材与解码位置：current 为最近一个槽位不晚于请求的帧，next 为已解码但槽位更晚的帧
+    struct FrameRenderer::VideoSource
+    {
+        std::string path;
+        VideoDecoder decoder;
+        FFmpegUtils::AvFramePtr current;
+        int64_t currentSlot = -1;
+        FFmpegUtils::AvFramePtr next;
+        int64_t nextSlot = -1;
+        double lastTime = -1.0; // 最近解码帧的时间，帧没有时间戳时据此推算
+        bool eof = false;
+    };
+
+    FrameRenderer::FrameRenderer()
+        : m_maxDecoders(4), m_maxImages(16)
+    {
+    }
+
+    FrameRenderer::~FrameRenderer() = default;
+
+    bool FrameRenderer::open(const ProjectConfig &config)
+    {
+        if (config.project.width <= 0 || config.project.height <= 0 || config.project.fps <= 0) {
+            m_errorString = "Invalid project resolution or frame rate";
+            return false;
+        }
+        clearCaches();
+        m_config = config;
+        m_timeline = ProjectTimeline::build(m_config, kSampleRate);
+        m_errorString.clear();
+        return true;
+    }
+
+    double FrameRenderer::duration() const
+    {
+        return m_config.project.fps > 0 ? static_cast<double>(m_timeline.totalFrames) / m_config.project.fps : 0.0;
+    }
+
+    void FrameRenderer::setCacheLimits(size_t maxDecoders, size_t maxImages)
+    {
+        m_maxDecoders = std::max<size_t>(1, maxDecoders);
+        m_maxImages = std::max<size_t>(1, maxImages);
+        while (m_videoSources.size() > m_maxDecoders) {
+            m_videoSources.pop_back();
+        }
+        while (m_images.size() > m_maxImages) {
+            m_images.pop_back();
+        }
+    }
+
+    void FrameRenderer::clearCaches()
+    {
+        resetSequence();
+        m_transitionEnds = TransitionEnds{};
+        m_videoSources.clear();
+        m_images.clear();
+    }
+
+    void FrameRenderer::resetSequence()
+    {
+        m_sequence.sceneIndex = SIZE_MAX;
+        m_sequence.nextFrame = 0;
+        m_sequence.processor.reset();
+    }
+
+    FFmpegUtils::AvFramePtr FrameRenderer::frameAt(double seconds, OutputFormat format)
+    {
+        return frameAtIndex(static_cast<int64_t>(std::floor(seconds * m_config.project.fps)), format);
+    }
+
+    FFmpegUtils::AvFramePtr FrameRenderer::frameAtIndex(int64_t frameIndex, OutputFormat format)
+    {
+        if (m_timeline.totalFrames <= 0) {
+            m_errorString = "Project has no frames";
+            return nullptr;
+        }
+        frameIndex = std::clamp<int64_t>(frameIndex, 0, m_timeline.totalFrames - 1);
+
+        // 最后一个起点不晚于 frameIndex 的非空场景
+        size_t sceneIndex = SIZE_MAX;
+        for (size_t i = 0; i < m_timeline.entries.size(); ++i) {
+            const auto &entry = m_timeline.entries[i];
+            if (entry.startFrame > frameIndex) {
+                break;
+            }
+            if (entry.frameCount > 0 && frameIndex < entry.startFrame + entry.frameCount) {
+                sceneIndex = i;
+            }
+        }
+        if (sceneIndex == SIZE_MAX) {
+            m_errorString = "No scene covers frame " + std::to_string(frameIndex);
+            return nullptr;
+        }
+
+        const int localFrame = static_cast<int>(frameIndex - m_timeline.entries[sceneIndex].startFrame);
+        FFmpegUtils::AvFramePtr frame = composeSceneFrame(sceneIndex, localFrame);
+        if (!frame) {
+            return nullptr;
+        }
+        return convertOutput(std::move(frame), format);
+    }
+
+    FFmpegUtils::AvFramePtr FrameRenderer::composeSceneFrame(size_t sceneIndex, int localFrame)
+    {
+        const SceneConfig &scene = m_config.scenes[sceneIndex];
+        if (scene.type == SceneType::TRANSITION) {
+            return transitionFrame(sceneIndex, localFrame);
+        }
+        if (scene.type == SceneType::VIDEO_SCENE) {
+            return videoSceneFrame(sceneIndex, localFrame);
+        }
+        return imageSceneFrame(sceneIndex, localFrame);
+    }
+
+    FFmpegUtils::AvFramePtr FrameRenderer::imageSceneFrame(size_t sceneIndex, int localFrame)
+    {
+        const SceneConfig &scene = m_config.scenes[sceneIndex];
+        FFmpegUtils::AvFramePtr image = scaledImage(scene.resources.image.path);
+        if (!image) {
+            return nullptr;
+        }
+        if (!scene.effects.ken_burns.enabled) {
+            return image;
+        }
+
+        const int totalFrames = std::max(1, m_timeline.entries[sceneIndex].frameCount);
+        localFrame = std::clamp(localFrame, 0, totalFrames - 1);
+        // 顺序请求时继续当前序列；否则从该帧重新开始，zoompan 只生成请求的帧
+        if (m_sequence.sceneIndex != sceneIndex || m_sequence.nextFrame != localFrame || !m_sequence.processor) {
+            resetSequence();
+            auto processor = std::make_unique<EffectProcessor>();
+            processor->initialize(m_config.project.width, m_config.project.height, AV_PIX_FMT_YUV420P, m_config.project.fps);
+            if (!processor->startKenBurnsSequence(scene.effects.ken_burns, image.get(), totalFrames, localFrame)) {
+                m_errorString = "Ken Burns failed: " + processor->getErrorString();
+                return nullptr;
+            }
+            m_sequence.sceneIndex = sceneIndex;
+            m_sequence.nextFrame = localFrame;
+            m_sequence.processor = std::move(processor);
+        }
+
+        FFmpegUtils::AvFramePtr frame;
+        if (!m_sequence.processor->fetchKenBurnsFrame(frame)) {
+            m_errorString = "Ken Burns failed: " + m_sequence.processor->getErrorString();
+            resetSequence();
+            return nullptr;
+        }
+        if (++m_sequence.nextFrame >= totalFrames) {
+            resetSequence();
+        }
+        return frame;
+    }
+
+    FFmpegUtils::AvFramePtr FrameRenderer::videoSceneFrame(size_t sceneIndex, int localFrame)
+    {
+        const SceneConfig &scene = m_config.scenes[sceneIndex];
+        VideoSource *source = acquireVideoSource(scene.resources.video.path);
+        if (!source) {
+            return nullptr;
+        }
+
+        // 槽位映射与 RenderEngine 相同（VideoDecoder::frameSlot）
+        const double fps = m_config.project.fps;
+        const int64_t target = localFrame;
+        const bool canDecodeForward = source->currentSlot >= 0 && source->currentSlot <= target &&
+                                      target - source->currentSlot <= static_cast<int64_t>(kMaxDecodeAheadSeconds * fps);
+        if (!canDecodeForward) {
+            if (!source->decoder.seek(target / fps)) {
+                m_errorString = "Video seek failed: " + source->decoder.getErrorString();
+                return nullptr;
+            }
+            source->current.reset();
+            source->next.reset();
+            source->currentSlot = source->nextSlot = -1;
+            source->lastTime = -1.0;
+            source->eof = false;
+        }
+
+        while (true) {
+            if (source->next) {
+                if (source->nextSlot > target) {
+                    break;
+                }
+                source->current = std::move(source->next);
+                source->currentSlot = source->nextSlot;
+                source->nextSlot = -1;
+            }
+            if (source->eof) {
+                break;
+            }
+            FFmpegUtils::AvFramePtr decoded;
+            const int ret = source->decoder.decodeFrame(decoded);
+            if (ret < 0) {
+                m_errorString = "Video decode failed: " + source->decoder.getErrorString();
+                return nullptr;
+            }
+            if (ret == 0 || !decoded) {
+                source->eof = true;
+                continue;
+            }
+            source->nextSlot = source->decoder.frameSlot(decoded.get(), source->lastTime, source->lastTime);
+            source->next = std::move(decoded);
+        }
+
+        // 请求早于素材首帧时取首帧，素材提前结束时保持末帧
+        const AVFrame *frame = source->current ? source->current.get() : source->next.get();
+        if (!frame) {
+            m_errorString = "Video has no frame at " + std::to_string(localFrame);
+            return nullptr;
+        }
+        FFmpegUtils::AvFramePtr scaled = source->decoder.scaleFrame(frame, m_config.project.width, m_config.project.height, AV_PIX_FMT_YUV420P);
+        if (!scaled) {
+            m_errorString = "Video scale failed: " + source->decoder.getErrorString();
+        }
+        return scaled;
+    }
+
+    FFmpegUtils::AvFramePtr FrameRenderer::transitionFrame(size_t sceneIndex, int localFrame)
+    {
+        if (sceneIndex == 0 || sceneIndex + 1 >= m_config.scenes.size()) {
+            m_errorString = "Transition must be between two scenes";
+            return nullptr;
+        }
+        const SceneConfig &transition = m_config.scenes[sceneIndex];
+        const int totalFrames = std::max(1, m_timeline.entries[sceneIndex].frameCount);
+        localFrame = std::clamp(localFrame, 0, totalFrames - 1);
+
+        const bool continueSequence = m_sequence.sceneIndex == sceneIndex && m_sequence.processor &&
+                                      m_sequence.nextFrame <= localFrame;
+        if (!continueSequence) {
+            if (m_transitionEnds.sceneIndex != sceneIndex) {
+                // 起止帧与 RenderEngine 一致：前一场景的末帧与后一场景的首帧（含 Ken Burns）
+                const int fromLast = std::max(1, m_timeline.entries[sceneIndex - 1].frameCount) - 1;
+                FFmpegUtils::AvFramePtr from = composeSceneFrame(sceneIndex - 1, fromLast);
+                if (!from) {
+                    return nullptr;
+                }
+                FFmpegUtils::AvFramePtr to = composeSceneFrame(sceneIndex + 1, 0);
+                if (!to) {
+                    return nullptr;
+                }
+                m_transitionEnds.sceneIndex = sceneIndex;
+                m_transitionEnds.from = std::move(from);
+                m_transitionEnds.to = std::move(to);
+            }
+
+            resetSequence();
+            auto processor = std::make_unique<EffectProcessor>();
+            processor->initialize(m_config.project.width, m_config.project.height, AV_PIX_FMT_YUV420P, m_config.project.fps);
+            if (!processor->startTransitionSequence(transition.transition_type, m_transitionEnds.from.get(), m_transitionEnds.to.get(), totalFrames)) {
+                m_errorString = "Transition failed: " + processor->getErrorString();
+                return nullptr;
+            }
+            m_sequence.sceneIndex = sceneIndex;
+            m_sequence.nextFrame = 0;
+            m_sequence.processor = std::move(processor);
+        }
+
+        // xfade 的进度由帧时间戳决定，只能顺序生成到目标帧
+        FFmpegUtils::AvFramePtr frame;
+        while (m_sequence.nextFrame <= localFrame) {
+            if (!m_sequence.processor->fetchTransitionFrame(frame)) {
+                m_errorString = "Transition failed: " + m_sequence.processor->getErrorString();
+                resetSequence();
+                return nullptr;
+            }
+            ++m_sequence.nextFrame;
+        }
+        if (m_sequence.nextFrame >= totalFrames) {
+            resetSequence();
+        }
+        return frame;
+    }
+
+    FFmpegUtils::AvFramePtr FrameRenderer::scaledImage(const std::string &path)
+    {
+        if (path.empty()) {
+            m_errorString = "Image scene has no image path";
+            return nullptr;
+        }
+        for (auto it = m_images.begin(); it != m_images.end(); ++it) {
+            if (it->path == path) {
+                m_images.splice(m_images.begin(), m_images, it);
+                return FFmpegUtils::copyAvFrame(m_images.front().frame.get());
+            }
+        }
+
+        ImageDecoder decoder;
+        if (!decoder.open(path)) {
+            m_errorString = "Cannot open image: " + decoder.getErrorString();
+            return nullptr;
+        }
+        FFmpegUtils::AvFramePtr decoded = decoder.decodeAndCache();
+        if (!decoded) {
+            m_errorString = "Cannot decode image: " + decoder.getErrorString();
+            return nullptr;
+        }
+        FFmpegUtils::AvFramePtr scaled = decoder.scaleToSize(decoded, m_config.project.width, m_config.project.height, AV_PIX_FMT_YUV420P);
+        if (!scaled) {
+            m_errorString = "Cannot scale image: " + decoder.getErrorString();
+            return nullptr;
+        }
+        scaled->pts = 0;
+
+        m_images.push_front({path, std::move(scaled)});
+        while (m_images.size() > m_maxImages) {
+            m_images.pop_back();
+        }
+        return FFmpegUtils::copyAvFrame(m_images.front().frame.get());
+    }
+
+    FrameRenderer::VideoSource *FrameRenderer::acquireVideoSource(const std::string &path)
+    {
+        if (path.empty()) {
+            m_errorString = "Video scene has no video path";
+            return nullptr;
+        }
+        for (auto it = m_videoSources.begin(); it != m_videoSources.end(); ++it) {
+            if ((*it)->path == path) {
+                m_videoSources.splice(m_videoSources.begin(), m_videoSources, it);
+                return m_videoSources.front().get();
+            }
+        }
+
+        auto source = std::make_unique<VideoSource>();
+        source->path = path;
+        if (!source->decoder.open(path)) {
+            m_errorString = "Cannot open video: " + source->decoder.getErrorString();
+            return nullptr;
+        }
+        source->decoder.setOutputFrameRate(m_config.project.fps);
+        m_videoSources.push_front(std::move(source));
+        while (m_videoSources.size() > m_maxDecoders) {
+            m_videoSources.pop_back();
+        }
+        return m_videoSources.front().get();
+    }
+
+    FFmpegUtils::AvFramePtr FrameRenderer::convertOutput(FFmpegUtils::AvFramePtr frame, OutputFormat format)
+    {
+        if (format == OutputFormat::YUV420P) {
+            return frame;
+        }
+        auto rgba = FFmpegUtils::createAvFrame(frame->width, frame->height, AV_PIX_FMT_RGBA);
+        if (!rgba) {
+            m_errorString = "Cannot allocate RGBA frame";
+            return nullptr;
+        }
+        int colorspace = frame->colorspace;
+        if (colorspace == AVCOL_SPC_UNSPECIFIED) {
+            colorspace = frame->height >= 720 ? AVCOL_SPC_BT709 : AVCOL_SPC_SMPTE170M;
+        }
+        if (!m_outputScaler.scale(frame.get(), rgba.get(), frame->color_range == AVCOL_RANGE_JPEG, colorspace)) {
+            m_errorString = "Cannot convert frame to RGBA: " + m_outputScaler.getErrorString();
+            return nullptr;
+        }
+        rgba->pts = frame->pts;
+        return rgba;
+    }
+
+} // namespace VideoCreator
@@ -0,0 +1,103 @@
+#ifndef FRAME_RENDERER_H
+#define FRAME_RENDERER_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include "model/ProjectConfig.h"
+#include "engine/ProjectTimeline.h"
+#include "decoder/FrameScaler.h"
+#include "ffmpeg_utils/FFmpegHeaders.h"
+#include "ffmpeg_utils/AvFrameWrapper.h"
+
+namespace VideoCreator
+{
+
+    class EffectProcessor;
+
+    // 随机访问的单帧合成：把工程时间映射到场景/转场，定位解码器，在该帧序号上求值 Ken Burns 或转场
+    // 不创建编码器与封装器，供编辑器拖动预览和缩略图使用
+    // 最近使用的视频解码器与缩放后的图片在调用之间缓存；向后连续取帧时复用解码位置与特效序列，不重新定位
+    // 非线程安全，每个线程使用自己的实例
+    class FrameRenderer
+    {
+    public:
+        enum class OutputFormat
+        {
+            YUV420P, // 项目管线格式（limited range）
+            RGBA     // 供界面直接显示
+        };
+
+        FrameRenderer();
+        ~FrameRenderer();
+
+        FrameRenderer(const FrameRenderer &) = delete;
+        FrameRenderer &operator=(const FrameRenderer &) = delete;
+
+        // 载入工程（场景时长需已由 ConfigLoader 推导），清空之前的缓存
+        bool open(const ProjectConfig &config);
+
+        // 工程时间 seconds 处的合成帧，超出范围时取首/末帧；返回的帧可能与缓存共享数据缓冲区，只读
+        FFmpegUtils::AvFramePtr frameAt(double seconds, OutputFormat format = OutputFormat::YUV420P);
+        FFmpegUtils::AvFramePtr frameAtIndex(int64_t frameIndex, OutputFormat format = OutputFormat::YUV420P);
+
+        int64_t frameCount() const { return m_timeline.totalFrames; }
+        double duration() const;
+
+        // 缓存的视频解码器数与图片数上限
+        void setCacheLimits(size_t maxDecoders, size_t maxImages);
+        void clearCaches();
+
+        std::string errorString() const { return m_errorString; }
+
+    private:
+        struct VideoSource;
+
+        struct CachedImage
+        {
+            std::string path;
+            FFmpegUtils::AvFramePtr frame; // 已缩放到项目分辨率的 YUV420P
+        };
+
+        // 当前的 Ken Burns / 转场序列，请求下一帧时继续取帧
+        struct EffectSequence
+        {
+            size_t sceneIndex = SIZE_MAX;
+            int nextFrame = 0;
+            std::unique_ptr<EffectProcessor> processor;
+        };
+
+        // 转场的起止帧（前一场景末帧与后一场景首帧）
+        struct TransitionEnds
+        {
+            size_t sceneIndex = SIZE_MAX;
+            FFmpegUtils::AvFramePtr from;
+            FFmpegUtils::AvFramePtr to;
+        };
+
+        FFmpegUtils::AvFramePtr composeSceneFrame(size_t sceneIndex, int localFrame);
+        FFmpegUtils::AvFramePtr imageSceneFrame(size_t sceneIndex, int localFrame);
+        FFmpegUtils::AvFramePtr videoSceneFrame(size_t sceneIndex, int localFrame);
+        FFmpegUtils::AvFramePtr transitionFrame(size_t sceneIndex, int localFrame);
+
+        FFmpegUtils::AvFramePtr scaledImage(const std::string &path);
+        VideoSource *acquireVideoSource(const std::string &path);
+        FFmpegUtils::AvFramePtr convertOutput(FFmpegUtils::AvFramePtr frame, OutputFormat format);
+        void resetSequence();
+
+        ProjectConfig m_config;
+        ProjectTimeline m_timeline;
+        std::list<std::unique_ptr<VideoSource>> m_videoSources; // 表头为最近使用
+        std::list<CachedImage> m_images;                        // 表头为最近使用
+        size_t m_maxDecoders;
+        size_t m_maxImages;
+        EffectSequence m_sequence;
+        TransitionEnds m_transitionEnds;
+        FrameScaler m_outputScaler;
+        std::string m_errorString;
+    };
+
+} // namespace VideoCreator
+
+#endif // FRAME_RENDERER_H
@@ -0,0 +1,124 @@
+#include "MemoryEstimate.h"
+#include "RenderBuffers.h"
+#include <algorithm>
+#include <thread>
+
+namespace VideoCreator
+{
+
+    namespace
+    {
+        constexpr int64_t kMiB = 1024 * 1024;
+        constexpr int64_t kBaseBytes = 64 * kMiB;
+
+        constexpr int kDecoderFrames = 8;            // 解码器参考帧与输出延迟（H.264 1080p 常见 DPB 约 4-6 帧）
+        constexpr int kWorkingFrames = 4;            // 当前帧、末帧副本、特效/转场滤镜图的输入输出
+
+        int64_t yuv420FrameBytes(int width, int height)
+        {
+            return static_cast<int64_t>(width) * height * 3 / 2;
+        }
+
+        int encoderThreads()
+        {
+            unsigned int hardwareThreads = std::thread::hardware_concurrency();
+            if (hardwareThreads == 0) {
+                hardwareThreads = 4;
+            }
+            return static_cast<int>(std::min(8u, hardwareThreads));
+        }
+
+        // libx264 同时持有的帧数：lookahead + B 帧 + 参考帧 + 帧线程；每帧另有下采样平面与宏块统计，按 2 倍计
+        int64_t x264Bytes(int width, int height, const std::string &preset)
+        {
+            int lookahead = 40;
+            if (preset == "ultrafast" || preset == "superfast") {
+                lookahead = 0;
+            } else if (preset == "veryfast") {
+                lookahead = 10;
+            } else if (preset == "faster") {
+                lookahead = 20;
+            } else if (preset == "fast") {
+                lookahead = 30;
+            } else if (preset == "slow") {
+                lookahead = 50;
+            } else if (preset == "slower" || preset == "veryslow" || preset == "placebo") {
+                lookahead = 60;
+            }
+            const int frames = lookahead + 3 + 4 + encoderThreads();
+            return static_cast<int64_t>(frames) * yuv420FrameBytes(width, height) * 2;
+        }
+
+        bool isAudioOnlyMode(const std::string &mode)
+        {
+            return mode == "m4a" || mode == "mp3" || mode == "wav";
+        }
+    } // namespace
+
+    MemoryEstimate MemoryEstimate::fromConfig(const ProjectConfig &config)
+    {
+        MemoryEstimate estimate;
+        estimate.base = kBaseBytes;
+
+        const int sampleRate = config.project.sample_rate > 0 ? config.project.sample_rate : 48000;
+        const int channels = std::max(1, config.global_effects.audio_encoding.channels);
+        // 混音始终为 FLTP 双声道浮点
+        const int64_t layerBufferBytes = static_cast<int64_t>(sampleRate) * RenderBuffers::kAudioBufferSeconds * 2 * sizeof(float);
+
+        // 同时打开的场景音频图层：转场交叉淡化时前后两个场景的混音器同时存在
+        int maxSceneLayers = 0;
+        int previousLayers = 0;
+        for (const auto &scene : config.scenes) {
+            int layers = static_cast<int>(scene.resources.audio_layers.size());
+            if (!scene.resources.audio.path.empty() || (scene.type == SceneType::VIDEO_SCENE && scene.resources.video.use_audio)) {
+                ++layers;
+            }
+            maxSceneLayers = std::max(maxSceneLayers, layers + previousLayers);
+            previousLayers = scene.type == SceneType::TRANSITION ? 0 : layers;
+        }
+        estimate.audio = (maxSceneLayers + static_cast<int64_t>(config.audio_tracks.size())) * layerBufferBytes;
+        // 混音 FIFO 与各编码帧缓冲约一秒
+        estimate.audio += static_cast<int64_t>(sampleRate) * channels * sizeof(float);
+        if (config.performance.audio_prerender) {
+            // 压缩后的包队列，按编码码率上限约 320 kbps 计
+            estimate.audio += static_cast<int64_t>(RenderBuffers::kAudioPrerenderSeconds) * 320000 / 8;
+        }
+
+        if (isAudioOnlyMode(config.output.mode)) {
+            return estimate;
+        }
+
+        const int width = config.project.width;
+        const int height = config.project.height;
+        const int64_t frameBytes = yuv420FrameBytes(width, height);
+        estimate.encoder = x264Bytes(width, height, config.global_effects.video_encoding.preset);
+
+        int64_t videoScenes = 0;
+        int64_t sceneFramePeak = 0;
+        for (const auto &scene : config.scenes) {
+            int64_t sceneBytes = kWorkingFrames * frameBytes;
+            if (scene.type == SceneType::VIDEO_SCENE) {
+                ++videoScenes;
+                sceneBytes += (RenderBuffers::kVideoQueueFrames + kDecoderFrames) * frameBytes;
+            } else if (scene.type == SceneType::TRANSITION) {
+                // 起止帧，以及为取 Ken Burns 首末帧临时运行的特效序列
+                sceneBytes += 2 * kWorkingFrames * frameBytes;
+            } else if (!scene.resources.image.path.empty()) {
+                // 解码后的原图（按项目分辨率的 RGBA 计）与缩放结果
+                sceneBytes += static_cast<int64_t>(width) * height * 4 + frameBytes;
+            }
+            sceneFramePeak = std::max(sceneFramePeak, sceneBytes);
+        }
+        estimate.videoPipeline = sceneFramePeak;
+        // 智能渲染直接复制的场景同样会预取首帧，不单独扣除
+        estimate.prefetch = videoScenes * (kDecoderFrames + 1) * frameBytes;
+        estimate.sceneFrames = static_cast<int64_t>(config.scenes.size()) * 2 * frameBytes;
+
+        for (const auto &rendition : config.output.renditions) {
+            estimate.renditions += x264Bytes(rendition.width, rendition.height, config.global_effects.video_encoding.preset) +
+                                   yuv420FrameBytes(rendition.width, rendition.height);
+        }
+        return estimate;
+    }
+
+} // namespace VideoCreator
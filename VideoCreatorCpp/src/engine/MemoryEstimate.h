@@ -0,0 +1,29 @@
+#ifndef MEMORY_ESTIMATE_H
+#define MEMORY_ESTIMATE_H
+
+#include <cstdint>
+#include "model/ProjectConfig.h"
+
+namespace VideoCreator
+{
+
+    // 渲染峰值内存的估算（字节）：按 RenderEngine 各部分的缓冲上限相加，偏保守
+    // 只依据 ProjectConfig（分辨率、场景与图层、队列深度、缓存），不打开素材；素材分辨率未知时按项目分辨率计
+    struct MemoryEstimate
+    {
+        int64_t base = 0;          // 进程、编解码库与输出缓冲的固定开销
+        int64_t encoder = 0;       // 视频编码器：lookahead、参考帧与帧线程
+        int64_t videoPipeline = 0; // 当前场景：帧队列、解码器参考帧、特效与转场的中间帧
+        int64_t prefetch = 0;      // 视频场景首帧预取：渲染开始时所有视频场景的解码器同时运行
+        int64_t sceneFrames = 0;   // 每个场景缓存的首帧与末帧（供转场使用，整个渲染期间保留）
+        int64_t audio = 0;         // 各音频图层的解码缓冲、工程音轨、混音 FIFO 与预渲染包队列
+        int64_t renditions = 0;    // 额外输出档位的编码器与缩放帧
+
+        int64_t total() const { return base + encoder + videoPipeline + prefetch + sceneFrames + audio + renditions; }
+
+        static MemoryEstimate fromConfig(const ProjectConfig &config);
+    };
+
+} // namespace VideoCreator
+
+#endif // MEMORY_ESTIMATE_H
@@ -0,0 +1,22 @@
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+
+#include <cstdint>
+#include <functional>
+
+namespace VideoCreator
+{
+    // 自定义输出目标：封装后的字节流交给调用方，而不是写入 output_path
+    struct OutputSink
+    {
+        // 写入回调：返回实际写入的字节数，<0 表示失败（会作为 FFmpeg 错误码返回给封装器）
+        std::function<int(const uint8_t *data, int size)> write;
+
+        // 可选定位回调（whence 为 SEEK_SET / SEEK_CUR / SEEK_END），返回新位置，<0 表示失败。
+        // 提供时输出普通 MP4（结束时回写 moov）；未提供时视为不可寻址，强制输出分片 MP4
+        std::function<int64_t(int64_t offset, int whence)> seek;
+    };
+
+} // namespace VideoCreator
+
+#endif // OUTPUT_SINK_H
@@ -0,0 +1,313 @@
+#include "PreviewPlayer.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace VideoCreator
+{
+
+    namespace
+    {
+        constexpr int kAudioChunk = 1024;
+        constexpr double kAudioLeadSeconds = 0.2; // 音频最多提前交付的时长
+        constexpr double kAudioMaxLagSeconds = 0.1; // 落后超过该时长时丢弃到当前时钟
+    } // namespace
+
+    PreviewPlayer::PreviewPlayer()
+        : m_outputFormat(FrameRenderer::OutputFormat::RGBA), m_fps(0.0), m_totalFrames(0), m_duration(0.0),
+          m_stopping(false), m_playing(false), m_presentPending(false), m_anchorPosition(0.0), m_seekGeneration(0)
+    {
+    }
+
+    PreviewPlayer::~PreviewPlayer()
+    {
+        close();
+    }
+
+    bool PreviewPlayer::open(const ProjectConfig &config)
+    {
+        close();
+        if (!m_frameRenderer.open(config)) {
+            m_errorString = m_frameRenderer.errorString();
+            return false;
+        }
+        if (m_audioCallback) {
+            const int sampleRate = config.project.sample_rate > 0 ? config.project.sample_rate : 44100;
+            if (!m_audioMixer.open(config, sampleRate)) {
+                m_errorString = m_audioMixer.errorString();
+                return false;
+            }
+        }
+
+        m_fps = config.project.fps;
+        m_totalFrames = m_frameRenderer.frameCount();
+        m_duration = m_frameRenderer.duration();
+        m_presentedFrames.store(0);
+        m_droppedFrames.store(0);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = false;
+            m_playing = false;
+            m_presentPending = true;
+            m_anchorPosition = 0.0;
+            m_anchorTime = Clock::now();
+            m_seekGeneration = 0;
+            m_errorString.clear();
+        }
+        m_videoThread = std::thread(&PreviewPlayer::videoLoop, this);
+        if (m_audioCallback) {
+            m_audioThread = std::thread(&PreviewPlayer::audioLoop, this);
+        }
+        return true;
+    }
+
+    void PreviewPlayer::close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+            m_playing = false;
+        }
+        m_cv.notify_all();
+        if (m_videoThread.joinable()) {
+            m_videoThread.join();
+        }
+        if (m_audioThread.joinable()) {
+            m_audioThread.join();
+        }
+    }
+
+    void PreviewPlayer::play()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_playing || m_stopping) {
+            return;
+        }
+        if (m_anchorPosition >= m_duration) {
+            m_anchorPosition = 0.0;
+            ++m_seekGeneration;
+        }
+        m_anchorTime = Clock::now();
+        m_playing = true;
+        m_cv.notify_all();
+    }
+
+    void PreviewPlayer::pause()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_playing) {
+            return;
+        }
+        m_anchorPosition = clockLocked();
+        m_playing = false;
+        m_cv.notify_all();
+    }
+
+    void PreviewPlayer::seek(double seconds)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_anchorPosition = std::clamp(seconds, 0.0, m_duration);
+        m_anchorTime = Clock::now();
+        m_presentPending = !m_playing;
+        ++m_seekGeneration;
+        m_cv.notify_all();
+    }
+
+    bool PreviewPlayer::isPlaying() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_playing;
+    }
+
+    double PreviewPlayer::position() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return clockLocked();
+    }
+
+    std::string PreviewPlayer::errorString() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_errorString;
+    }
+
+    double PreviewPlayer::clockLocked() const
+    {
+        if (!m_playing) {
+            return m_anchorPosition;
+        }
+        const double elapsed = std::chrono::duration<double>(Clock::now() - m_anchorTime).count();
+        return std::min(m_duration, m_anchorPosition + elapsed);
+    }
+
+    PreviewPlayer::Clock::time_point PreviewPlayer::wallTimeLocked(double seconds) const
+    {
+        return m_anchorTime + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds - m_anchorPosition));
+    }
+
+    int64_t PreviewPlayer::frameIndexAt(double seconds) const
+    {
+        return std::clamp<int64_t>(static_cast<int64_t>(std::floor(seconds * m_fps + 1e-6)), 0, m_totalFrames);
+    }
+
+    void PreviewPlayer::failLocked(std::unique_lock<std::mutex> &lock, const std::string &error)
+    {
+        m_errorString = error;
+        m_anchorPosition = clockLocked();
+        m_playing = false;
+        m_cv.notify_all();
+        lock.unlock();
+        if (m_finishedCallback) {
+            m_finishedCallback(false);
+        }
+        lock.lock();
+    }
+
+    void PreviewPlayer::videoLoop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        uint64_t generation = m_seekGeneration;
+        int64_t nextFrame = frameIndexAt(m_anchorPosition);
+        while (!m_stopping) {
+            if (generation != m_seekGeneration) {
+                generation = m_seekGeneration;
+                nextFrame = frameIndexAt(m_anchorPosition);
+            }
+            const auto interrupted = [&]() {
+                return m_stopping || !m_playing || generation != m_seekGeneration;
+            };
+
+            if (!m_playing) {
+                if (!m_presentPending || m_totalFrames <= 0) {
+                    m_cv.wait(lock);
+                    continue;
+                }
+                // 暂停时交付当前位置的画面（打开后与定位后）
+                m_presentPending = false;
+                const int64_t target = std::min(nextFrame, m_totalFrames - 1);
+                lock.unlock();
+                FFmpegUtils::AvFramePtr frame = m_frameRenderer.frameAtIndex(target, m_outputFormat);
+                if (frame && m_frameCallback) {
+                    m_frameCallback(frame.get(), target / m_fps);
+                }
+                lock.lock();
+                if (!frame) {
+                    failLocked(lock, m_frameRenderer.errorString());
+                }
+                continue;
+            }
+
+            if (nextFrame >= m_totalFrames) {
+                // 画面已全部交付，等时钟走到末尾后结束
+                if (m_cv.wait_until(lock, wallTimeLocked(m_duration), interrupted)) {
+                    continue;
+                }
+                m_anchorPosition = m_duration;
+                m_playing = false;
+                m_cv.notify_all();
+                lock.unlock();
+                if (m_finishedCallback) {
+                    m_finishedCallback(true);
+                }
+                lock.lock();
+                continue;
+            }
+
+            // 落后于时钟时直接跳到当前帧，过时的帧不合成
+            const int64_t due = frameIndexAt(clockLocked());
+            if (due > nextFrame) {
+                m_droppedFrames += due - nextFrame;
+                nextFrame = due;
+                continue;
+            }
+
+            const int64_t target = nextFrame;
+            lock.unlock();
+            FFmpegUtils::AvFramePtr frame = m_frameRenderer.frameAtIndex(target, m_outputFormat);
+            lock.lock();
+            if (!frame) {
+                failLocked(lock, m_frameRenderer.errorString());
+                continue;
+            }
+            // 提前合成完成时等到该帧的显示时刻；合成较慢时晚到的帧照常交付，下一轮再跳帧追赶
+            // 等待被暂停打断时该帧尚未交付，nextFrame 不前进，继续播放时重新合成
+            if (m_cv.wait_until(lock, wallTimeLocked(target / m_fps), interrupted)) {
+                continue;
+            }
+            lock.unlock();
+            if (m_frameCallback) {
+                m_frameCallback(frame.get(), target / m_fps);
+            }
+            lock.lock();
+            ++m_presentedFrames;
+            nextFrame = target + 1;
+        }
+    }
+
+    void PreviewPlayer::audioLoop()
+    {
+        const int sampleRate = m_audioMixer.sampleRate();
+        std::vector<float> left(kAudioChunk);
+        std::vector<float> right(kAudioChunk);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        uint64_t generation = m_seekGeneration;
+        while (!m_stopping) {
+            if (generation != m_seekGeneration) {
+                generation = m_seekGeneration;
+                const int64_t target = std::llround(m_anchorPosition * sampleRate);
+                lock.unlock();
+                const bool ok = m_audioMixer.seek(target);
+                lock.lock();
+                if (!ok) {
+                    failLocked(lock, m_audioMixer.errorString());
+                }
+                continue;
+            }
+            const int64_t position = m_audioMixer.position();
+            if (!m_playing || position >= m_audioMixer.totalSamples()) {
+                m_cv.wait(lock);
+                continue;
+            }
+
+            const int64_t clockSample = std::llround(clockLocked() * sampleRate);
+            if (clockSample - position > static_cast<int64_t>(kAudioMaxLagSeconds * sampleRate)) {
+                // 混音跟不上时丢弃到当前时钟，不交付
+                lock.unlock();
+                int64_t remaining = clockSample - position;
+                bool ok = true;
+                while (remaining > 0) {
+                    const int read = m_audioMixer.read(static_cast<int>(std::min<int64_t>(kAudioChunk, remaining)), left.data(), right.data());
+                    if (read <= 0) {
+                        ok = read == 0;
+                        break;
+                    }
+                    remaining -= read;
+                }
+                lock.lock();
+                if (!ok) {
+                    failLocked(lock, m_audioMixer.errorString());
+                }
+                continue;
+            }
+            if (position - clockSample > static_cast<int64_t>(kAudioLeadSeconds * sampleRate)) {
+                const double wakeAt = static_cast<double>(position) / sampleRate - kAudioLeadSeconds;
+                m_cv.wait_until(lock, wallTimeLocked(wakeAt), [&]() {
+                    return m_stopping || !m_playing || generation != m_seekGeneration;
+                });
+                continue;
+            }
+
+            lock.unlock();
+            const int read = m_audioMixer.read(kAudioChunk, left.data(), right.data());
+            if (read > 0) {
+                m_audioCallback(left.data(), right.data(), read, static_cast<double>(position) / sampleRate);
+            }
+            lock.lock();
+            if (read < 0) {
+                failLocked(lock, m_audioMixer.errorString());
+            }
+        }
+    }
+
+} // namespace VideoCreator
@@ -0,0 +1,109 @@
+#ifndef PREVIEW_PLAYER_H
+#define PREVIEW_PLAYER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "model/ProjectConfig.h"
+#include "engine/FrameRenderer.h"
+#include "engine/TimelineAudioMixer.h"
+#include "ffmpeg_utils/FFmpegHeaders.h"
+
+namespace VideoCreator
+{
+
+    // 实时预览：按挂钟时间播放工程，合成后的画面与混音 PCM 通过回调交给调用方，不编码也不写文件
+    // 画面由 FrameRenderer 合成，音频由 TimelineAudioMixer 混音，与正式渲染的合成流程一致
+    // 画面线程落后于时钟时跳过已过时的帧（不合成），音频线程落后过多时丢弃到当前时钟
+    // 音频最多提前 0.2 秒交付，调用方按自己的输出设备缓冲播放
+    class PreviewPlayer
+    {
+    public:
+        // frame 只在回调期间有效；seconds 为该帧的工程时间
+        using FrameCallback = std::function<void(const AVFrame *frame, double seconds)>;
+        // 立体声平面 float，已限幅
+        using AudioCallback = std::function<void(const float *left, const float *right, int samples, double seconds)>;
+        // 播放到末尾（ok 为 true）或出错（见 errorString）时调用
+        using FinishedCallback = std::function<void(bool ok)>;
+
+        PreviewPlayer();
+        ~PreviewPlayer();
+
+        PreviewPlayer(const PreviewPlayer &) = delete;
+        PreviewPlayer &operator=(const PreviewPlayer &) = delete;
+
+        // 以下需在 open 之前调用；回调在播放线程上执行（画面与音频各一个线程），不应长时间阻塞
+        // 未设置音频回调时不混音
+        void setFrameCallback(FrameCallback callback) { m_frameCallback = std::move(callback); }
+        void setAudioCallback(AudioCallback callback) { m_audioCallback = std::move(callback); }
+        void setFinishedCallback(FinishedCallback callback) { m_finishedCallback = std::move(callback); }
+        void setOutputFormat(FrameRenderer::OutputFormat format) { m_outputFormat = format; }
+
+        // 载入工程（场景时长需已由 ConfigLoader 推导）并启动播放线程，初始为暂停在开头并交付首帧
+        bool open(const ProjectConfig &config);
+        // 停止播放线程
+        void close();
+
+        // 在末尾调用 play 时从头播放
+        void play();
+        void pause();
+        // 播放中定位后继续播放；暂停时交付定位处的一帧
+        void seek(double seconds);
+
+        bool isPlaying() const;
+        double position() const;
+        double duration() const { return m_duration; }
+
+        // 已交付与因落后而跳过的画面帧数
+        int64_t presentedFrames() const { return m_presentedFrames.load(); }
+        int64_t droppedFrames() const { return m_droppedFrames.load(); }
+
+        std::string errorString() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        void videoLoop();
+        void audioLoop();
+
+        // 以下需持有 m_mutex
+        double clockLocked() const;
+        Clock::time_point wallTimeLocked(double seconds) const;
+        int64_t frameIndexAt(double seconds) const;
+        // 记录错误、暂停并调用结束回调（期间释放锁）
+        void failLocked(std::unique_lock<std::mutex> &lock, const std::string &error);
+
+        FrameCallback m_frameCallback;
+        AudioCallback m_audioCallback;
+        FinishedCallback m_finishedCallback;
+        FrameRenderer::OutputFormat m_outputFormat;
+
+        FrameRenderer m_frameRenderer;     // 只在画面线程使用
+        TimelineAudioMixer m_audioMixer;   // 只在音频线程使用
+        double m_fps;
+        int64_t m_totalFrames;
+        double m_duration;
+
+        std::thread m_videoThread;
+        std::thread m_audioThread;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_cv;
+        bool m_stopping;
+        bool m_playing;
+        bool m_presentPending;          // 暂停时需交付当前位置的画面
+        double m_anchorPosition;        // 时钟锚点：m_anchorTime 时刻的工程时间
+        Clock::time_point m_anchorTime;
+        uint64_t m_seekGeneration;
+        std::atomic<int64_t> m_presentedFrames{0};
+        std::atomic<int64_t> m_droppedFrames{0};
+        std::string m_errorString;
+    };
+
+} // namespace VideoCreator
+
+#endif // PREVIEW_PLAYER_H
@@ -0,0 +1,31 @@
+#include "ProjectTimeline.h"
+#include <cmath>
+
+namespace VideoCreator
+{
+
+    ProjectTimeline ProjectTimeline::build(const ProjectConfig &config, int sampleRate)
+    {
+        ProjectTimeline timeline;
+        const int fps = config.project.fps > 0 ? config.project.fps : 30;
+        auto frameToSample = [&](int64_t frame) {
+            return (frame * sampleRate + fps / 2) / fps;
+        };
+
+        timeline.entries.reserve(config.scenes.size());
+        int64_t frameCursor = 0;
+        for (const auto &scene : config.scenes) {
+            Entry entry;
+            entry.startFrame = frameCursor;
+            entry.frameCount = scene.duration > 0 ? static_cast<int>(std::round(scene.duration * fps)) : 0;
+            entry.startSample = frameToSample(frameCursor);
+            frameCursor += entry.frameCount;
+            entry.sampleCount = frameToSample(frameCursor) - entry.startSample;
+            timeline.entries.push_back(entry);
+        }
+        timeline.totalFrames = frameCursor;
+        timeline.totalSamples = frameToSample(frameCursor);
+        return timeline;
+    }
+
+} // namespace VideoCreator
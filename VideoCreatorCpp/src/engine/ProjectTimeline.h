@@ -0,0 +1,34 @@
+#ifndef PROJECT_TIMELINE_H
+#define PROJECT_TIMELINE_H
+
+#include <cstdint>
+#include <vector>
+#include "model/ProjectConfig.h"
+
+namespace VideoCreator
+{
+
+    // 渲染前预先确定的时间线：每个场景/转场的帧区间及对应的音频样本区间
+    // 音频预渲染线程与视频线程都按同一份计划推进，保证两条流逐场景对齐
+    struct ProjectTimeline
+    {
+        struct Entry
+        {
+            int64_t startFrame = 0;
+            int frameCount = 0;
+            int64_t startSample = 0;
+            int64_t sampleCount = 0;
+        };
+
+        std::vector<Entry> entries; // 与 ProjectConfig::scenes 一一对应
+        int64_t totalFrames = 0;
+        int64_t totalSamples = 0;
+
+        // 场景时长取自 scene.duration（ConfigLoader 已按媒体时长同步）
+        // 样本区间由累计帧号换算，避免逐场景取整产生漂移
+        static ProjectTimeline build(const ProjectConfig &config, int sampleRate);
+    };
+
+} // namespace VideoCreator
+
+#endif // PROJECT_TIMELINE_H
@@ -0,0 +1,21 @@
+#ifndef RENDER_BUFFERS_H
+#define RENDER_BUFFERS_H
+
+namespace VideoCreator
+{
+    // 渲染管线中各缓冲区的容量；MemoryEstimate 按同一组常量估算峰值内存
+    namespace RenderBuffers
+    {
+        // 视频场景解码线程与渲染线程之间的帧队列（帧数）
+        constexpr int kVideoQueueFrames = 8;
+
+        // StreamingAudioSource 每个音频图层/工程音轨预解码的时长（秒）
+        constexpr int kAudioBufferSeconds = 5;
+
+        // 音频预渲染的包队列上限（秒），工作线程领先过多时阻塞
+        constexpr int kAudioPrerenderSeconds = 30;
+    } // namespace RenderBuffers
+
+} // namespace VideoCreator
+
+#endif // RENDER_BUFFERS_H
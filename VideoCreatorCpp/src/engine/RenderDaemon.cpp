@@ -0,0 +1,281 @@
+#include "RenderDaemon.h"
+#include "RenderEngine.h"
+#include "MemoryEstimate.h"
+#include "decoder/ImageFrameCache.h"
+#include <QDebug>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QMetaObject>
+#include <algorithm>
+
+namespace VideoCreator
+{
+
+    namespace
+    {
+        // 单个请求行（一个工程 JSON）的上限，超过后断开客户端，避免无换行的输入无限占用内存
+        constexpr qint64 kMaxRequestLineBytes = 16 * 1024 * 1024;
+    }
+
+    RenderDaemon::RenderDaemon()
+    {
+        m_loader.setRetainProbeCache(true);
+    }
+
+    RenderDaemon::~RenderDaemon()
+    {
+        close();
+    }
+
+    void RenderDaemon::setImageCacheCapacity(size_t bytes)
+    {
+        ImageFrameCache::setCapacity(bytes);
+    }
+
+    bool RenderDaemon::listen(const QString &socketName)
+    {
+        if (m_server) {
+            m_errorString = "Daemon is already listening";
+            return false;
+        }
+        // 上次异常退出留下的套接字文件会导致 listen 失败
+        QLocalServer::removeServer(socketName);
+        m_server = std::make_unique<QLocalServer>();
+        // 任务可以读写本用户的任意文件，只允许同一用户连接
+        m_server->setSocketOptions(QLocalServer::UserAccessOption);
+        if (!m_server->listen(socketName)) {
+            m_errorString = "Cannot listen on " + socketName.toStdString() + ": " + m_server->errorString().toStdString();
+            m_server.reset();
+            return false;
+        }
+        QObject::connect(m_server.get(), &QLocalServer::newConnection, m_server.get(), [this]() { acceptConnections(); });
+
+        m_stopping = false;
+        m_admission = std::make_unique<AdmissionController>(m_memoryBudget, m_maxJobs);
+        m_dispatcher = std::thread(&RenderDaemon::dispatchLoop, this);
+        qDebug() << "Render daemon listening on" << socketName << "max jobs:" << m_maxJobs
+                 << "memory budget:" << m_memoryBudget / (1024 * 1024) << "MB";
+        return true;
+    }
+
+    void RenderDaemon::close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_jobMutex);
+            m_stopping = true;
+            m_jobs.clear();
+        }
+        m_jobCv.notify_all();
+        if (m_admission) {
+            m_admission->stop();
+        }
+        if (m_dispatcher.joinable()) {
+            m_dispatcher.join();
+        }
+        for (auto &client : m_clients) {
+            client.second->disconnectFromServer();
+            client.second->deleteLater();
+        }
+        m_clients.clear();
+        if (m_server) {
+            m_server->close();
+            m_server.reset();
+        }
+    }
+
+    void RenderDaemon::acceptConnections()
+    {
+        while (m_server->hasPendingConnections()) {
+            QLocalSocket *socket = m_server->nextPendingConnection();
+            const uint64_t clientId = m_nextClientId++;
+            m_clients[clientId] = socket;
+            QObject::connect(socket, &QLocalSocket::readyRead, socket, [this, clientId]() { readClient(clientId); });
+            QObject::connect(socket, &QLocalSocket::disconnected, socket, [this, clientId]() { dropClient(clientId); });
+        }
+    }
+
+    void RenderDaemon::readClient(uint64_t clientId)
+    {
+        auto it = m_clients.find(clientId);
+        if (it == m_clients.end()) {
+            return;
+        }
+        QLocalSocket *socket = it->second;
+        while (socket->canReadLine()) {
+            const QByteArray line = socket->readLine().trimmed();
+            if (line.size() > kMaxRequestLineBytes) {
+                rejectClient(clientId, "Request line exceeds " + std::to_string(kMaxRequestLineBytes) + " bytes");
+                return;
+            }
+            if (line.isEmpty()) {
+                continue;
+            }
+            Job job;
+            job.id = m_nextJobId++;
+            job.clientId = clientId;
+            job.json = line;
+
+            QJsonObject event;
+            event.insert("event", "queued");
+            event.insert("job", static_cast<qint64>(job.id));
+            writeEvent(clientId, event);
+            {
+                std::lock_guard<std::mutex> lock(m_jobMutex);
+                m_jobs.push_back(std::move(job));
+            }
+            m_jobCv.notify_one();
+        }
+        if (socket->bytesAvailable() > kMaxRequestLineBytes) {
+            rejectClient(clientId, "Request line exceeds " + std::to_string(kMaxRequestLineBytes) + " bytes");
+        }
+    }
+
+    void RenderDaemon::rejectClient(uint64_t clientId, const std::string &error)
+    {
+        auto it = m_clients.find(clientId);
+        if (it == m_clients.end()) {
+            return;
+        }
+        QJsonObject event;
+        event.insert("event", "failed");
+        event.insert("error", QString::fromStdString(error));
+        writeEvent(clientId, event);
+        qDebug() << "Render daemon: disconnecting client" << clientId << ":" << QString::fromStdString(error);
+        // disconnected 信号触发 dropClient 清理
+        it->second->disconnectFromServer();
+    }
+
+    void RenderDaemon::dropClient(uint64_t clientId)
+    {
+        auto it = m_clients.find(clientId);
+        if (it == m_clients.end()) {
+            return;
+        }
+        it->second->deleteLater();
+        m_clients.erase(it);
+
+        // 客户端断开后不再渲染它排队中的任务；正在渲染的任务会继续完成
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_jobs.erase(std::remove_if(m_jobs.begin(), m_jobs.end(), [clientId](const Job &job) { return job.clientId == clientId; }),
+                     m_jobs.end());
+    }
+
+    void RenderDaemon::writeEvent(uint64_t clientId, const QJsonObject &event)
+    {
+        auto it = m_clients.find(clientId);
+        if (it == m_clients.end()) {
+            return;
+        }
+        QByteArray line = QJsonDocument(event).toJson(QJsonDocument::Compact);
+        line.append('\n');
+        it->second->write(line);
+        it->second->flush();
+    }
+
+    void RenderDaemon::postEvent(uint64_t clientId, const QJsonObject &event)
+    {
+        QMetaObject::invokeMethod(m_server.get(), [this, clientId, event]() { writeEvent(clientId, event); }, Qt::QueuedConnection);
+    }
+
+    void RenderDaemon::dispatchLoop()
+    {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(m_jobMutex);
+                m_jobCv.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+                if (m_stopping) {
+                    break;
+                }
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+            reapRenders(false);
+
+            ProjectConfig config;
+            if (!loadJob(job, config)) {
+                continue;
+            }
+            // 按接收顺序准入，预算不足时阻塞在队首任务上，不让后面的小任务插队
+            const int64_t estimatedBytes = MemoryEstimate::fromConfig(config).total();
+            if (!m_admission->acquire(estimatedBytes)) {
+                break;
+            }
+            m_renders.emplace_back();
+            RenderThread &render = m_renders.back();
+            render.thread = std::thread([this, job, config, estimatedBytes, &render]() {
+                renderJob(job, config, estimatedBytes);
+                m_admission->release(estimatedBytes);
+                render.done.store(true);
+            });
+        }
+        reapRenders(true);
+    }
+
+    void RenderDaemon::reapRenders(bool wait)
+    {
+        for (auto it = m_renders.begin(); it != m_renders.end();) {
+            if (wait || it->done.load()) {
+                it->thread.join();
+                it = m_renders.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void RenderDaemon::postFailure(const Job &job, const std::string &error)
+    {
+        qDebug() << "Render daemon: job" << job.id << "failed:" << QString::fromStdString(error);
+        QJsonObject event;
+        event.insert("event", "failed");
+        event.insert("job", static_cast<qint64>(job.id));
+        event.insert("error", QString::fromStdString(error));
+        postEvent(job.clientId, event);
+    }
+
+    bool RenderDaemon::loadJob(const Job &job, ProjectConfig &config)
+    {
+        if (!m_loader.loadFromString(QString::fromUtf8(job.json), config)) {
+            postFailure(job, "Failed to load project: " + m_loader.errorString().toStdString());
+            return false;
+        }
+        // 守护进程的标准输出不连接客户端
+        if (config.project.output_path.empty() || config.project.output_path == "-") {
+            postFailure(job, "Daemon jobs need a file output_path");
+            return false;
+        }
+        return true;
+    }
+
+    void RenderDaemon::renderJob(const Job &job, const ProjectConfig &config, int64_t estimatedBytes)
+    {
+        const qint64 jobId = static_cast<qint64>(job.id);
+        QJsonObject started;
+        started.insert("event", "started");
+        started.insert("job", jobId);
+        started.insert("estimated_memory", static_cast<qint64>(estimatedBytes));
+        postEvent(job.clientId, started);
+
+        RenderEngine engine;
+        engine.setProgressCallback([this, &job, jobId](int progress) {
+            QJsonObject event;
+            event.insert("event", "progress");
+            event.insert("job", jobId);
+            event.insert("progress", progress);
+            postEvent(job.clientId, event);
+        });
+        if (!engine.initialize(config) || !engine.render()) {
+            postFailure(job, engine.errorString());
+            return;
+        }
+
+        QJsonObject finished;
+        finished.insert("event", "finished");
+        finished.insert("job", jobId);
+        finished.insert("output", QString::fromStdString(config.project.output_path));
+        postEvent(job.clientId, finished);
+    }
+
+} // namespace VideoCreator
@@ -0,0 +1,108 @@
+#ifndef RENDER_DAEMON_H
+#define RENDER_DAEMON_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+#include "model/ConfigLoader.h"
+#include "engine/AdmissionController.h"
+
+class QLocalServer;
+class QLocalSocket;
+
+namespace VideoCreator
+{
+
+    // 常驻渲染服务：在本地套接字（Unix 域套接字 / Windows 命名管道）上接收渲染任务
+    // 客户端每行发送一个工程 JSON（与 ConfigLoader 相同的格式），服务端逐行返回 JSON 事件：
+    //   {"event":"queued","job":N} / {"event":"started",...} / {"event":"progress","job":N,"progress":P}
+    //   {"event":"finished","job":N,"output":"..."} / {"event":"failed","job":N,"error":"..."}
+    // 进程内保持 FFmpeg 初始化、媒体探测缓存与已缩放图片缓存，短任务无需重复启动与探测
+    // 任务按接收顺序准入：并发数与预计峰值内存（MemoryEstimate）之和都在限制内时才开始渲染
+    class RenderDaemon
+    {
+    public:
+        RenderDaemon();
+        ~RenderDaemon();
+
+        RenderDaemon(const RenderDaemon &) = delete;
+        RenderDaemon &operator=(const RenderDaemon &) = delete;
+
+        // 进程级图片缓存容量（字节），0 表示不缓存
+        void setImageCacheCapacity(size_t bytes);
+        // 同时渲染的任务数上限与内存预算（字节，0 表示不限），需在 listen 之前调用
+        void setMaxConcurrentJobs(int jobs) { m_maxJobs = jobs; }
+        void setMemoryBudget(int64_t bytes) { m_memoryBudget = bytes; }
+
+        // 开始监听并启动任务线程；事件在调用线程的 Qt 事件循环中处理
+        bool listen(const QString &socketName);
+        // 停止接收连接，等待正在渲染的任务结束，丢弃排队中的任务
+        void close();
+
+        std::string errorString() const { return m_errorString; }
+
+    private:
+        struct Job
+        {
+            uint64_t id = 0;
+            uint64_t clientId = 0;
+            QByteArray json;
+        };
+
+        // 以下在事件循环线程调用
+        void acceptConnections();
+        void readClient(uint64_t clientId);
+        // 发送不带任务号的 failed 事件后断开客户端
+        void rejectClient(uint64_t clientId, const std::string &error);
+        void dropClient(uint64_t clientId);
+        void writeEvent(uint64_t clientId, const QJsonObject &event);
+
+        // 调度线程：依次加载排队的任务，估算峰值内存，准入后在独立线程中渲染
+        void dispatchLoop();
+        bool loadJob(const Job &job, ProjectConfig &config);
+        void renderJob(const Job &job, const ProjectConfig &config, int64_t estimatedBytes);
+        void reapRenders(bool wait);
+        void postFailure(const Job &job, const std::string &error);
+        // 从任务线程投递到事件循环线程写出
+        void postEvent(uint64_t clientId, const QJsonObject &event);
+
+        std::unique_ptr<QLocalServer> m_server;
+        std::unordered_map<uint64_t, QLocalSocket *> m_clients;
+        uint64_t m_nextClientId = 1;
+        uint64_t m_nextJobId = 1;
+
+        // 只在调度线程使用，探测缓存在任务之间保留
+        ConfigLoader m_loader;
+
+        struct RenderThread
+        {
+            std::thread thread;
+            std::atomic<bool> done{false};
+        };
+        std::list<RenderThread> m_renders; // 只在调度线程访问
+        std::unique_ptr<AdmissionController> m_admission;
+        int m_maxJobs = 1;
+        int64_t m_memoryBudget = 0;
+
+        std::thread m_dispatcher;
+        std::mutex m_jobMutex;
+        std::condition_variable m_jobCv;
+        std::deque<Job> m_jobs;
+        bool m_stopping = false;
+
+        std::string m_errorString;
+    };
+
+} // namespace VideoCreator
+
+#endif // RENDER_DAEMON_H
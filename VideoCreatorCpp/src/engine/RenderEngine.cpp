@@ -1,7 +1,11 @@
 #include "RenderEngine.h"
+#include "VideoStreamCopier.h"
+#include "RenderBuffers.h"
 #include "decoder/ImageDecoder.h"
+#include "decoder/ImageFrameCache.h"
 #include "decoder/AudioDecoder.h"
 #include "decoder/VideoDecoder.h"
+#include "decoder/FrameScaler.h"
 #include "filter/EffectProcessor.h"
 #include "ffmpeg_utils/AvFrameWrapper.h"
 #include "ffmpeg_utils/AvPacketWrapper.h"
@@ -63,26 +67,105 @@ namespace VideoCreator
         }
     }
 
+    // 编码器不支持目标采样率时取最接近的受支持值（AAC 等编码器只接受固定的几种采样率）
+    static int selectSupportedSampleRate(const AVCodec* codec, int requested) {
+        if (!codec->supported_samplerates) {
+            return requested;
+        }
+        int best = 0;
+        for (const int* rate = codec->supported_samplerates; *rate != 0; ++rate) {
+            if (*rate == requested) {
+                return requested;
+            }
+            if (best == 0 || std::abs(*rate - requested) < std::abs(best - requested)) {
+                best = *rate;
+            }
+        }
+        return best > 0 ? best : requested;
+    }
+
+    // 纯音频导出模式（output.mode 为 m4a / mp3 / wav）
+    static bool isAudioOnlyMode(const std::string& mode) {
+        return mode == "m4a" || mode == "mp3" || mode == "wav";
+    }
+
+    // 混音与 FIFO 固定使用 FLTP；编码器优先使用 FLTP，不支持时取其首选格式并在送入前转换
+    static AVSampleFormat selectEncoderSampleFormat(const AVCodec* codec) {
+        if (!codec->sample_fmts) {
+            return AV_SAMPLE_FMT_FLTP;
+        }
+        for (const AVSampleFormat* fmt = codec->sample_fmts; *fmt != AV_SAMPLE_FMT_NONE; ++fmt) {
+            if (*fmt == AV_SAMPLE_FMT_FLTP) {
+                return AV_SAMPLE_FMT_FLTP;
+            }
+        }
+        return codec->sample_fmts[0];
+    }
+
+
+#if LIBAVFORMAT_VERSION_MAJOR >= 61
+    using AvioWriteBuffer = const uint8_t *;
+#else
+    using AvioWriteBuffer = uint8_t *;
+#endif
+
+    // AVIOContext 写回调，转发给 OutputSink
+    static int writeToOutputSink(void *opaque, AvioWriteBuffer buf, int size) {
+        auto *sink = static_cast<OutputSink *>(opaque);
+        if (!sink || !sink->write) {
+            return AVERROR(EINVAL);
+        }
+        return sink->write(buf, size);
+    }
+
+    // AVIOContext 定位回调，转发给 OutputSink
+    static int64_t seekOutputSink(void *opaque, int64_t offset, int whence) {
+        auto *sink = static_cast<OutputSink *>(opaque);
+        whence &= ~AVSEEK_FORCE;
+        if (!sink || !sink->seek || whence == AVSEEK_SIZE) {
+            return AVERROR(ENOSYS);
+        }
+        return sink->seek(offset, whence);
+    }
+
+    // 额外输出档位：独立的封装器与视频编码器，音频流直接写入主输出编码好的包
+    struct RenditionOutput
+    {
+        RenditionConfig config;
+        FFmpegUtils::AvFormatContextPtr outputContext;
+        FFmpegUtils::AvCodecContextPtr videoCodecContext;
+        AVStream *videoStream = nullptr;
+        AVStream *audioStream = nullptr;
+        FrameScaler scaler;
+    };
 
     RenderEngine::RenderEngine()
-        : m_videoStream(nullptr), m_audioStream(nullptr), m_audioFifo(nullptr), m_frameCount(0), m_audioSamplesCount(0), m_progress(0),
-          m_totalProjectFrames(0), m_lastReportedProgress(-1), m_enableAudioTransition(false),
+        : m_sinkIOContext(nullptr), m_fragmentedOutput(false), m_segmentedOutput(false), m_forceKeyframePending(false), m_videoEncoderDrained(false), m_inBandParameterSets(false), m_videoSegmentStart(true), m_videoDtsShift(0), m_lastVideoDts(AV_NOPTS_VALUE),
+          m_nextSegmentKeyframe(0), m_segmentIntervalFrames(0), m_videoStream(nullptr), m_audioStream(nullptr), m_audioFifo(nullptr), m_audioOnly(false), m_audioEnabled(true), m_audioFrameSize(0), m_encoderSampleConverter(nullptr), m_frameCount(0), m_audioSamplesCount(0), m_progress(0),
+          m_totalProjectFrames(0), m_lastReportedProgress(-1),
+          m_audioPrerenderActive(false), m_currentSceneIndex(0), m_maxQueuedAudioPackets(0), m_audioPrerenderFinished(false), m_audioPrerenderFailed(false),
           m_reusableMixFrameCapacity(0)
     {
     }
 
     RenderEngine::~RenderEngine()
     {
+        stopAudioPrerender();
         if (m_audioFifo) {
             av_audio_fifo_free(m_audioFifo);
         }
+        swr_free(&m_encoderSampleConverter);
+        releaseSinkIOContext();
     }
 
     bool RenderEngine::initialize(const ProjectConfig &config)
     {
+        stopAudioPrerender();
         m_config = config;
         m_frameCount = 0;
         m_audioSamplesCount = 0;
+        m_audioErrorString.clear();
+        m_audioPrerenderStop.store(false);
         m_progress = 0;
         m_lastReportedProgress = -1;
         m_sceneFirstFrames.clear();
@@ -91,7 +174,19 @@ namespace VideoCreator
         m_mixBufferRight.clear();
         m_reusableMixFrame.reset();
         m_reusableMixFrameCapacity = 0;
-        scheduleVideoPrefetchTasks();
+        m_forceKeyframePending = false;
+        m_videoEncoderDrained = false;
+        m_inBandParameterSets = false;
+        m_videoSegmentStart = true;
+        m_videoDtsShift = 0;
+        m_lastVideoDts = AV_NOPTS_VALUE;
+        m_nextSegmentKeyframe = 0;
+        m_segmentIntervalFrames = 0;
+        m_renditions.clear();
+        m_audioOnly = isAudioOnlyMode(m_config.output.mode);
+        if (!m_audioOnly) {
+            scheduleVideoPrefetchTasks();
+        }
 
 
 
@@ -106,12 +201,28 @@ namespace VideoCreator
         m_totalProjectFrames = totalDuration * m_config.project.fps;
 
         if (!createOutputContext()) return false;
-        if (!createVideoStream()) return false;
-        if (!createAudioStream()) {
-             qDebug() << "音频流创建失败，将生成无声视频";
+        if (m_audioOnly) {
+            // 纯音频导出不创建视频流，也不会打开任何图片/视频解码器
+            if (!createAudioStream()) return false;
+        } else {
+            if (!createVideoStream()) return false;
+            if (!m_audioEnabled) {
+                qDebug() << "Audio output disabled, rendering video only";
+            } else if (!createAudioStream()) {
+                 qDebug() << "音频流创建失败，将生成无声视频";
+            }
+        }
+        // 场景帧数与音频样本区间都按同一条时间线推进，音频由 TimelineAudioMixer 统一混音（与预览播放共用）
+        m_timeline = ProjectTimeline::build(m_config, m_audioStream ? m_audioCodecContext->sample_rate : 44100);
+        if (m_audioStream && !m_timelineAudio.open(m_config, m_audioCodecContext->sample_rate)) {
+            m_errorString = "Failed to open timeline audio: " + m_timelineAudio.errorString();
+            return false;
         }
+        if (!m_audioOnly && !createRenditionOutputs()) return false;
 
-        int ret = avformat_write_header(m_outputContext.get(), nullptr);
+        AVDictionary *muxerOptions = buildMuxerOptions();
+        int ret = avformat_write_header(m_outputContext.get(), &muxerOptions);
+        av_dict_free(&muxerOptions);
         if (ret < 0) {
             m_errorString = format_ffmpeg_error(ret, "写入文件头失败");
             return false;
@@ -122,13 +233,27 @@ namespace VideoCreator
 
     bool RenderEngine::render()
     {
+        if (m_audioOnly) {
+            return renderAudioOnly();
+        }
+
         qDebug() << "开始渲染所有场景，总共" << m_config.scenes.size() << "个场景";
-        
+
+        const bool audioPrerender = m_audioStream && m_config.performance.audio_prerender;
+        if (audioPrerender && !startAudioPrerender()) {
+            return false;
+        }
+
         for (size_t i = 0; i < m_config.scenes.size(); ++i)
         {
             const auto &currentScene = m_config.scenes[i];
+            m_currentSceneIndex = i;
             qDebug() << "处理场景" << i << ": ID=" << currentScene.id << ", 类型=" << (currentScene.type == SceneType::TRANSITION ? "转场" : "普通");
 
+            if (m_segmentedOutput && m_config.output.align_to_scenes) {
+                m_forceKeyframePending = true;
+            }
+
             if (currentScene.type == SceneType::TRANSITION)
             {
                 if (i == 0 || i >= m_config.scenes.size() - 1) {
@@ -145,12 +270,17 @@ namespace VideoCreator
             }
         }
 
-        if (m_audioStream) {
-            if (!flushAudio()) return false;
+        if (audioPrerender) {
+            // 工作线程已冲洗音频编码器，这里写出队列中剩余的全部音频包
+            if (!writePrerenderedAudio(-1)) return false;
+            stopAudioPrerender();
+        } else if (m_audioStream) {
+            // 混入时间线剩余的音频（最后一帧之后不足一个音频帧的部分）并冲洗音频编码器
+            if (!renderAudioTimeline()) return propagateAudioError();
         }
 
         if (!flushEncoder(m_videoCodecContext.get(), m_videoStream)) return false;
-        if (!flushEncoder(m_audioCodecContext.get(), m_audioStream)) return false;
+        if (!finishRenditionOutputs()) return false;
 
         int ret = av_write_trailer(m_outputContext.get());
         if (ret < 0) {
@@ -160,27 +290,82 @@ namespace VideoCreator
 
         qDebug() << "视频渲染完成！总帧数: " << m_frameCount;
 
-        if (m_lastReportedProgress < 100) {
-            m_progress = 100;
-            m_lastReportedProgress = m_progress;
-        }
+        publishProgress(100);
 
         m_sceneFirstFramePrefetch.clear();
         return true;
     }
 
+    bool RenderEngine::renderAudioOnly()
+    {
+        qDebug() << "开始纯音频导出，总共" << m_config.scenes.size() << "个场景";
+
+        // 与音频预渲染共用时间线和混音流程，但在调用线程中直接写出，不生成、缩放或编码任何视频帧
+        if (!renderAudioTimeline()) {
+            return propagateAudioError();
+        }
+
+        int ret = av_write_trailer(m_outputContext.get());
+        if (ret < 0) {
+            m_errorString = format_ffmpeg_error(ret, "写入文件尾失败");
+            return false;
+        }
+
+        qDebug() << "音频导出完成！总样本数: " << m_audioSamplesCount;
+        publishProgress(100);
+        return true;
+    }
+
     bool RenderEngine::createOutputContext()
     {
+        releaseSinkIOContext();
+        m_outputContext.reset();
+
+        const bool useSink = static_cast<bool>(m_outputSink.write);
+        m_fragmentedOutput = m_config.output.mode == "fragmented_mp4";
+        m_segmentedOutput = m_config.output.mode == "hls" || m_config.output.mode == "dash";
+        if (m_segmentedOutput) {
+            if (useSink) {
+                m_errorString = "Segmented output (hls/dash) writes multiple files and cannot use an OutputSink";
+                return false;
+            }
+            m_segmentIntervalFrames = std::max<int64_t>(1, std::llround(m_config.output.segment_duration * m_config.project.fps));
+            m_nextSegmentKeyframe = m_segmentIntervalFrames;
+        }
+        const bool audioOnly = isAudioOnlyMode(m_config.output.mode);
+        if (useSink && !m_outputSink.seek && !m_fragmentedOutput && (!audioOnly || m_config.output.mode == "m4a")) {
+            // 不可寻址的回调目标无法回写 moov，只能输出分片 MP4
+            qDebug() << "自定义输出目标不可寻址，切换为分片 MP4 输出";
+            m_fragmentedOutput = true;
+        }
+
+        // "-" 表示标准输出，管道和回调没有扩展名可供推断容器格式
+        std::string outputUrl = m_config.project.output_path == "-" ? std::string("pipe:1") : m_config.project.output_path;
+        const bool isPipe = outputUrl.compare(0, 5, "pipe:") == 0;
+        const char *formatName = (useSink || isPipe || m_fragmentedOutput) ? "mp4" : nullptr;
+        if (m_segmentedOutput) {
+            // 分段模式下 output_path 是播放列表，分段文件写在同一目录
+            formatName = m_config.output.mode.c_str();
+        }
+        else if (audioOnly) {
+            // 不依赖扩展名推断，管道/回调输出同样适用；m4a 对应 FFmpeg 的 ipod 封装器
+            formatName = m_config.output.mode == "m4a" ? "ipod" : m_config.output.mode.c_str();
+        }
+
         AVFormatContext* temp_ctx = nullptr;
-        int ret = avformat_alloc_output_context2(&temp_ctx, nullptr, nullptr, m_config.project.output_path.c_str());
+        int ret = avformat_alloc_output_context2(&temp_ctx, nullptr, formatName, useSink ? nullptr : outputUrl.c_str());
         if (ret < 0) {
             m_errorString = format_ffmpeg_error(ret, "创建输出上下文失败");
             return false;
         }
         m_outputContext.reset(temp_ctx);
 
+        if (useSink) {
+            return createSinkIOContext();
+        }
+
         if (!(m_outputContext->oformat->flags & AVFMT_NOFILE)) {
-            ret = avio_open(&m_outputContext->pb, m_config.project.output_path.c_str(), AVIO_FLAG_WRITE);
+            ret = avio_open(&m_outputContext->pb, outputUrl.c_str(), AVIO_FLAG_WRITE);
             if (ret < 0) {
                 m_errorString = format_ffmpeg_error(ret, "无法打开输出文件");
                 return false;
@@ -189,6 +374,247 @@ namespace VideoCreator
         return true;
     }
 
+    bool RenderEngine::createSinkIOContext()
+    {
+        const int bufferSize = 64 * 1024;
+        auto *buffer = static_cast<unsigned char *>(av_malloc(bufferSize));
+        if (!buffer) {
+            m_errorString = "Failed to allocate output sink buffer";
+            return false;
+        }
+        m_sinkIOContext = avio_alloc_context(buffer, bufferSize, 1, &m_outputSink, nullptr, writeToOutputSink,
+                                             m_outputSink.seek ? seekOutputSink : nullptr);
+        if (!m_sinkIOContext) {
+            av_free(buffer);
+            m_errorString = "Failed to create output sink AVIOContext";
+            return false;
+        }
+        m_outputContext->pb = m_sinkIOContext;
+        m_outputContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+        return true;
+    }
+
+    void RenderEngine::releaseSinkIOContext()
+    {
+        if (!m_sinkIOContext) {
+            return;
+        }
+        // 自定义 IO 不能交给 AvFormatContextDeleter 的 avio_closep 释放
+        if (m_outputContext && m_outputContext->pb == m_sinkIOContext) {
+            m_outputContext->pb = nullptr;
+        }
+        av_freep(&m_sinkIOContext->buffer);
+        avio_context_free(&m_sinkIOContext);
+    }
+
+    AVDictionary *RenderEngine::buildMuxerOptions() const
+    {
+        AVDictionary *options = nullptr;
+        if (m_fragmentedOutput) {
+            // 每个分片以关键帧开头，至少 fragment_duration 秒；moov 提前写出，分片完成即刷出
+            const double fragmentSeconds = m_config.output.fragment_duration > 0 ? m_config.output.fragment_duration : 2.0;
+            av_dict_set(&options, "movflags", "frag_keyframe+empty_moov+default_base_moof", 0);
+            av_dict_set_int(&options, "min_frag_duration", static_cast<int64_t>(fragmentSeconds * AV_TIME_BASE), 0);
+            av_dict_set(&options, "flush_packets", "1", 0);
+        }
+        else if (m_segmentedOutput) {
+            // 分段文件名以播放列表文件名为前缀，相对播放列表所在目录
+            const std::string &playlistPath = m_config.project.output_path;
+            const size_t dot = playlistPath.find_last_of('.');
+            const size_t slash = playlistPath.find_last_of("/\\");
+            const bool hasExtension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+            const std::string pathStem = hasExtension ? playlistPath.substr(0, dot) : playlistPath;
+            const std::string fileStem = slash == std::string::npos ? pathStem : pathStem.substr(slash + 1);
+            const std::string segmentSeconds = std::to_string(m_config.output.segment_duration);
+
+            if (m_config.output.mode == "hls") {
+                const bool fmp4 = m_config.output.segment_type == "fmp4";
+                av_dict_set(&options, "hls_time", segmentSeconds.c_str(), 0);
+                av_dict_set(&options, "hls_playlist_type", "vod", 0);
+                av_dict_set(&options, "hls_list_size", "0", 0);
+                av_dict_set(&options, "hls_flags", "independent_segments", 0);
+                av_dict_set(&options, "hls_segment_type", fmp4 ? "fmp4" : "mpegts", 0);
+                av_dict_set(&options, "hls_segment_filename", (pathStem + (fmp4 ? "_%05d.m4s" : "_%05d.ts")).c_str(), 0);
+                if (fmp4) {
+                    av_dict_set(&options, "hls_fmp4_init_filename", (fileStem + "_init.mp4").c_str(), 0);
+                }
+            } else {
+                av_dict_set(&options, "seg_duration", segmentSeconds.c_str(), 0);
+                av_dict_set(&options, "use_template", "1", 0);
+                av_dict_set(&options, "use_timeline", "1", 0);
+                av_dict_set(&options, "init_seg_name", (fileStem + "_init_$RepresentationID$.m4s").c_str(), 0);
+                av_dict_set(&options, "media_seg_name", (fileStem + "_$RepresentationID$_$Number%05d$.m4s").c_str(), 0);
+            }
+        }
+        return options;
+    }
+
+    bool RenderEngine::encodeAndWriteVideoFrame(AVFrame *frame)
+    {
+        if (m_videoEncoderDrained && !openVideoEncoder()) {
+            // 上一段为直接复制的素材：新编码器从 IDR 开始，参数集随码流带内输出
+            return false;
+        }
+        frame->pts = m_frameCount;
+        frame->pict_type = AV_PICTURE_TYPE_NONE;
+        if (m_segmentedOutput) {
+            // 分段只能在关键帧处切分：按分段间隔和场景起点强制 IDR，使分段边界可预测
+            if (m_frameCount >= m_nextSegmentKeyframe) {
+                m_forceKeyframePending = true;
+                while (m_nextSegmentKeyframe <= m_frameCount) {
+                    m_nextSegmentKeyframe += m_segmentIntervalFrames;
+                }
+            }
+            if (m_forceKeyframePending) {
+                frame->pict_type = AV_PICTURE_TYPE_I;
+                m_forceKeyframePending = false;
+            }
+        }
+
+        int ret = avcodec_send_frame(m_videoCodecContext.get(), frame);
+        if (ret < 0) {
+            m_errorString = format_ffmpeg_error(ret, "发送视频帧到编码器失败");
+            return false;
+        }
+        auto packet = FFmpegUtils::createAvPacket();
+        while ((ret = avcodec_receive_packet(m_videoCodecContext.get(), packet.get())) == 0) {
+            packet->stream_index = m_videoStream->index;
+            av_packet_rescale_ts(packet.get(), m_videoCodecContext->time_base, m_videoStream->time_base);
+            if (!writeVideoPacket(packet.get())) {
+                return false;
+            }
+        }
+        if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
+            m_errorString = format_ffmpeg_error(ret, "从编码器接收视频包失败");
+            return false;
+        }
+        if (!m_renditions.empty() && !encodeRenditionFrames(frame)) {
+            return false;
+        }
+        if (m_audioPrerenderActive) {
+            return writePrerenderedAudio(frame->pts + 1);
+        }
+        return true;
+    }
+
+    bool RenderEngine::writeVideoPacket(AVPacket *packet)
+    {
+        // 每段（一次编码器会话或一个复制的场景）首包的 PTS 与 DTS 之差是该段的 B 帧延迟。
+        // 延迟较小的段整段 DTS 前移到编码器的延迟，拼接处 DTS 连续递增，PTS 保持不变
+        if (m_videoSegmentStart && packet->pts != AV_NOPTS_VALUE && packet->dts != AV_NOPTS_VALUE) {
+            const int64_t outputDelay = av_rescale_q(m_videoCodecContext->has_b_frames, m_videoCodecContext->time_base, m_videoStream->time_base);
+            m_videoDtsShift = std::min<int64_t>(0, (packet->pts - packet->dts) - outputDelay);
+            m_videoSegmentStart = false;
+        }
+        if (packet->dts != AV_NOPTS_VALUE) {
+            packet->dts += m_videoDtsShift;
+            if (m_lastVideoDts != AV_NOPTS_VALUE && packet->dts <= m_lastVideoDts) {
+                m_errorString = "Non-monotonic video DTS at a stream-copy splice";
+                return false;
+            }
+            m_lastVideoDts = packet->dts;
+        }
+        int ret = av_interleaved_write_frame(m_outputContext.get(), packet);
+        if (ret < 0) {
+            m_errorString = format_ffmpeg_error(ret, "写入视频包失败");
+            return false;
+        }
+        return true;
+    }
+
+    int RenderEngine::scaleThreadCount() const
+    {
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        if (hardwareThreads == 0) {
+            hardwareThreads = 4;
+        }
+        const int maxThreads = static_cast<int>(hardwareThreads);
+        if (m_config.performance.scale_threads > 0) {
+            return std::min(m_config.performance.scale_threads, maxThreads);
+        }
+        // 自动：视频编码器最多占 8 个线程且与缩放并行运行，缩放取硬件线程的 1/4，上限 4
+        return std::max(1, std::min(4, maxThreads / 4));
+    }
+
+    bool RenderEngine::canStreamCopyScene(const SceneConfig &scene) const
+    {
+        if (!m_config.performance.smart_render || scene.type != SceneType::VIDEO_SCENE || m_audioOnly) {
+            return false;
+        }
+        // 复制的压缩包不经过合成，额外档位拿不到这些帧
+        if (!m_renditions.empty()) {
+            return false;
+        }
+        // 拼接后的码流含多组参数集，只有 avc3/hev1 样本描述允许带内切换；
+        // 分片/分段输出以及不支持该样本描述的封装格式整段重新编码
+        if (!m_inBandParameterSets) {
+            return false;
+        }
+        // 裁剪与特效需要逐帧处理，这类场景整段走解码重编码
+        if (scene.resources.video.trim_start > 0 || scene.resources.video.trim_end >= 0 || scene.effects.ken_burns.enabled) {
+            return false;
+        }
+        return true;
+    }
+
+    int RenderEngine::copyVideoPacket(VideoStreamCopier &copier, int sceneStartFrame, int sceneEndFrame, int &copiedEndFrame)
+    {
+        auto packet = FFmpegUtils::createAvPacket();
+        if (!packet) {
+            m_errorString = "Failed to allocate video packet";
+            return -1;
+        }
+        const AVRational sourceTimeBase = copier.timeBase();
+        const int64_t sourceStart = copier.startPts();
+        const AVRational frameTimeBase{1, m_config.project.fps};
+        int64_t frame = 0;
+        while (true) {
+            const int ret = copier.readPacket(packet.get());
+            if (ret <= 0) {
+                if (ret < 0) {
+                    m_errorString = "Stream copy failed: " + copier.errorString();
+                }
+                return ret;
+            }
+            if (packet->pts == AV_NOPTS_VALUE) {
+                m_errorString = "Stream copy failed: packet without timestamp";
+                return -1;
+            }
+            // 按显示时间而不是解码顺序截取：显示在场景终点之后的包（及解码顺序上其后依赖它的包）不再复制，
+            // 显示在素材首帧之前的前导包只用于重排，同样丢弃
+            frame = sceneStartFrame + av_rescale_q(packet->pts - sourceStart, sourceTimeBase, frameTimeBase);
+            if (frame >= sceneEndFrame) {
+                return 0;
+            }
+            if (frame >= sceneStartFrame) {
+                break;
+            }
+            av_packet_unref(packet.get());
+        }
+
+        // 以素材首帧为零点，平移到场景在输出时间线上的起点
+        const int64_t offset = av_rescale_q(sceneStartFrame, AVRational{1, m_config.project.fps}, m_videoStream->time_base);
+        if (packet->pts != AV_NOPTS_VALUE) {
+            packet->pts = offset + av_rescale_q(packet->pts - sourceStart, sourceTimeBase, m_videoStream->time_base);
+        }
+        if (packet->dts != AV_NOPTS_VALUE) {
+            packet->dts = offset + av_rescale_q(packet->dts - sourceStart, sourceTimeBase, m_videoStream->time_base);
+        }
+        if (packet->duration > 0) {
+            packet->duration = av_rescale_q(packet->duration, sourceTimeBase, m_videoStream->time_base);
+        }
+        packet->stream_index = m_videoStream->index;
+        packet->pos = -1;
+        if (!writeVideoPacket(packet.get())) {
+            return -1;
+        }
+        copiedEndFrame = std::max(copiedEndFrame, static_cast<int>(frame) + 1);
+        if (m_audioPrerenderActive && !writePrerenderedAudio(m_frameCount + 1)) {
+            return -1;
+        }
+        return 1;
+    }
+
     bool RenderEngine::createVideoStream()
     {
         const AVCodec *videoCodec = avcodec_find_encoder_by_name(m_config.global_effects.video_encoding.codec.c_str());
@@ -203,51 +629,268 @@ namespace VideoCreator
         }
         m_videoStream->id = m_outputContext->nb_streams - 1;
 
-        AVCodecContext* temp_ctx = avcodec_alloc_context3(videoCodec);
-        if (!temp_ctx) {
-            m_errorString = "创建视频编码器上下文失败";
+        if (!openVideoEncoder()) {
+            return false;
+        }
+
+        int ret = avcodec_parameters_from_context(m_videoStream->codecpar, m_videoCodecContext.get());
+        if (ret < 0) {
+            m_errorString = format_ffmpeg_error(ret, "复制视频流参数失败");
+            return false;
+        }
+        m_videoStream->time_base = m_videoCodecContext->time_base;
+
+        // avc1/hvc1 的样本描述只能携带一组参数集，复制的素材与编码器输出的 SPS/PPS 不同，
+        // 智能渲染改用 avc3/hev1 样本描述，解码器以每个 IDR 前的带内参数集为准
+        m_inBandParameterSets = false;
+        if (m_config.performance.smart_render && !m_fragmentedOutput && !m_segmentedOutput &&
+            (videoCodec->id == AV_CODEC_ID_H264 || videoCodec->id == AV_CODEC_ID_HEVC)) {
+            const unsigned int inBandTag = videoCodec->id == AV_CODEC_ID_HEVC ? MKTAG('h', 'e', 'v', '1') : MKTAG('a', 'v', 'c', '3');
+            const AVOutputFormat *outputFormat = m_outputContext->oformat;
+            if (outputFormat->codec_tag && av_codec_get_id(outputFormat->codec_tag, inBandTag) == videoCodec->id) {
+                m_videoStream->codecpar->codec_tag = inBandTag;
+                m_inBandParameterSets = true;
+            }
+        }
+        return true;
+    }
+
+    bool RenderEngine::openVideoEncoder()
+    {
+        auto encoder = createVideoEncoder(m_config.project.width, m_config.project.height,
+                                          m_config.global_effects.video_encoding.bitrate, m_config.global_effects.video_encoding.crf);
+        if (!encoder) {
             return false;
         }
-        m_videoCodecContext.reset(temp_ctx);
+        m_videoCodecContext = std::move(encoder);
+        m_videoEncoderDrained = false;
+        m_videoSegmentStart = true;
+        return true;
+    }
 
-        m_videoCodecContext->width = m_config.project.width;
-        m_videoCodecContext->height = m_config.project.height;
-        m_videoCodecContext->time_base = {1, m_config.project.fps};
-        m_videoCodecContext->framerate = {m_config.project.fps, 1};
-        m_videoCodecContext->pix_fmt = AV_PIX_FMT_YUV420P;
-        std::string bitrateStr = m_config.global_effects.video_encoding.bitrate;
-        m_videoCodecContext->bit_rate = parseBitrate(bitrateStr);
-        m_videoCodecContext->gop_size = 12;
+    FFmpegUtils::AvCodecContextPtr RenderEngine::createVideoEncoder(int width, int height, const std::string &bitrate, int crf)
+    {
+        const AVCodec *videoCodec = avcodec_find_encoder_by_name(m_config.global_effects.video_encoding.codec.c_str());
+        if (!videoCodec) {
+            m_errorString = "找不到视频编码器: " + m_config.global_effects.video_encoding.codec;
+            return nullptr;
+        }
+
+        FFmpegUtils::AvCodecContextPtr encoder(avcodec_alloc_context3(videoCodec));
+        if (!encoder) {
+            m_errorString = "创建视频编码器上下文失败";
+            return nullptr;
+        }
+
+        encoder->width = width;
+        encoder->height = height;
+        encoder->time_base = {1, m_config.project.fps};
+        encoder->framerate = {m_config.project.fps, 1};
+        encoder->pix_fmt = AV_PIX_FMT_YUV420P;
+        encoder->bit_rate = parseBitrate(bitrate);
+        encoder->gop_size = 12;
         unsigned int hardwareThreads = std::thread::hardware_concurrency();
         if (hardwareThreads == 0) {
             hardwareThreads = 4;
         }
-        m_videoCodecContext->thread_count = static_cast<int>(std::min(8u, hardwareThreads));
-        m_videoCodecContext->thread_type = FF_THREAD_FRAME;
+        encoder->thread_count = static_cast<int>(std::min(8u, hardwareThreads));
+        encoder->thread_type = FF_THREAD_FRAME;
+
+        if ((m_fragmentedOutput || m_segmentedOutput) && (m_outputContext->oformat->flags & AVFMT_GLOBALHEADER)) {
+            // empty_moov / 分段初始化段在写文件头时就需要 SPS/PPS
+            encoder->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        }
+        if (m_segmentedOutput) {
+            // 强制的 I 帧必须是 IDR，分段才能独立解码
+            av_opt_set(encoder->priv_data, "forced-idr", "1", 0);
+        }
 
-        av_opt_set(m_videoCodecContext->priv_data, "preset", m_config.global_effects.video_encoding.preset.c_str(), 0);
-        av_opt_set_int(m_videoCodecContext->priv_data, "crf", m_config.global_effects.video_encoding.crf, 0);
+        av_opt_set(encoder->priv_data, "preset", m_config.global_effects.video_encoding.preset.c_str(), 0);
+        if (crf >= 0) {
+            av_opt_set_int(encoder->priv_data, "crf", crf, 0);
+        }
 
-        int ret = avcodec_open2(m_videoCodecContext.get(), videoCodec, nullptr);
+        int ret = avcodec_open2(encoder.get(), videoCodec, nullptr);
         if (ret < 0) {
             m_errorString = format_ffmpeg_error(ret, "打开视频编码器失败");
-            return false;
+            return nullptr;
         }
+        return encoder;
+    }
 
-        ret = avcodec_parameters_from_context(m_videoStream->codecpar, m_videoCodecContext.get());
-        if (ret < 0) {
-            m_errorString = format_ffmpeg_error(ret, "复制视频流参数失败");
-            return false;
+    bool RenderEngine::createRenditionOutputs()
+    {
+        for (const auto &config : m_config.output.renditions) {
+            auto rendition = std::make_unique<RenditionOutput>();
+            rendition->config = config;
+            rendition->scaler.setThreadCount(scaleThreadCount());
+
+            AVFormatContext *temp_ctx = nullptr;
+            int ret = avformat_alloc_output_context2(&temp_ctx, nullptr, "mp4", config.output_path.c_str());
+            if (ret < 0) {
+                m_errorString = format_ffmpeg_error(ret, "Failed to create rendition output: " + config.output_path);
+                return false;
+            }
+            rendition->outputContext.reset(temp_ctx);
+
+            // 设置了码率时按码率编码（libx264 在 crf 与码率同时设置时取 crf），否则使用档位或全局 crf
+            const int crf = !config.bitrate.empty() ? -1 : (config.crf >= 0 ? config.crf : m_config.global_effects.video_encoding.crf);
+            rendition->videoCodecContext = createVideoEncoder(config.width, config.height, config.bitrate, crf);
+            if (!rendition->videoCodecContext) {
+                m_errorString = "Rendition " + config.output_path + ": " + m_errorString;
+                return false;
+            }
+            rendition->videoStream = avformat_new_stream(rendition->outputContext.get(), nullptr);
+            if (!rendition->videoStream) {
+                m_errorString = "Failed to create rendition video stream: " + config.output_path;
+                return false;
+            }
+            ret = avcodec_parameters_from_context(rendition->videoStream->codecpar, rendition->videoCodecContext.get());
+            if (ret < 0) {
+                m_errorString = format_ffmpeg_error(ret, "Failed to copy rendition video parameters");
+                return false;
+            }
+            rendition->videoStream->time_base = rendition->videoCodecContext->time_base;
+
+            if (m_audioStream) {
+                // 音频只编码一次，各档位复制主输出的 AAC 流参数并写入同一批包
+                rendition->audioStream = avformat_new_stream(rendition->outputContext.get(), nullptr);
+                if (!rendition->audioStream) {
+                    m_errorString = "Failed to create rendition audio stream: " + config.output_path;
+                    return false;
+                }
+                ret = avcodec_parameters_copy(rendition->audioStream->codecpar, m_audioStream->codecpar);
+                if (ret < 0) {
+                    m_errorString = format_ffmpeg_error(ret, "Failed to copy rendition audio parameters");
+                    return false;
+                }
+                rendition->audioStream->time_base = m_audioStream->time_base;
+            }
+
+            ret = avio_open(&rendition->outputContext->pb, config.output_path.c_str(), AVIO_FLAG_WRITE);
+            if (ret < 0) {
+                m_errorString = format_ffmpeg_error(ret, "Failed to open rendition output: " + config.output_path);
+                return false;
+            }
+            ret = avformat_write_header(rendition->outputContext.get(), nullptr);
+            if (ret < 0) {
+                m_errorString = format_ffmpeg_error(ret, "Failed to write rendition header: " + config.output_path);
+                return false;
+            }
+            qDebug() << "Rendition" << QString::fromStdString(config.output_path) << config.width << "x" << config.height;
+            m_renditions.push_back(std::move(rendition));
+        }
+        return true;
+    }
+
+    bool RenderEngine::encodeRenditionFrames(const AVFrame *frame)
+    {
+        // 合成帧已是 limited range，缩放只改变尺寸
+        const int colorspace = frame->colorspace != AVCOL_SPC_UNSPECIFIED ? frame->colorspace : AVCOL_SPC_BT709;
+        for (auto &rendition : m_renditions) {
+            AVCodecContext *encoder = rendition->videoCodecContext.get();
+            auto scaled = FFmpegUtils::createAvFrame(encoder->width, encoder->height, AV_PIX_FMT_YUV420P);
+            if (!scaled) {
+                m_errorString = "Failed to allocate rendition frame";
+                return false;
+            }
+            if (!rendition->scaler.scale(frame, scaled.get(), false, colorspace)) {
+                m_errorString = "Rendition scaling failed: " + rendition->scaler.getErrorString();
+                return false;
+            }
+            // 时间戳与强制关键帧标记与主输出一致
+            av_frame_copy_props(scaled.get(), frame);
+
+            int ret = avcodec_send_frame(encoder, scaled.get());
+            if (ret < 0) {
+                m_errorString = format_ffmpeg_error(ret, "Failed to send rendition frame");
+                return false;
+            }
+            auto packet = FFmpegUtils::createAvPacket();
+            while ((ret = avcodec_receive_packet(encoder, packet.get())) == 0) {
+                packet->stream_index = rendition->videoStream->index;
+                av_packet_rescale_ts(packet.get(), encoder->time_base, rendition->videoStream->time_base);
+                ret = av_interleaved_write_frame(rendition->outputContext.get(), packet.get());
+                if (ret < 0) {
+                    m_errorString = format_ffmpeg_error(ret, "Failed to write rendition video packet");
+                    return false;
+                }
+            }
+            if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
+                m_errorString = format_ffmpeg_error(ret, "Failed to receive rendition packet");
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool RenderEngine::writeRenditionAudio(const AVPacket *packet)
+    {
+        for (auto &rendition : m_renditions) {
+            if (!rendition->audioStream) {
+                continue;
+            }
+            // 写入会取走包的引用，每个档位写一份共享数据缓冲的副本
+            FFmpegUtils::AvPacketPtr copy(av_packet_clone(packet));
+            if (!copy) {
+                m_errorString = "Failed to clone audio packet for rendition";
+                return false;
+            }
+            copy->stream_index = rendition->audioStream->index;
+            av_packet_rescale_ts(copy.get(), m_audioStream->time_base, rendition->audioStream->time_base);
+            int ret = av_interleaved_write_frame(rendition->outputContext.get(), copy.get());
+            if (ret < 0) {
+                m_errorString = format_ffmpeg_error(ret, "Failed to write rendition audio packet");
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool RenderEngine::finishRenditionOutputs()
+    {
+        for (auto &rendition : m_renditions) {
+            AVCodecContext *encoder = rendition->videoCodecContext.get();
+            int ret = avcodec_send_frame(encoder, nullptr);
+            if (ret < 0 && ret != AVERROR_EOF) {
+                m_errorString = format_ffmpeg_error(ret, "Failed to flush rendition encoder");
+                return false;
+            }
+            auto packet = FFmpegUtils::createAvPacket();
+            while ((ret = avcodec_receive_packet(encoder, packet.get())) == 0) {
+                packet->stream_index = rendition->videoStream->index;
+                av_packet_rescale_ts(packet.get(), encoder->time_base, rendition->videoStream->time_base);
+                ret = av_interleaved_write_frame(rendition->outputContext.get(), packet.get());
+                if (ret < 0) {
+                    m_errorString = format_ffmpeg_error(ret, "Failed to write rendition video packet");
+                    return false;
+                }
+            }
+            if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
+                m_errorString = format_ffmpeg_error(ret, "Failed to receive rendition packet (flush)");
+                return false;
+            }
+            ret = av_write_trailer(rendition->outputContext.get());
+            if (ret < 0) {
+                m_errorString = format_ffmpeg_error(ret, "Failed to write rendition trailer: " + rendition->config.output_path);
+                return false;
+            }
         }
-        m_videoStream->time_base = m_videoCodecContext->time_base;
         return true;
     }
 
     bool RenderEngine::createAudioStream()
     {
-        const AVCodec *audioCodec = avcodec_find_encoder_by_name(m_config.global_effects.audio_encoding.codec.c_str());
+        // mp3 / wav 导出的编码器由容器决定，其余沿用 audio_encoding.codec
+        std::string codecName = m_config.global_effects.audio_encoding.codec;
+        if (m_config.output.mode == "mp3") {
+            codecName = "libmp3lame";
+        } else if (m_config.output.mode == "wav") {
+            codecName = "pcm_s16le";
+        }
+        const AVCodec *audioCodec = avcodec_find_encoder_by_name(codecName.c_str());
         if (!audioCodec) {
-            m_errorString = "找不到音频编码器: " + m_config.global_effects.audio_encoding.codec;
+            m_errorString = "找不到音频编码器: " + codecName;
             return false;
         }
         m_audioStream = avformat_new_stream(m_outputContext.get(), audioCodec);
@@ -264,10 +907,15 @@ namespace VideoCreator
         }
         m_audioCodecContext.reset(temp_ctx);
 
-        m_audioCodecContext->sample_fmt = AV_SAMPLE_FMT_FLTP;
+        m_audioCodecContext->sample_fmt = selectEncoderSampleFormat(audioCodec);
         std::string bitrateStr = m_config.global_effects.audio_encoding.bitrate;
         m_audioCodecContext->bit_rate = parseBitrate(bitrateStr);
-        m_audioCodecContext->sample_rate = 44100;
+        // 输出采样率由 ConfigLoader 按输入素材确定，与之相同的素材解码时无需重采样
+        const int requestedSampleRate = m_config.project.sample_rate > 0 ? m_config.project.sample_rate : 44100;
+        m_audioCodecContext->sample_rate = selectSupportedSampleRate(audioCodec, requestedSampleRate);
+        if (m_audioCodecContext->sample_rate != requestedSampleRate) {
+            qDebug() << "Audio encoder does not support" << requestedSampleRate << "Hz, using" << m_audioCodecContext->sample_rate << "Hz";
+        }
         av_channel_layout_from_mask(&m_audioCodecContext->ch_layout, AV_CH_LAYOUT_STEREO);
         m_audioCodecContext->time_base = {1, m_audioCodecContext->sample_rate};
         unsigned int audioThreads = std::thread::hardware_concurrency();
@@ -275,6 +923,9 @@ namespace VideoCreator
             audioThreads = 2;
         }
         m_audioCodecContext->thread_count = static_cast<int>(std::min(4u, audioThreads));
+        if ((m_fragmentedOutput || m_segmentedOutput) && (m_outputContext->oformat->flags & AVFMT_GLOBALHEADER)) {
+            m_audioCodecContext->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        }
 
         int ret = avcodec_open2(m_audioCodecContext.get(), audioCodec, nullptr);
         if (ret < 0) {
@@ -286,7 +937,22 @@ namespace VideoCreator
             m_errorString = format_ffmpeg_error(ret, "复制音频流参数失败");
             return false;
         }
-        m_audioFifo = av_audio_fifo_alloc(m_audioCodecContext->sample_fmt, m_audioCodecContext->ch_layout.nb_channels, 1);
+        // PCM 等可变帧长编码器 frame_size 为 0，按固定块大小送入
+        m_audioFrameSize = m_audioCodecContext->frame_size > 0 ? m_audioCodecContext->frame_size : 1024;
+        swr_free(&m_encoderSampleConverter);
+        if (m_audioCodecContext->sample_fmt != AV_SAMPLE_FMT_FLTP) {
+            ret = swr_alloc_set_opts2(&m_encoderSampleConverter,
+                                      &m_audioCodecContext->ch_layout, m_audioCodecContext->sample_fmt, m_audioCodecContext->sample_rate,
+                                      &m_audioCodecContext->ch_layout, AV_SAMPLE_FMT_FLTP, m_audioCodecContext->sample_rate, 0, nullptr);
+            if (ret >= 0) {
+                ret = swr_init(m_encoderSampleConverter);
+            }
+            if (ret < 0) {
+                m_errorString = format_ffmpeg_error(ret, "Failed to create encoder sample format converter");
+                return false;
+            }
+        }
+        m_audioFifo = av_audio_fifo_alloc(AV_SAMPLE_FMT_FLTP, m_audioCodecContext->ch_layout.nb_channels, 1);
         if (!m_audioFifo) {
             m_errorString = "创建音频FIFO缓冲区失败";
             return false;
@@ -297,52 +963,6 @@ namespace VideoCreator
 
     bool RenderEngine::renderScene(const SceneConfig &scene)
     {
-        struct SceneAudioLayer
-        {
-            std::unique_ptr<AudioDecoder> decoder;
-            std::deque<float> channels[2];
-            int64_t delaySamples = 0;
-            std::mutex mutex;
-            std::condition_variable cv;
-            std::thread worker;
-            bool finished = false;
-            bool error = false;
-            std::atomic<bool> stopRequested{false};
-            std::string errorMessage;
-        };
-
-        struct AudioLayerThreadGuard
-        {
-            explicit AudioLayerThreadGuard(std::vector<std::unique_ptr<SceneAudioLayer>> &layerRefs)
-                : layers(layerRefs){}
-
-            std::vector<std::unique_ptr<SceneAudioLayer>> &layers;
-            ~AudioLayerThreadGuard()
-            {
-                stop();
-            }
-            void stop()
-            {
-                for (auto &layerPtr : layers)
-                {
-                    if (!layerPtr)
-                    {
-                        continue;
-                    }
-                    auto &layer = *layerPtr;
-                    {
-                        std::lock_guard<std::mutex> lock(layer.mutex);
-                        layer.stopRequested.store(true);
-                    }
-                    layer.cv.notify_all();
-                    if (layer.worker.joinable())
-                    {
-                        layer.worker.join();
-                    }
-                }
-            }
-        };
-
         struct AsyncFrameQueue
         {
             std::mutex mutex;
@@ -382,64 +1002,79 @@ namespace VideoCreator
             resolveScenePrefetch(scene);
         }
 
+        const int scaleThreads = scaleThreadCount();
         ImageDecoder imageDecoder;
-        if (!isVideoScene && !scene.resources.image.path.empty() && !imageDecoder.open(scene.resources.image.path)) {
+        imageDecoder.setScaleThreads(scaleThreads);
+        // 常驻进程启用图片缓存时，命中的场景无需打开和解码图片
+        FFmpegUtils::AvFramePtr cachedImageFrame;
+        if (!isVideoScene && !scene.resources.image.path.empty()) {
+            cachedImageFrame = ImageFrameCache::find(scene.resources.image.path, m_config.project.width, m_config.project.height);
+        }
+        if (!isVideoScene && !cachedImageFrame && !scene.resources.image.path.empty() && !imageDecoder.open(scene.resources.image.path)) {
              qDebug() << "无法打开图片: " << imageDecoder.getErrorString();
         }
 
         VideoDecoder videoDecoder;
+        videoDecoder.setScaleThreads(scaleThreads);
+        std::unique_ptr<VideoStreamCopier> streamCopier;
         bool videoSourceAvailable = false;
         if (isVideoScene) {
             if (scene.resources.video.path.empty()) {
                 m_errorString = "视频场景缺少视频文件路径";
                 return false;
             }
-            if (!videoDecoder.open(scene.resources.video.path)) {
+            if (canStreamCopyScene(scene)) {
+                streamCopier = std::make_unique<VideoStreamCopier>();
+                if (streamCopier->open(scene.resources.video.path, m_videoCodecContext.get(), m_config.project.fps)) {
+                    qDebug() << "Scene" << scene.id << "is stream-copied without re-encoding";
+                } else {
+                    qDebug() << "Scene" << scene.id << "cannot be stream-copied:" << streamCopier->errorString().c_str();
+                    streamCopier.reset();
+                }
+            }
+            if (!streamCopier && !videoDecoder.open(scene.resources.video.path)) {
                 m_errorString = "无法打开视频: " + videoDecoder.getErrorString();
                 return false;
             }
             videoSourceAvailable = true;
         }
 
-        double sceneDuration = scene.duration;
-        if (isVideoScene && videoSourceAvailable)
-        {
-            double videoDuration = videoDecoder.getDuration();
-            if (videoDuration > 0)
-            {
-                sceneDuration = videoDuration;
-                qDebug() << "Scene duration synced to video length:" << sceneDuration << "s";
-            }
-        }
-
-        std::vector<std::unique_ptr<SceneAudioLayer>> sceneAudioLayers;
-        AudioLayerThreadGuard audioLayerGuard(sceneAudioLayers);
-        double longestAudioDuration = -1.0;
-
         AsyncFrameQueue videoFrameQueue;
         FrameThreadGuard videoThreadGuard(videoFrameQueue);
-        if (isVideoScene && videoSourceAvailable)
+        if (isVideoScene && videoSourceAvailable && !streamCopier)
         {
-            const size_t maxVideoQueueSize = 8;
+            const size_t maxVideoQueueSize = RenderBuffers::kVideoQueueFrames;
+            const double sourceFps = videoDecoder.getFrameRate();
+            if (sourceFps > 0 && std::abs(sourceFps - m_config.project.fps) > 0.01) {
+                qDebug() << "Scene" << scene.id << "converts" << sourceFps << "fps source to" << m_config.project.fps << "fps";
+            }
+            videoDecoder.setOutputFrameRate(m_config.project.fps);
             videoThreadGuard.worker = std::thread([&, maxVideoQueueSize]() {
-                while (true)
-                {
-                    if (videoFrameQueue.stopRequested.load())
-                    {
-                        break;
-                    }
-                    FFmpegUtils::AvFramePtr decodedFrame;
-                    int decodeResult = videoDecoder.decodeFrame(decodedFrame);
-                    if (decodeResult > 0 && decodedFrame)
+                // 帧率转换：源帧按 VideoDecoder::frameSlot 映射到输出槽位，槽位空档重复上一帧，落在同一槽位的多帧只保留最后一帧
+                // 待定帧要等下一帧到达才知道输出几次；被丢弃的帧不做缩放
+                FFmpegUtils::AvFramePtr pendingFrame;
+                FFmpegUtils::AvFramePtr pendingScaled;
+                double pendingTime = 0.0;
+                int64_t nextSlot = 0;
+
+                auto reportError = [&](const std::string &message) {
+                    std::lock_guard<std::mutex> lock(videoFrameQueue.mutex);
+                    videoFrameQueue.error = true;
+                    videoFrameQueue.errorMessage = message;
+                    videoFrameQueue.cv.notify_all();
+                };
+                // 把待定帧输出到 endSlot 之前的各槽位；返回 false 表示出错或已请求停止
+                auto emitPendingUntil = [&](int64_t endSlot) {
+                    while (nextSlot < endSlot)
                     {
-                        auto scaledFrame = videoDecoder.scaleFrame(decodedFrame.get(), m_config.project.width, m_config.project.height, AV_PIX_FMT_YUV420P);
-                        if (!scaledFrame)
+                        if (!pendingScaled)
                         {
-                            std::lock_guard<std::mutex> lock(videoFrameQueue.mutex);
-                            videoFrameQueue.error = true;
-                            videoFrameQueue.errorMessage = "Failed to scale video frame: " + videoDecoder.getErrorString();
-                            videoFrameQueue.cv.notify_all();
-                            break;
+                            pendingScaled = videoDecoder.scaleFrame(pendingFrame.get(), m_config.project.width, m_config.project.height, AV_PIX_FMT_YUV420P);
+                            if (!pendingScaled)
+                            {
+                                reportError("Failed to scale video frame: " + videoDecoder.getErrorString());
+                                return false;
+                            }
                         }
                         std::unique_lock<std::mutex> lock(videoFrameQueue.mutex);
                         videoFrameQueue.cv.wait(lock, [&]() {
@@ -447,305 +1082,89 @@ namespace VideoCreator
                         });
                         if (videoFrameQueue.stopRequested.load())
                         {
-                            break;
+                            return false;
                         }
-                        videoFrameQueue.frames.push_back(std::move(scaledFrame));
+                        videoFrameQueue.frames.push_back(FFmpegUtils::copyAvFrame(pendingScaled.get()));
                         lock.unlock();
                         videoFrameQueue.cv.notify_all();
+                        ++nextSlot;
                     }
-                    else if (decodeResult == 0)
+                    return true;
+                };
+
+                while (true)
+                {
+                    if (videoFrameQueue.stopRequested.load())
                     {
-                        std::lock_guard<std::mutex> lock(videoFrameQueue.mutex);
-                        videoFrameQueue.finished = true;
-                        videoFrameQueue.cv.notify_all();
                         break;
                     }
-                    else
+                    FFmpegUtils::AvFramePtr decodedFrame;
+                    int decodeResult = videoDecoder.decodeFrame(decodedFrame);
+                    if (decodeResult > 0 && decodedFrame)
                     {
-                        std::lock_guard<std::mutex> lock(videoFrameQueue.mutex);
-                        videoFrameQueue.error = true;
-                        videoFrameQueue.errorMessage = "Failed to decode video frame: " + videoDecoder.getErrorString();
-                        videoFrameQueue.cv.notify_all();
-                        break;
-                    }
-                }
-            });
-        }
-
-        if (m_audioStream) {
-            const int targetSampleRate = (m_audioCodecContext && m_audioCodecContext->sample_rate > 0) ? m_audioCodecContext->sample_rate : 44100;
-            const size_t maxBufferedSamples = static_cast<size_t>(targetSampleRate) * 5;
-            size_t expectedLayers = 0;
-            if (!scene.resources.audio.path.empty()) {
-                expectedLayers++;
-            }
-            expectedLayers += scene.resources.audio_layers.size();
-            if (isVideoScene && scene.resources.video.use_audio && !scene.resources.video.path.empty()) {
-                expectedLayers++;
-            }
-            if (expectedLayers > 0) {
-                sceneAudioLayers.reserve(expectedLayers);
-            }
-            std::vector<AudioConfig> transientAudioConfigs;
-            auto startAudioLayerWorker = [&](SceneAudioLayer &layerRef) {
-                SceneAudioLayer *layerPtr = &layerRef;
-                layerRef.worker = std::thread([layerPtr, maxBufferedSamples]() {
-                    while (true) {
+                        double frameTime = 0.0;
+                        const int64_t frameSlot = videoDecoder.frameSlot(decodedFrame.get(), pendingFrame ? pendingTime : -1.0, frameTime);
+                        if (pendingFrame && !emitPendingUntil(frameSlot))
                         {
-                            std::lock_guard<std::mutex> lock(layerPtr->mutex);
-                            if (layerPtr->stopRequested.load()) {
-                                break;
-                            }
-                        }
-                        FFmpegUtils::AvFramePtr frame;
-                        int decodeResult = layerPtr->decoder->decodeFrame(frame);
-                        if (decodeResult > 0 && frame) {
-                            int channelCount = frame->ch_layout.nb_channels > 0 ? frame->ch_layout.nb_channels : 1;
-                            channelCount = std::min(channelCount, 2);
-                            std::unique_lock<std::mutex> lock(layerPtr->mutex);
-                            layerPtr->cv.wait(lock, [&]() {
-                                return layerPtr->stopRequested.load() || layerPtr->channels[0].size() < maxBufferedSamples;
-                            });
-                            if (layerPtr->stopRequested.load()) {
-                                break;
-                            }
-                            for (int ch = 0; ch < channelCount; ++ch) {
-                                float *data = reinterpret_cast<float *>(frame->data[ch]);
-                                layerPtr->channels[ch].insert(layerPtr->channels[ch].end(), data, data + frame->nb_samples);
-                            }
-                            if (channelCount == 1) {
-                                auto copyBegin = layerPtr->channels[0].end() - frame->nb_samples;
-                                layerPtr->channels[1].insert(layerPtr->channels[1].end(), copyBegin, layerPtr->channels[0].end());
-                            }
-                            size_t maxSamples = std::max(layerPtr->channels[0].size(), layerPtr->channels[1].size());
-                            layerPtr->channels[0].resize(maxSamples, 0.0f);
-                            layerPtr->channels[1].resize(maxSamples, 0.0f);
-                            lock.unlock();
-                            layerPtr->cv.notify_all();
-                        } else if (decodeResult == 0) {
-                            std::lock_guard<std::mutex> lock(layerPtr->mutex);
-                            layerPtr->finished = true;
-                            layerPtr->cv.notify_all();
-                            break;
-                        } else {
-                            std::lock_guard<std::mutex> lock(layerPtr->mutex);
-                            layerPtr->error = true;
-                            layerPtr->errorMessage = layerPtr->decoder ? layerPtr->decoder->getErrorString() : std::string("Audio decode failed");
-                            layerPtr->cv.notify_all();
                             break;
                         }
+                        pendingFrame = std::move(decodedFrame);
+                        pendingScaled.reset();
+                        pendingTime = frameTime;
                     }
-                });
-            };
-
-            auto addAudioLayer = [&](const AudioConfig &audioConfig, bool applySceneEffect, bool isCritical) {
-                if (audioConfig.path.empty()) {
-                    return true;
-                }
-
-                auto decoder = std::make_unique<AudioDecoder>();
-                if (!decoder->open(audioConfig.path)) {
-                    qDebug() << "Failed to open audio:" << QString::fromStdString(audioConfig.path) << "reason:" << decoder->getErrorString().c_str();
-                    return !isCritical;
-                }
-
-                bool effectOk = false;
-                if (applySceneEffect) {
-                    effectOk = decoder->applyVolumeEffect(scene);
-                } else {
-                    effectOk = decoder->applyVolumeEffect(audioConfig.volume, nullptr, sceneDuration);
-                }
-
-                if (!effectOk) {
-                    qDebug() << "Volume effect failed:" << decoder->getErrorString().c_str();
-                    return !isCritical;
-                }
-
-                double decoderDuration = decoder->getDuration();
-                if (decoderDuration > longestAudioDuration) {
-                    longestAudioDuration = decoderDuration;
-                }
-
-                auto layer = std::make_unique<SceneAudioLayer>();
-                layer->decoder = std::move(decoder);
-                if (audioConfig.start_offset > 0) {
-                    layer->delaySamples = static_cast<int64_t>(std::round(audioConfig.start_offset * targetSampleRate));
-                }
-                SceneAudioLayer &layerRef = *layer;
-                sceneAudioLayers.emplace_back(std::move(layer));
-                startAudioLayerWorker(layerRef);
-                return true;
-            };
-
-            if (!scene.resources.audio.path.empty()) {
-                if (!addAudioLayer(scene.resources.audio, true, true)) {
-                    m_errorString = "Failed to initialize primary audio source";
-                    return false;
-                }
-            }
-
-            for (const auto &layerConfig : scene.resources.audio_layers) {
-                addAudioLayer(layerConfig, false, false);
-            }
-
-            if (isVideoScene && scene.resources.video.use_audio && !scene.resources.video.path.empty()) {
-                transientAudioConfigs.push_back(AudioConfig{});
-                auto &videoAudioConfig = transientAudioConfigs.back();
-                videoAudioConfig.path = scene.resources.video.path;
-                videoAudioConfig.volume = 1.0;
-                videoAudioConfig.start_offset = 0.0;
-                bool treatAsPrimary = scene.resources.audio.path.empty() && scene.resources.audio_layers.empty();
-                if (!addAudioLayer(videoAudioConfig, treatAsPrimary, treatAsPrimary) && treatAsPrimary) {
-                    m_errorString = "Failed to initialize video audio";
-                    return false;
-                }
-            }
-        }
-
-        auto enqueueSilenceFrame = [&](int requiredSamples) -> bool {
-            if (!m_audioStream || requiredSamples <= 0) {
-                return true;
-            }
-            if (!ensureReusableAudioFrame(requiredSamples)) {
-                return false;
-            }
-            AVFrame *audioFrame = m_reusableMixFrame.get();
-            av_samples_set_silence(audioFrame->data, 0, audioFrame->nb_samples, audioFrame->ch_layout.nb_channels, (AVSampleFormat)audioFrame->format);
-            if (av_audio_fifo_write(m_audioFifo, (void **)audioFrame->data, audioFrame->nb_samples) < audioFrame->nb_samples) {
-                m_errorString = "Failed to enqueue silence frame into FIFO";
-                return false;
-            }
-            return true;
-        };
-
-        auto mixSceneAudio = [&](int samplesNeeded) -> bool {
-            if (!m_audioStream || samplesNeeded <= 0) {
-                return true;
-            }
-            if (sceneAudioLayers.empty()) {
-                return enqueueSilenceFrame(samplesNeeded);
-            }
-
-            m_mixBufferLeft.assign(samplesNeeded, 0.0f);
-            m_mixBufferRight.assign(samplesNeeded, 0.0f);
-            bool hasActiveLayer = false;
-            bool hasPendingAudio = false;
-
-            for (auto &layerPtr : sceneAudioLayers) {
-                if (!layerPtr) {
-                    continue;
-                }
-                auto &layer = *layerPtr;
-                if (layer.delaySamples >= samplesNeeded) {
-                    layer.delaySamples -= samplesNeeded;
-                    if (!layer.finished) {
-                        hasPendingAudio = true;
-                    }
-                    continue;
-                }
-
-                int silentSamples = 0;
-                if (layer.delaySamples > 0) {
-                    silentSamples = static_cast<int>(layer.delaySamples);
-                    layer.delaySamples = 0;
-                }
-
-                const int requiredSamples = samplesNeeded - silentSamples;
-                int consumed = 0;
-                while (consumed < requiredSamples) {
-                    std::unique_lock<std::mutex> lock(layer.mutex);
-                    layer.cv.wait(lock, [&]() {
-                        return layer.stopRequested.load() || layer.error || !layer.channels[0].empty() || layer.finished;
-                    });
-                    if (layer.error) {
-                        std::string errorCopy = layer.errorMessage;
-                        lock.unlock();
-                        m_errorString = errorCopy.empty() ? std::string("Audio decode failed") : errorCopy;
-                        return false;
-                    }
-                    if (layer.channels[0].empty()) {
-                        if (layer.finished || layer.stopRequested.load()) {
-                            lock.unlock();
-                            break;
+                    else if (decodeResult == 0)
+                    {
+                        // 最后一帧持续一个源帧时长，且至少输出一次
+                        if (pendingFrame)
+                        {
+                            const int64_t endSlot = std::max(nextSlot + 1, videoDecoder.slotAt(pendingTime + videoDecoder.sourceFrameDuration()));
+                            if (!emitPendingUntil(endSlot))
+                            {
+                                break;
+                            }
                         }
-                        lock.unlock();
-                        continue;
+                        std::lock_guard<std::mutex> lock(videoFrameQueue.mutex);
+                        videoFrameQueue.finished = true;
+                        videoFrameQueue.cv.notify_all();
+                        break;
                     }
-
-                    int available = static_cast<int>(layer.channels[0].size());
-                    int take = std::min(requiredSamples - consumed, available);
-                    if (take > 0) {
-                        hasActiveLayer = true;
-                        for (int i = 0; i < take; ++i) {
-                            const int dstIndex = silentSamples + consumed + i;
-                            m_mixBufferLeft[dstIndex] += layer.channels[0].front();
-                            layer.channels[0].pop_front();
-                            m_mixBufferRight[dstIndex] += layer.channels[1].front();
-                            layer.channels[1].pop_front();
-                        }
-                        consumed += take;
-                        bool bufferHasData = !layer.channels[0].empty() || !layer.channels[1].empty();
-                        if (bufferHasData || !layer.finished) {
-                            hasPendingAudio = true;
-                        }
+                    else
+                    {
+                        reportError("Failed to decode video frame: " + videoDecoder.getErrorString());
+                        break;
                     }
-                    lock.unlock();
-                    layer.cv.notify_all();
-                }
-
-                if (!layer.finished) {
-                    hasPendingAudio = true;
-                }
-            }
-
-            if (!hasActiveLayer && !hasPendingAudio) {
-                return enqueueSilenceFrame(samplesNeeded);
-            }
-
-            if (!ensureReusableAudioFrame(samplesNeeded)) {
-                return false;
-            }
-
-            AVFrame *mixedFrame = m_reusableMixFrame.get();
-            const int outputChannels = m_audioCodecContext->ch_layout.nb_channels > 0 ? m_audioCodecContext->ch_layout.nb_channels : 2;
-            for (int ch = 0; ch < outputChannels && ch < 2; ++ch) {
-                float *dst = reinterpret_cast<float *>(mixedFrame->data[ch]);
-                const auto &source = (ch == 0) ? m_mixBufferLeft : m_mixBufferRight;
-                for (int i = 0; i < samplesNeeded; ++i) {
-                    float value = source[i];
-                    value = std::clamp(value, -1.0f, 1.0f);
-                    dst[i] = value;
                 }
-            }
-
-            if (av_audio_fifo_write(m_audioFifo, (void **)mixedFrame->data, mixedFrame->nb_samples) < mixedFrame->nb_samples) {
-                m_errorString = "Failed to write mixed audio to FIFO";
-                return false;
-            }
-            return true;
-        };
-
-        if ((!isVideoScene || !videoSourceAvailable || sceneDuration <= 0) && !sceneAudioLayers.empty() && longestAudioDuration > 0)
-        {
-            sceneDuration = longestAudioDuration;
-            qDebug() << "Scene duration synced to audio length:" << sceneDuration << "s";
+            });
         }
 
-
-        int totalVideoFramesInScene = static_cast<int>(std::round(sceneDuration * m_config.project.fps));
+        // 音频按预先确定的时间线混音，画面帧数必须与之一致（scene.duration 已在 ConfigLoader 中同步到媒体时长）
+        const int totalVideoFramesInScene = m_timeline.entries[m_currentSceneIndex].frameCount;
         if (totalVideoFramesInScene <= 0) {
             qDebug() << "场景 " << scene.id << " 时长为0，跳过渲染。";
             return true;
         }
+        if (streamCopier && !m_videoEncoderDrained) {
+            // 复制的包必须接在编码器已送出的全部帧之后：先冲洗编码器，下一段编码时重新打开
+            if (!flushEncoder(m_videoCodecContext.get(), m_videoStream)) {
+                return false;
+            }
+            m_videoEncoderDrained = true;
+        }
+        if (streamCopier) {
+            m_videoSegmentStart = true;
+        }
 
         EffectProcessor effectProcessor;
         effectProcessor.initialize(m_config.project.width, m_config.project.height, AV_PIX_FMT_YUV420P, m_config.project.fps);
         
-        FFmpegUtils::AvFramePtr sourceImageFrame;
-        if (!isVideoScene && imageDecoder.getWidth() > 0) {
+        FFmpegUtils::AvFramePtr sourceImageFrame = std::move(cachedImageFrame);
+        if (!isVideoScene && !sourceImageFrame && imageDecoder.getWidth() > 0) {
             sourceImageFrame = imageDecoder.decodeAndCache();
              if (sourceImageFrame) {
                 auto scaledFrame = imageDecoder.scaleToSize(sourceImageFrame, m_config.project.width, m_config.project.height, AV_PIX_FMT_YUV420P);
+                if (scaledFrame) {
+                    ImageFrameCache::insert(scene.resources.image.path, m_config.project.width, m_config.project.height, scaledFrame.get());
+                }
                 sourceImageFrame = scaledFrame ? std::move(scaledFrame) : std::move(sourceImageFrame);
             }
         }
@@ -765,20 +1184,53 @@ namespace VideoCreator
         int startFrameCount = m_frameCount;
         bool videoEOF = false;
         FFmpegUtils::AvFramePtr lastFrameCopy;
+        int copiedEndFrame = startFrameCount;
 
         while (m_frameCount < startFrameCount + totalVideoFramesInScene)
         {
             double video_time = (double)m_frameCount / m_config.project.fps;
-            double audio_time = m_audioStream ? (double)m_audioSamplesCount / m_audioCodecContext->sample_rate : video_time + 1.0; 
+            double audio_time = (m_audioStream && !m_audioPrerenderActive) ? (double)m_audioSamplesCount / m_audioCodecContext->sample_rate : video_time + 1.0; 
 
             if (video_time <= audio_time) {
                 // --- VIDEO PART ---
+                if (streamCopier) {
+                    const int copied = copyVideoPacket(*streamCopier, startFrameCount, startFrameCount + totalVideoFramesInScene, copiedEndFrame);
+                    if (copied < 0) {
+                        return false;
+                    }
+                    if (copied > 0) {
+                        m_frameCount++;
+                        updateAndReportProgress();
+                        continue;
+                    }
+                    // 素材提前结束或在场景终点处截断：从最后显示的复制帧之后起，
+                    // 以重新编码的该帧补齐剩余帧号，输出 PTS 连续
+                    streamCopier.reset();
+                    m_frameCount = std::max(m_frameCount, copiedEndFrame);
+                    if (m_frameCount >= startFrameCount + totalVideoFramesInScene) {
+                        if (m_audioPrerenderActive && !writePrerenderedAudio(m_frameCount)) {
+                            return false;
+                        }
+                        break;
+                    }
+                    const double holdTime = static_cast<double>(std::max(0, copiedEndFrame - 1 - startFrameCount)) / m_config.project.fps;
+                    lastFrameCopy = extractVideoFrameAt(scene, holdTime);
+                    if (!lastFrameCopy) {
+                        return false;
+                    }
+                    videoEOF = true;
+                    continue;
+                }
+
                 FFmpegUtils::AvFramePtr videoFrame;
 
-                if (isVideoScene) {
-                    if (videoEOF) {
+                if (isVideoScene && videoEOF) {
+                    // 音频按计划帧数生成，视频提前结束时重复最后一帧保持同步
+                    if (!lastFrameCopy) {
                         break;
                     }
+                    videoFrame = FFmpegUtils::copyAvFrame(lastFrameCopy.get());
+                } else if (isVideoScene) {
                     std::unique_lock<std::mutex> lock(videoFrameQueue.mutex);
                     videoFrameQueue.cv.wait(lock, [&]() {
                         return videoFrameQueue.stopRequested.load() || videoFrameQueue.error || !videoFrameQueue.frames.empty() || videoFrameQueue.finished;
@@ -793,6 +1245,9 @@ namespace VideoCreator
                         if (videoFrameQueue.finished || videoFrameQueue.stopRequested.load()) {
                             videoEOF = true;
                             lock.unlock();
+                            if (lastFrameCopy) {
+                                continue;
+                            }
                             break;
                         }
                         lock.unlock();
@@ -818,41 +1273,23 @@ namespace VideoCreator
 
                 cacheSceneFirstFrame(scene, videoFrame.get());
                 lastFrameCopy = FFmpegUtils::copyAvFrame(videoFrame.get());
-                videoFrame->pts = m_frameCount;
-                int ret = avcodec_send_frame(m_videoCodecContext.get(), videoFrame.get());
-                if (ret < 0) {
-                    m_errorString = format_ffmpeg_error(ret, "发送视频帧到编码器失败");
+                if (!encodeAndWriteVideoFrame(videoFrame.get())) {
                     return false;
                 }
-                auto packet = FFmpegUtils::createAvPacket();
-                while ((ret = avcodec_receive_packet(m_videoCodecContext.get(), packet.get())) == 0) {
-                    packet->stream_index = m_videoStream->index;
-                    av_packet_rescale_ts(packet.get(), m_videoCodecContext->time_base, m_videoStream->time_base);
-                    ret = av_interleaved_write_frame(m_outputContext.get(), packet.get());
-                    if (ret < 0) {
-                        m_errorString = format_ffmpeg_error(ret, "写入视频包失败");
-                        return false;
-                    }
-                    av_packet_unref(packet.get());
-                }
-                if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
-                     m_errorString = format_ffmpeg_error(ret, "从编码器接收视频包失败");
-                     return false;
-                }
                 m_frameCount++;
                 updateAndReportProgress();
 
             } else {
                 // --- AUDIO PART ---
                 if (m_audioStream) {
-                    const int frame_size = (m_audioCodecContext && m_audioCodecContext->frame_size > 0) ? m_audioCodecContext->frame_size : 1024;
+                    const int frame_size = m_audioFrameSize;
                     if (av_audio_fifo_size(m_audioFifo) < frame_size) {
-                        if (!mixSceneAudio(frame_size)) {
-                            return false;
+                        if (!mixTimelineAudio(frame_size)) {
+                            return propagateAudioError();
                         }
                     }
                     if (!sendBufferedAudioFrames()) {
-                        return false;
+                        return propagateAudioError();
                     }
                 }
             }
@@ -865,16 +1302,15 @@ namespace VideoCreator
 
     bool RenderEngine::renderTransition(const SceneConfig &transitionScene, const SceneConfig &fromScene, const SceneConfig &toScene)
     {
-        int64_t startAudioSampleCount = m_audioSamplesCount;
         int totalFrames = static_cast<int>(std::round(transitionScene.duration * m_config.project.fps));
 
-        if (m_audioStream && m_enableAudioTransition) {
-            if (!renderAudioTransition(fromScene, toScene, transitionScene.duration)) {
-                return false;
-            }
-        }
+        // 转场音频（交叉淡化或静音，工程音轨照常混入）由 TimelineAudioMixer 按时间线生成
+        // 预渲染时样本计数归音频线程所有，这里只在本线程混音时读取
+        const bool mixTransitionAudio = m_audioStream && !m_audioPrerenderActive;
         
         ImageDecoder fromDecoder, toDecoder;
+        fromDecoder.setScaleThreads(scaleThreadCount());
+        toDecoder.setScaleThreads(scaleThreadCount());
 
         // --- Determine the correct FROM frame ---
         FFmpegUtils::AvFramePtr finalFromFrame;
@@ -923,17 +1359,16 @@ namespace VideoCreator
 
             EffectProcessor fromSceneProcessor;
             fromSceneProcessor.initialize(m_config.project.width, m_config.project.height, AV_PIX_FMT_YUV420P, m_config.project.fps);
-            if (!fromSceneProcessor.startKenBurnsSequence(fromScene.effects.ken_burns, scaledFromFrame.get(), totalFramesInFromScene)) {
+            // 直接从序列的最后一帧开始，不生成前面的帧
+            if (!fromSceneProcessor.startKenBurnsSequence(fromScene.effects.ken_burns, scaledFromFrame.get(), totalFramesInFromScene, totalFramesInFromScene - 1)) {
                 m_errorString = "处理 'from' 场景的 Ken Burns 特效失败: " + fromSceneProcessor.getErrorString();
                 return false;
             }
 
             FFmpegUtils::AvFramePtr lastKbFrame;
-            for (int frameIndex = 0; frameIndex < totalFramesInFromScene; ++frameIndex) {
-                if (!fromSceneProcessor.fetchKenBurnsFrame(lastKbFrame)) {
-                    m_errorString = "'from' 场景 Ken Burns 特效处理后未能获取最后一帧: " + fromSceneProcessor.getErrorString();
-                    return false;
-                }
+            if (!fromSceneProcessor.fetchKenBurnsFrame(lastKbFrame)) {
+                m_errorString = "'from' 场景 Ken Burns 特效处理后未能获取最后一帧: " + fromSceneProcessor.getErrorString();
+                return false;
             }
             if (!lastKbFrame) {
                 m_errorString = "'from' 场景 Ken Burns 特效未生成任何帧";
@@ -1062,60 +1497,25 @@ namespace VideoCreator
                 m_errorString = "应用转场特效失败: " + transitionProcessor.getErrorString();
                 return false;
             }
-            blendedFrame->pts = m_frameCount;
-            int ret = avcodec_send_frame(m_videoCodecContext.get(), blendedFrame.get());
-            if (ret < 0) {
-                m_errorString = format_ffmpeg_error(ret, "发送转场帧到编码器失败");
-                return false;
-            }
-            auto packet = FFmpegUtils::createAvPacket();
-            while ((ret = avcodec_receive_packet(m_videoCodecContext.get(), packet.get())) >= 0) {
-                packet->stream_index = m_videoStream->index;
-                av_packet_rescale_ts(packet.get(), m_videoCodecContext->time_base, m_videoStream->time_base);
-                ret = av_interleaved_write_frame(m_outputContext.get(), packet.get());
-                if (ret < 0) {
-                    m_errorString = format_ffmpeg_error(ret, "写入转场视频包失败");
-                    return false;
-                }
-                av_packet_unref(packet.get());
-            }
-            if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
-                m_errorString = format_ffmpeg_error(ret, "从编码器接收转场包失败");
+            if (!encodeAndWriteVideoFrame(blendedFrame.get())) {
+                m_errorString = "编码转场帧失败: " + m_errorString;
                 return false;
             }
 
-            if (m_audioStream) {
-                double video_time_in_scene = (double)(frameIndex + 1) / m_config.project.fps;
-                double audio_time_in_scene = (double)(m_audioSamplesCount - startAudioSampleCount) / m_audioCodecContext->sample_rate;
-                while(audio_time_in_scene < video_time_in_scene) {
-                    const int frame_size = m_audioCodecContext->frame_size;
+            if (mixTransitionAudio) {
+                double video_time = (double)(m_frameCount + 1) / m_config.project.fps;
+                double audio_time = (double)m_audioSamplesCount / m_audioCodecContext->sample_rate;
+                while(audio_time < video_time) {
+                    const int frame_size = m_audioFrameSize;
                     if (frame_size <= 0) break;
-                    
-                    auto audioFrame = FFmpegUtils::createAvFrame();
-                    audioFrame->nb_samples = frame_size;
-                    audioFrame->ch_layout = m_audioCodecContext->ch_layout;
-                    audioFrame->format = m_audioCodecContext->sample_fmt;
-                    audioFrame->sample_rate = m_audioCodecContext->sample_rate;
-
-                    int ret = av_frame_get_buffer(audioFrame.get(), 0);
-                    if (ret < 0) {
-                         m_errorString = format_ffmpeg_error(ret, "为静音帧分配缓冲区失败 (Transition)");
-                         return false;
-                    }
-                    ret = av_frame_make_writable(audioFrame.get());
-                     if (ret < 0) {
-                        m_errorString = format_ffmpeg_error(ret, "使静音帧可写失败 (Transition)");
-                        return false;
-                    }
-                    av_samples_set_silence(audioFrame->data, 0, audioFrame->nb_samples, audioFrame->ch_layout.nb_channels, (AVSampleFormat)audioFrame->format);
 
-                    if(av_audio_fifo_write(m_audioFifo, (void**)audioFrame->data, audioFrame->nb_samples) < audioFrame->nb_samples){
-                        m_errorString = "写入静音数据到FIFO失败 (Transition)";
+                    if (!mixTimelineAudio(frame_size)) {
+                        m_errorString = "写入转场音频失败: " + m_audioErrorString;
                         return false;
                     }
 
-                    if (!sendBufferedAudioFrames()) return false;
-                     audio_time_in_scene = (double)(m_audioSamplesCount - startAudioSampleCount) / m_audioCodecContext->sample_rate;
+                    if (!sendBufferedAudioFrames()) return propagateAudioError();
+                    audio_time = (double)m_audioSamplesCount / m_audioCodecContext->sample_rate;
                 }
             }
             m_frameCount++;
@@ -1124,164 +1524,6 @@ namespace VideoCreator
         return true;
     }
 
-    bool RenderEngine::renderAudioTransition(const SceneConfig &fromScene, const SceneConfig &toScene, double duration_seconds)
-    {
-        if (!m_audioStream || !m_audioCodecContext || duration_seconds <= 0.0) return true;
-
-        const int sample_rate = m_audioCodecContext->sample_rate > 0 ? m_audioCodecContext->sample_rate : 44100;
-        int frame_size = m_audioCodecContext->frame_size;
-        if (frame_size <= 0) frame_size = 1024; // 合理的默认值
-
-        const int total_samples = static_cast<int>(std::ceil(duration_seconds * sample_rate));
-        const double vol_from = fromScene.resources.audio.volume <= 0 ? 0.0 : fromScene.resources.audio.volume;
-        const double vol_to = toScene.resources.audio.volume <= 0 ? 0.0 : toScene.resources.audio.volume;
-
-        AudioDecoder fromDecoder;
-        AudioDecoder toDecoder;
-        bool fromAvailable = !fromScene.resources.audio.path.empty() && fromDecoder.open(fromScene.resources.audio.path);
-        bool toAvailable = !toScene.resources.audio.path.empty() && toDecoder.open(toScene.resources.audio.path);
-
-        if (fromAvailable) {
-            if (!fromDecoder.applyVolumeEffect(fromScene)) {
-                qDebug() << "起始场景音量特效应用失败，继续使用原始音频。原因: " << fromDecoder.getErrorString().c_str();
-            }
-        }
-        if (toAvailable) {
-            if (!toDecoder.applyVolumeEffect(toScene)) {
-                qDebug() << "目标场景音量特效应用失败，继续使用原始音频。原因: " << toDecoder.getErrorString().c_str();
-            }
-        }
-
-        // 如果没有可用音频源，则保持旧逻辑由后续循环填充静音
-        if (!fromAvailable && !toAvailable) {
-            return true;
-        }
-
-        if (fromAvailable) {
-            double fromDuration = fromDecoder.getDuration();
-            if (fromDuration <= 0) {
-                fromDuration = fromScene.duration;
-            }
-            double start_time = std::max(0.0, fromDuration - duration_seconds);
-            fromDecoder.seek(start_time);
-        }
-
-        struct AudioBuffer {
-            std::vector<float> channels[2];
-            size_t readPos = 0;
-            bool exhausted = false;
-        };
-
-        AudioBuffer fromBuf;
-        AudioBuffer toBuf;
-
-        auto compactBuffer = [](AudioBuffer &buf) {
-            const size_t threshold = 8192;
-            if (buf.readPos > threshold) {
-                for (auto &ch : buf.channels) {
-                    if (buf.readPos <= ch.size()) {
-                        ch.erase(ch.begin(), ch.begin() + static_cast<long long>(buf.readPos));
-                    } else {
-                        ch.clear();
-                    }
-                }
-                buf.readPos = 0;
-            }
-        };
-
-        auto ensureSamples = [this](AudioDecoder &decoder, AudioBuffer &buf, int needed, bool &available) -> bool {
-            while (!buf.exhausted && static_cast<int>(buf.channels[0].size() - buf.readPos) < needed) {
-                FFmpegUtils::AvFramePtr frame;
-                int ret = decoder.decodeFrame(frame);
-                if (ret > 0 && frame) {
-                    const int nb = frame->nb_samples;
-                    int ch = frame->ch_layout.nb_channels > 0 ? frame->ch_layout.nb_channels : 1;
-                    ch = std::min(ch, 2); // 仅处理前两个声道
-                    for (int c = 0; c < ch; ++c) {
-                        float *data = reinterpret_cast<float *>(frame->data[c]);
-                        buf.channels[c].insert(buf.channels[c].end(), data, data + nb);
-                    }
-                    // 单声道时复制到右声道，保证双声道输出
-                    if (ch == 1) {
-                        buf.channels[1].insert(buf.channels[1].end(), buf.channels[0].end() - nb, buf.channels[0].end());
-                    }
-                    // 对齐两个声道长度
-                    const size_t max_len = std::max(buf.channels[0].size(), buf.channels[1].size());
-                    buf.channels[0].resize(max_len, 0.0f);
-                    buf.channels[1].resize(max_len, 0.0f);
-                }
-                else if (ret == 0) {
-                    buf.exhausted = true;
-                    break;
-                }
-                else {
-                    buf.exhausted = true;
-                    available = false;
-                    qDebug() << "音频转场解码失败，使用静音代替。";
-                    break;
-                }
-            }
-            return true;
-        };
-
-        int processed = 0;
-        while (processed < total_samples) {
-            int chunk = std::min(frame_size, total_samples - processed);
-
-            if (fromAvailable) {
-                if (!ensureSamples(fromDecoder, fromBuf, chunk, fromAvailable)) return false;
-            }
-            if (toAvailable) {
-                if (!ensureSamples(toDecoder, toBuf, chunk, toAvailable)) return false;
-            }
-
-            auto mixedFrame = FFmpegUtils::createAvFrame();
-            mixedFrame->nb_samples = chunk;
-            mixedFrame->ch_layout = m_audioCodecContext->ch_layout;
-            mixedFrame->format = m_audioCodecContext->sample_fmt;
-            mixedFrame->sample_rate = sample_rate;
-            int ret = av_frame_get_buffer(mixedFrame.get(), 0);
-            if (ret < 0) {
-                m_errorString = format_ffmpeg_error(ret, "为转场混音帧分配缓冲区失败");
-                return false;
-            }
-
-            const int channels = m_audioCodecContext->ch_layout.nb_channels > 0 ? m_audioCodecContext->ch_layout.nb_channels : 2;
-            for (int c = 0; c < channels; ++c) {
-                float *dst = reinterpret_cast<float *>(mixedFrame->data[c]);
-                for (int i = 0; i < chunk; ++i) {
-                    float s_from = 0.0f;
-                    float s_to = 0.0f;
-                    if (fromAvailable && fromBuf.readPos + i < fromBuf.channels[c % 2].size()) {
-                        s_from = fromBuf.channels[c % 2][fromBuf.readPos + i];
-                    }
-                    if (toAvailable && toBuf.readPos + i < toBuf.channels[c % 2].size()) {
-                        s_to = toBuf.channels[c % 2][toBuf.readPos + i];
-                    }
-                    double t = static_cast<double>(processed + i) / static_cast<double>(total_samples);
-                    double w_from = 1.0 - t;
-                    double w_to = t;
-                    dst[i] = static_cast<float>(s_from * w_from * vol_from + s_to * w_to * vol_to);
-                }
-            }
-
-            fromBuf.readPos += chunk;
-            toBuf.readPos += chunk;
-            compactBuffer(fromBuf);
-            compactBuffer(toBuf);
-
-            if (av_audio_fifo_write(m_audioFifo, (void **)mixedFrame->data, mixedFrame->nb_samples) < mixedFrame->nb_samples) {
-                m_errorString = "写入转场混音数据到FIFO失败";
-                return false;
-            }
-
-            if (!sendBufferedAudioFrames()) return false;
-            processed += chunk;
-        }
-
-        return true;
-    }
-
     FFmpegUtils::AvFramePtr RenderEngine::extractVideoSceneFrame(const SceneConfig &scene, bool fetchLastFrame)
     {
         if (scene.type != SceneType::VIDEO_SCENE) {
@@ -1294,11 +1536,25 @@ namespace VideoCreator
         }
 
         VideoDecoder decoder;
+        decoder.setScaleThreads(scaleThreadCount());
         if (!decoder.open(scene.resources.video.path)) {
             m_errorString = "无法打开视频: " + decoder.getErrorString();
             return nullptr;
         }
 
+        // 取末帧时只解码最后一个 GOP（直接复制的场景没有缓存的末帧，不必为转场解码整段素材）
+        if (fetchLastFrame) {
+            const double videoDuration = decoder.getDuration();
+            if (videoDuration > 1.0 && !decoder.seek(videoDuration - 1.0)) {
+                qDebug() << "Seek to video tail failed, decoding from start:" << decoder.getErrorString().c_str();
+                decoder.close();
+                if (!decoder.open(scene.resources.video.path)) {
+                    m_errorString = "无法打开视频: " + decoder.getErrorString();
+                    return nullptr;
+                }
+            }
+        }
+
         FFmpegUtils::AvFramePtr selectedFrame;
         bool gotFrame = false;
 
@@ -1329,6 +1585,50 @@ namespace VideoCreator
         return selectedFrame;
     }
 
+    FFmpegUtils::AvFramePtr RenderEngine::extractVideoFrameAt(const SceneConfig &scene, double seconds)
+    {
+        VideoDecoder decoder;
+        decoder.setScaleThreads(scaleThreadCount());
+        if (!decoder.open(scene.resources.video.path)) {
+            m_errorString = "无法打开视频: " + decoder.getErrorString();
+            return nullptr;
+        }
+        if (seconds > 0 && !decoder.seek(seconds)) {
+            qDebug() << "Seek for hold frame failed, decoding from start:" << decoder.getErrorString().c_str();
+            decoder.close();
+            if (!decoder.open(scene.resources.video.path)) {
+                m_errorString = "无法打开视频: " + decoder.getErrorString();
+                return nullptr;
+            }
+        }
+
+        // 从目标之前的关键帧按显示顺序解码，保留显示时间不晚于目标（容差半帧）的最后一帧
+        const double limit = seconds + 0.5 / m_config.project.fps;
+        FFmpegUtils::AvFramePtr selectedFrame;
+        while (true) {
+            FFmpegUtils::AvFramePtr decodedFrame;
+            if (decoder.decodeFrame(decodedFrame) <= 0 || !decodedFrame) {
+                break;
+            }
+            double frameTime = 0.0;
+            if (selectedFrame && decoder.frameTime(decodedFrame.get(), frameTime) && frameTime > limit) {
+                break;
+            }
+            selectedFrame = std::move(decodedFrame);
+        }
+        if (!selectedFrame) {
+            m_errorString = "无法解码视频场景帧: " + decoder.getErrorString();
+            return nullptr;
+        }
+
+        auto scaledFrame = decoder.scaleFrame(selectedFrame.get(), m_config.project.width, m_config.project.height, AV_PIX_FMT_YUV420P);
+        if (!scaledFrame) {
+            m_errorString = "缩放视频帧失败: " + decoder.getErrorString();
+            return nullptr;
+        }
+        return scaledFrame;
+    }
+
     void RenderEngine::scheduleVideoPrefetchTasks()
     {
         m_sceneFirstFramePrefetch.clear();
@@ -1341,6 +1641,7 @@ namespace VideoCreator
             if (scene.resources.video.path.empty()) {
                 continue;
             }
+            // 各场景的预取任务彼此并行，缩放保持单线程
             m_sceneFirstFramePrefetch.emplace(scene.id, std::async(std::launch::async, [scene, targetWidth, targetHeight]() {
                 VideoDecoder decoder;
                 if (!decoder.open(scene.resources.video.path)) {
@@ -1388,12 +1689,12 @@ namespace VideoCreator
         if (allocateNew) {
             m_reusableMixFrame = FFmpegUtils::createAvFrame();
             if (!m_reusableMixFrame) {
-                m_errorString = "Failed to allocate reusable audio frame";
+                m_audioErrorString = "Failed to allocate reusable audio frame";
                 m_reusableMixFrameCapacity = 0;
                 return false;
             }
             m_reusableMixFrame->ch_layout = m_audioCodecContext->ch_layout;
-            m_reusableMixFrame->format = m_audioCodecContext->sample_fmt;
+            m_reusableMixFrame->format = AV_SAMPLE_FMT_FLTP;
             m_reusableMixFrame->sample_rate = m_audioCodecContext->sample_rate;
             m_reusableMixFrameCapacity = samplesNeeded;
         }
@@ -1401,7 +1702,7 @@ namespace VideoCreator
         m_reusableMixFrame->nb_samples = samplesNeeded;
         int ret = allocateNew ? av_frame_get_buffer(m_reusableMixFrame.get(), 0) : av_frame_make_writable(m_reusableMixFrame.get());
         if (ret < 0) {
-            m_errorString = format_ffmpeg_error(ret, "Failed to prepare reusable audio frame");
+            m_audioErrorString = format_ffmpeg_error(ret, "Failed to prepare reusable audio frame");
             if (allocateNew) {
                 m_reusableMixFrame.reset();
                 m_reusableMixFrameCapacity = 0;
@@ -1474,10 +1775,181 @@ namespace VideoCreator
         return frame;
     }
     
+    bool RenderEngine::mixTimelineAudio(int samples)
+    {
+        m_mixBufferLeft.resize(static_cast<size_t>(samples));
+        m_mixBufferRight.resize(static_cast<size_t>(samples));
+        const int produced = m_timelineAudio.read(samples, m_mixBufferLeft.data(), m_mixBufferRight.data());
+        if (produced < 0) {
+            m_audioErrorString = m_timelineAudio.errorString();
+            return false;
+        }
+        // 时间线之后（视频取整多出的部分）补静音
+        std::fill(m_mixBufferLeft.begin() + produced, m_mixBufferLeft.end(), 0.0f);
+        std::fill(m_mixBufferRight.begin() + produced, m_mixBufferRight.end(), 0.0f);
+        if (!ensureReusableAudioFrame(samples)) {
+            return false;
+        }
+
+        AVFrame *mixedFrame = m_reusableMixFrame.get();
+        const int outputChannels = m_audioCodecContext->ch_layout.nb_channels > 0 ? m_audioCodecContext->ch_layout.nb_channels : 2;
+        for (int ch = 0; ch < outputChannels && ch < 2; ++ch) {
+            const auto &source = (ch == 0) ? m_mixBufferLeft : m_mixBufferRight;
+            std::copy(source.begin(), source.end(), reinterpret_cast<float *>(mixedFrame->data[ch]));
+        }
+
+        if (av_audio_fifo_write(m_audioFifo, (void **)mixedFrame->data, mixedFrame->nb_samples) < mixedFrame->nb_samples) {
+            m_audioErrorString = "Failed to write mixed audio to FIFO";
+            return false;
+        }
+        return true;
+    }
+
+    bool RenderEngine::startAudioPrerender()
+    {
+        stopAudioPrerender();
+
+        // 队列上限约为 kAudioPrerenderSeconds 秒音频，工作线程领先过多时阻塞，内存占用与工程时长无关
+        const int frameSize = m_audioFrameSize;
+        m_maxQueuedAudioPackets = static_cast<size_t>(std::max(16, RenderBuffers::kAudioPrerenderSeconds * m_audioCodecContext->sample_rate / frameSize));
+        m_audioPackets.clear();
+        m_audioPrerenderFinished = false;
+        m_audioPrerenderFailed = false;
+        m_audioPrerenderError.clear();
+        m_audioPrerenderStop.store(false);
+        m_audioPrerenderActive = true;
+
+        m_audioPrerenderThread = std::thread([this]() {
+            const bool ok = renderAudioTimeline();
+            {
+                std::lock_guard<std::mutex> lock(m_audioPacketMutex);
+                if (!ok) {
+                    m_audioPrerenderFailed = true;
+                    m_audioPrerenderError = m_audioErrorString.empty() ? std::string("Audio pre-render failed") : m_audioErrorString;
+                }
+                m_audioPrerenderFinished = true;
+            }
+            m_audioPacketCv.notify_all();
+        });
+        return true;
+    }
+
+    void RenderEngine::stopAudioPrerender()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_audioPacketMutex);
+            m_audioPrerenderStop.store(true);
+        }
+        m_audioPacketCv.notify_all();
+        if (m_audioPrerenderThread.joinable()) {
+            m_audioPrerenderThread.join();
+        }
+        m_audioPackets.clear();
+        m_audioPrerenderActive = false;
+    }
+
+    bool RenderEngine::renderAudioTimeline()
+    {
+        const int frameSize = m_audioFrameSize;
+        const int64_t totalSamples = m_timelineAudio.totalSamples();
+        while (m_timelineAudio.position() < totalSamples) {
+            if (m_audioPrerenderStop.load()) {
+                m_audioErrorString = "Audio pre-render cancelled";
+                return false;
+            }
+            const int chunk = static_cast<int>(std::min<int64_t>(frameSize, totalSamples - m_timelineAudio.position()));
+            if (!mixTimelineAudio(chunk) || !sendBufferedAudioFrames()) {
+                return false;
+            }
+            if (m_audioOnly && totalSamples > 0) {
+                // 纯音频导出时没有视频帧驱动进度，按已混音的样本数计
+                publishProgress(static_cast<int>(m_timelineAudio.position() * 100 / totalSamples));
+            }
+        }
+
+        if (!flushAudio()) {
+            return false;
+        }
+        return flushEncoder(m_audioCodecContext.get(), m_audioStream);
+    }
+
+    bool RenderEngine::writeAudioPacket(AVPacket *packet)
+    {
+        if (!m_audioPrerenderActive) {
+            if (!m_renditions.empty() && !writeRenditionAudio(packet)) {
+                m_audioErrorString = m_errorString;
+                return false;
+            }
+            int ret = av_interleaved_write_frame(m_outputContext.get(), packet);
+            if (ret < 0) {
+                m_audioErrorString = format_ffmpeg_error(ret, "写入音频包失败");
+                return false;
+            }
+            return true;
+        }
+
+        auto queued = FFmpegUtils::createAvPacket();
+        if (!queued) {
+            m_audioErrorString = "Failed to allocate audio packet";
+            return false;
+        }
+        av_packet_move_ref(queued.get(), packet);
+        std::unique_lock<std::mutex> lock(m_audioPacketMutex);
+        m_audioPacketCv.wait(lock, [&]() {
+            return m_audioPrerenderStop.load() || m_audioPackets.size() < m_maxQueuedAudioPackets;
+        });
+        if (m_audioPrerenderStop.load()) {
+            m_audioErrorString = "Audio pre-render cancelled";
+            return false;
+        }
+        m_audioPackets.push_back(std::move(queued));
+        lock.unlock();
+        m_audioPacketCv.notify_all();
+        return true;
+    }
+
+    bool RenderEngine::writePrerenderedAudio(int64_t videoFrameLimit)
+    {
+        const AVRational videoTimeBase = {1, m_config.project.fps};
+        while (true) {
+            FFmpegUtils::AvPacketPtr packet;
+            {
+                // 音频尚未渲染到该位置时等待工作线程（音频通常远快于视频，极少发生）
+                std::unique_lock<std::mutex> lock(m_audioPacketMutex);
+                m_audioPacketCv.wait(lock, [&]() {
+                    return m_audioPrerenderFinished || !m_audioPackets.empty();
+                });
+                if (m_audioPrerenderFailed) {
+                    m_errorString = m_audioPrerenderError;
+                    return false;
+                }
+                if (m_audioPackets.empty()) {
+                    return true;
+                }
+                const AVPacket *front = m_audioPackets.front().get();
+                if (videoFrameLimit >= 0 && av_compare_ts(front->pts, m_audioStream->time_base, videoFrameLimit, videoTimeBase) >= 0) {
+                    return true;
+                }
+                packet = std::move(m_audioPackets.front());
+                m_audioPackets.pop_front();
+            }
+            m_audioPacketCv.notify_all();
+
+            if (!m_renditions.empty() && !writeRenditionAudio(packet.get())) {
+                return false;
+            }
+            int ret = av_interleaved_write_frame(m_outputContext.get(), packet.get());
+            if (ret < 0) {
+                m_errorString = format_ffmpeg_error(ret, "写入预渲染音频包失败");
+                return false;
+            }
+        }
+    }
+
     bool RenderEngine::sendBufferedAudioFrames()
     {
         if (!m_audioFifo || !m_audioCodecContext) return true; // Return true if no audio configured
-        const int frame_size = m_audioCodecContext->frame_size;
+        const int frame_size = m_audioFrameSize;
         if (frame_size <= 0) return true;
 
         while (av_audio_fifo_size(m_audioFifo) >= frame_size)
@@ -1485,37 +1957,54 @@ namespace VideoCreator
             auto frame = FFmpegUtils::createAvFrame();
             frame->nb_samples = frame_size;
             frame->ch_layout = m_audioCodecContext->ch_layout;
-            frame->format = m_audioCodecContext->sample_fmt;
+            frame->format = AV_SAMPLE_FMT_FLTP;
             frame->sample_rate = m_audioCodecContext->sample_rate;
             int ret = av_frame_get_buffer(frame.get(), 0);
             if (ret < 0) {
-                m_errorString = format_ffmpeg_error(ret, "为音频帧分配缓冲区失败 (FIFO)");
+                m_audioErrorString = format_ffmpeg_error(ret, "为音频帧分配缓冲区失败 (FIFO)");
                 return false;
             }
             if (av_audio_fifo_read(m_audioFifo, (void**)frame->data, frame_size) < 0) {
-                m_errorString = "从FIFO读取音频数据失败";
+                m_audioErrorString = "从FIFO读取音频数据失败";
                 return false;
             }
+            if (m_encoderSampleConverter) {
+                // 编码器不接受 FLTP（如 WAV 的 pcm_s16le）：采样率与声道不变，只转换样本格式
+                auto converted = FFmpegUtils::createAvFrame();
+                converted->nb_samples = frame_size;
+                converted->ch_layout = m_audioCodecContext->ch_layout;
+                converted->format = m_audioCodecContext->sample_fmt;
+                converted->sample_rate = m_audioCodecContext->sample_rate;
+                ret = av_frame_get_buffer(converted.get(), 0);
+                if (ret < 0) {
+                    m_audioErrorString = format_ffmpeg_error(ret, "Failed to allocate converted audio frame");
+                    return false;
+                }
+                ret = swr_convert(m_encoderSampleConverter, converted->data, frame_size, (const uint8_t **)frame->data, frame_size);
+                if (ret < 0) {
+                    m_audioErrorString = format_ffmpeg_error(ret, "Failed to convert audio sample format");
+                    return false;
+                }
+                converted->nb_samples = ret;
+                frame = std::move(converted);
+            }
             frame->pts = m_audioSamplesCount;
             m_audioSamplesCount += frame->nb_samples;
             ret = avcodec_send_frame(m_audioCodecContext.get(), frame.get());
             if (ret < 0) {
-                m_errorString = format_ffmpeg_error(ret, "发送音频帧到编码器失败 (FIFO)");
+                m_audioErrorString = format_ffmpeg_error(ret, "发送音频帧到编码器失败 (FIFO)");
                 return false;
             }
             auto packet = FFmpegUtils::createAvPacket();
             while ((ret = avcodec_receive_packet(m_audioCodecContext.get(), packet.get())) == 0) {
                 packet->stream_index = m_audioStream->index;
                 av_packet_rescale_ts(packet.get(), m_audioCodecContext->time_base, m_audioStream->time_base);
-                ret = av_interleaved_write_frame(m_outputContext.get(), packet.get());
-                if (ret < 0) {
-                    m_errorString = format_ffmpeg_error(ret, "写入音频包失败 (FIFO)");
+                if (!writeAudioPacket(packet.get())) {
                     return false;
                 }
-                av_packet_unref(packet.get());
             }
              if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF) {
-                m_errorString = format_ffmpeg_error(ret, "从编码器接收音频包失败 (FIFO)");
+                m_audioErrorString = format_ffmpeg_error(ret, "从编码器接收音频包失败 (FIFO)");
                 return false;
             }
         }
@@ -1525,7 +2014,7 @@ namespace VideoCreator
     bool RenderEngine::flushAudio()
     {
         if (!m_audioFifo || !m_audioCodecContext) return true;
-        const int frame_size = m_audioCodecContext->frame_size;
+        const int frame_size = m_audioFrameSize;
         if (frame_size <= 0) return true;
         const int remaining_samples = av_audio_fifo_size(m_audioFifo);
         if (remaining_samples > 0) {
@@ -1533,16 +2022,16 @@ namespace VideoCreator
             auto silenceFrame = FFmpegUtils::createAvFrame();
             silenceFrame->nb_samples = silence_to_add;
             silenceFrame->ch_layout = m_audioCodecContext->ch_layout;
-            silenceFrame->format = m_audioCodecContext->sample_fmt;
+            silenceFrame->format = AV_SAMPLE_FMT_FLTP;
             silenceFrame->sample_rate = m_audioCodecContext->sample_rate;
             int ret = av_frame_get_buffer(silenceFrame.get(), 0);
             if (ret < 0) {
-                m_errorString = format_ffmpeg_error(ret, "为静音帧分配缓冲区失败 (Flush)");
+                m_audioErrorString = format_ffmpeg_error(ret, "为静音帧分配缓冲区失败 (Flush)");
                 return false;
             }
             ret = av_frame_make_writable(silenceFrame.get());
             if(ret < 0) {
-                 m_errorString = format_ffmpeg_error(ret, "使静音帧可写失败 (Flush)");
+                 m_audioErrorString = format_ffmpeg_error(ret, "使静音帧可写失败 (Flush)");
                  return false;
             }
             av_samples_set_silence(silenceFrame->data, 0, silence_to_add, silenceFrame->ch_layout.nb_channels, (AVSampleFormat)silenceFrame->format);
@@ -1556,9 +2045,11 @@ namespace VideoCreator
     bool RenderEngine::flushEncoder(AVCodecContext *codecCtx, AVStream *stream)
     {
         if (!codecCtx || !stream) return true;
+        // 音频编码器可能在预渲染线程上冲洗，错误写入音频路径自己的错误信息
+        std::string &errorString = stream == m_audioStream ? m_audioErrorString : m_errorString;
         int ret = avcodec_send_frame(codecCtx, nullptr);
         if (ret < 0 && ret != AVERROR_EOF) {
-            m_errorString = format_ffmpeg_error(ret, "发送空帧到编码器以 flush 失败");
+            errorString = format_ffmpeg_error(ret, "发送空帧到编码器以 flush 失败");
             return false;
         }
         auto packet = FFmpegUtils::createAvPacket();
@@ -1567,11 +2058,23 @@ namespace VideoCreator
             ret = avcodec_receive_packet(codecCtx, packet.get());
             if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) break;
             if (ret < 0) {
-                m_errorString = format_ffmpeg_error(ret, "从编码器接收包失败 (flush)");
+                errorString = format_ffmpeg_error(ret, "从编码器接收包失败 (flush)");
                 return false;
             }
             packet->stream_index = stream->index;
             av_packet_rescale_ts(packet.get(), codecCtx->time_base, stream->time_base);
+            if (stream == m_audioStream) {
+                if (!writeAudioPacket(packet.get())) {
+                    return false;
+                }
+                continue;
+            }
+            if (stream == m_videoStream) {
+                if (!writeVideoPacket(packet.get())) {
+                    return false;
+                }
+                continue;
+            }
             ret = av_interleaved_write_frame(m_outputContext.get(), packet.get());
             if (ret < 0) {
                 m_errorString = format_ffmpeg_error(ret, "写入包失败 (flush)");
@@ -1585,9 +2088,23 @@ namespace VideoCreator
     void RenderEngine::updateAndReportProgress()
     {
         if (m_totalProjectFrames > 0) {
-            m_progress = static_cast<int>((m_frameCount / m_totalProjectFrames) * 100);
-            if (m_progress > m_lastReportedProgress) {
-                m_lastReportedProgress = m_progress;
+            publishProgress(static_cast<int>((m_frameCount / m_totalProjectFrames) * 100));
+        }
+    }
+
+    bool RenderEngine::propagateAudioError()
+    {
+        m_errorString = m_audioErrorString.empty() ? std::string("Audio processing failed") : m_audioErrorString;
+        return false;
+    }
+
+    void RenderEngine::publishProgress(int progress)
+    {
+        m_progress = progress;
+        if (m_progress > m_lastReportedProgress) {
+            m_lastReportedProgress = m_progress;
+            if (m_progressCallback) {
+                m_progressCallback(m_progress);
             }
         }
     }
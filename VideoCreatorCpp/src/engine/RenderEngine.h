@@ -6,21 +6,44 @@
 #include <vector>
 #include <unordered_map>
 #include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include <functional>
 #include "model/ProjectConfig.h"
+#include "engine/OutputSink.h"
+#include "engine/ProjectTimeline.h"
+#include "engine/TimelineAudioMixer.h"
 #include "ffmpeg_utils/FFmpegHeaders.h"
 #include "ffmpeg_utils/AvFrameWrapper.h"
+#include "ffmpeg_utils/AvPacketWrapper.h"
 #include "ffmpeg_utils/AvFormatContextWrapper.h"
 #include "ffmpeg_utils/AvCodecContextWrapper.h"
 
 namespace VideoCreator
 {
 
+    struct RenditionOutput;
+    class VideoStreamCopier;
+
     class RenderEngine
     {
     public:
         RenderEngine();
         ~RenderEngine();
 
+        // 设置自定义输出目标（需在 initialize 之前调用），设置后忽略 output_path
+        void setOutputSink(OutputSink sink) { m_outputSink = std::move(sink); }
+
+        // 关闭音频输出（需在 initialize 之前调用）：只渲染画面，不创建音频流也不混音
+        // 分块渲染的工作进程使用，整条音轨由单独的纯音频任务渲染一次
+        void setAudioEnabled(bool enabled) { m_audioEnabled = enabled; }
+
+        // 进度回调（需在 render 之前调用），进度百分比增加时在渲染线程上调用
+        void setProgressCallback(std::function<void(int)> callback) { m_progressCallback = std::move(callback); }
+
         // 初始化渲染引擎
         bool initialize(const ProjectConfig &config);
 
@@ -39,12 +62,60 @@ namespace VideoCreator
         std::string m_errorString;
         double m_totalProjectFrames;
         int m_lastReportedProgress;
+        std::function<void(int)> m_progressCallback;
+
+        // 纯音频导出（output.mode 为 m4a / mp3 / wav）：只按时间线混音并编码音频
+        bool renderAudioOnly();
 
         // 创建输出上下文
         bool createOutputContext();
 
+        // 为 OutputSink 创建自定义 AVIOContext
+        bool createSinkIOContext();
+        void releaseSinkIOContext();
+
+        // 生成写文件头时使用的封装器选项（分片 MP4 等）
+        AVDictionary *buildMuxerOptions() const;
+
+        // 编码一帧视频并写入输出，按需强制关键帧（分段/场景对齐）
+        bool encodeAndWriteVideoFrame(AVFrame *frame);
+        // 写出一个视频包（编码器输出或直接复制的素材包），保证 DTS 单调递增
+        bool writeVideoPacket(AVPacket *packet);
+
+        // 智能渲染（performance.smart_render）：场景是否可以尝试直接复制素材的压缩包
+        bool canStreamCopyScene(const SceneConfig &scene) const;
+        // 复制下一个显示时间落在场景内的素材包并重定位到输出时间线，copiedEndFrame 更新为已复制帧的最大帧号加一；
+        // 返回 1 成功，0 素材结束或读到场景终点之后的包，-1 失败
+        int copyVideoPacket(VideoStreamCopier &copier, int sceneStartFrame, int sceneEndFrame, int &copiedEndFrame);
+
+        // 从时间线混音器读取 samples 个样本写入 FIFO，时间线结束后补静音
+        bool mixTimelineAudio(int samples);
+
+        // 音频预渲染：工作线程按 m_timeline 混音并编码整条音频，包进入内存队列
+        bool startAudioPrerender();
+        void stopAudioPrerender();
+        // 把时间线剩余的音频混音、编码并冲洗编码器（预渲染线程、纯音频导出与视频写完后的收尾共用）
+        bool renderAudioTimeline();
+        // 写出一个音频包；预渲染时放入队列（队列满时阻塞），否则直接交错写入
+        bool writeAudioPacket(AVPacket *packet);
+        // 视频线程写出时间戳早于 videoFrameLimit 帧的预编码音频包，负数表示全部写出
+        bool writePrerenderedAudio(int64_t videoFrameLimit);
+
+        // 缩放条带线程数（performance.scale_threads，0 时按硬件线程数在编码器之外的预算内选择）
+        int scaleThreadCount() const;
+
         // 创建视频流
         bool createVideoStream();
+        // 创建并打开视频编码器；直接复制的场景之后重新打开，使编码输出从新的 IDR 开始
+        bool openVideoEncoder();
+        // 按 video_encoding 配置创建并打开一个视频编码器；bitrate 非空时按码率编码，crf 为负时不设置 crf
+        FFmpegUtils::AvCodecContextPtr createVideoEncoder(int width, int height, const std::string &bitrate, int crf);
+
+        // 额外输出档位（output.renditions）：每个合成帧缩放后分别编码，音频包与主输出共享
+        bool createRenditionOutputs();
+        bool encodeRenditionFrames(const AVFrame *frame);
+        bool writeRenditionAudio(const AVPacket *packet);
+        bool finishRenditionOutputs();
 
         // 创建音频流
         bool createAudioStream();
@@ -55,11 +126,10 @@ namespace VideoCreator
         // 渲染转场
         bool renderTransition(const SceneConfig &transitionScene, const SceneConfig &fromScene, const SceneConfig &toScene);
 
-        // 为转场生成音频淡入淡出 / 交叉混音
-        bool renderAudioTransition(const SceneConfig &fromScene, const SceneConfig &toScene, double duration_seconds);
-
         // 从视频场景提取指定帧（首帧或末帧）并缩放到项目分辨率
         FFmpegUtils::AvFramePtr extractVideoSceneFrame(const SceneConfig &scene, bool fetchLastFrame);
+        // 从视频场景解码显示时间不晚于 seconds 的最后一帧并缩放到项目分辨率（直接复制的场景补帧使用）
+        FFmpegUtils::AvFramePtr extractVideoFrameAt(const SceneConfig &scene, double seconds);
         void cacheSceneFirstFrame(const SceneConfig &scene, const AVFrame *frame);
         void cacheSceneLastFrame(const SceneConfig &scene, const AVFrame *frame);
         FFmpegUtils::AvFramePtr getCachedSceneFrame(const SceneConfig &scene, bool lastFrame);
@@ -79,6 +149,10 @@ namespace VideoCreator
 
         // 更新并报告进度
         void updateAndReportProgress();
+        // 记录进度，超过已报告的值时调用进度回调
+        void publishProgress(int progress);
+        // 在本线程调用音频路径失败时，把 m_audioErrorString 转为 m_errorString 并返回 false
+        bool propagateAudioError();
 
         // flush 编码器剩余包
         bool flushEncoder(AVCodecContext *codecCtx, AVStream *stream);
@@ -87,18 +161,52 @@ namespace VideoCreator
         FFmpegUtils::AvFormatContextPtr m_outputContext;
         FFmpegUtils::AvCodecContextPtr m_videoCodecContext;
         FFmpegUtils::AvCodecContextPtr m_audioCodecContext;
+        OutputSink m_outputSink;
+        AVIOContext *m_sinkIOContext;
+        bool m_fragmentedOutput;
+        bool m_segmentedOutput;        // hls / dash
+        bool m_forceKeyframePending;   // 下一帧强制为关键帧（场景起点）
+        bool m_videoEncoderDrained;    // 编码器已为直接复制的场景冲洗，下一帧编码前需重新打开
+        bool m_inBandParameterSets;    // 视频轨使用 avc3/hev1 样本描述，参数集可随码流在 IDR 处切换
+        bool m_videoSegmentStart;      // 下一个视频包开始新的一段（编码器重新打开或复制场景）
+        int64_t m_videoDtsShift;       // 当前段 DTS 的平移量（输出流时间基，<= 0）
+        int64_t m_lastVideoDts;        // 最近写出的视频包 DTS（输出流时间基）
+        int64_t m_nextSegmentKeyframe; // 下一个按分段间隔强制关键帧的帧号
+        int64_t m_segmentIntervalFrames;
         AVStream *m_videoStream;
         AVStream *m_audioStream;
-        AVAudioFifo *m_audioFifo;
+        AVAudioFifo *m_audioFifo;      // 混音结果（固定为 FLTP）
+        bool m_audioOnly;              // 纯音频导出，不创建视频流
+        bool m_audioEnabled;           // false 时只输出视频流
+        int m_audioFrameSize;          // 每次送入音频编码器的样本数（可变帧长编码器为 1024）
+        SwrContext *m_encoderSampleConverter; // 编码器不支持 FLTP 时的样本格式转换
         int m_frameCount;
+        // 音频路径（混音、FIFO、音频编码）的状态只由一个线程访问：预渲染时为工作线程，否则为渲染线程
+        // 工作线程的错误只经 m_audioPacketMutex 以 m_audioPrerenderError 交给渲染线程
         int64_t m_audioSamplesCount;
-
-        // 是否启用音频转场效果（默认关闭，保留实现以便未来开启）
-        bool m_enableAudioTransition;
+        std::string m_audioErrorString;
+
+        // 场景音频、交叉淡化转场与工程音轨的混音（与预览播放同一实现）
+        TimelineAudioMixer m_timelineAudio;
+
+        // 音频预渲染（performance.audio_prerender）
+        bool m_audioPrerenderActive;
+        size_t m_currentSceneIndex;
+        ProjectTimeline m_timeline;
+        std::thread m_audioPrerenderThread;
+        std::mutex m_audioPacketMutex;
+        std::condition_variable m_audioPacketCv;
+        std::deque<FFmpegUtils::AvPacketPtr> m_audioPackets;
+        size_t m_maxQueuedAudioPackets;
+        bool m_audioPrerenderFinished;
+        bool m_audioPrerenderFailed;
+        std::atomic<bool> m_audioPrerenderStop{false};
+        std::string m_audioPrerenderError;
         std::unordered_map<int, FFmpegUtils::AvFramePtr> m_sceneFirstFrames;
         std::unordered_map<int, FFmpegUtils::AvFramePtr> m_sceneLastFrames;
         std::vector<float> m_mixBufferLeft;
         std::vector<float> m_mixBufferRight;
+        std::vector<std::unique_ptr<RenditionOutput>> m_renditions;
         FFmpegUtils::AvFramePtr m_reusableMixFrame;
         int m_reusableMixFrameCapacity;
         std::unordered_map<int, std::future<FFmpegUtils::AvFramePtr>> m_sceneFirstFramePrefetch;
@@ -0,0 +1,569 @@
+#include "RenderFarm.h"
+#include "RenderEngine.h"
+#include "AdmissionController.h"
+#include "MemoryEstimate.h"
+#include "model/ConfigLoader.h"
+#include "ffmpeg_utils/AvFormatContextWrapper.h"
+#include "ffmpeg_utils/AvPacketWrapper.h"
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+namespace VideoCreator
+{
+
+    namespace
+    {
+        // 输入上下文需要 avformat_close_input，不能使用输出上下文的 AvFormatContextDeleter
+        struct InputContextDeleter
+        {
+            void operator()(AVFormatContext *context) const
+            {
+                avformat_close_input(&context);
+            }
+        };
+        using InputContextPtr = std::unique_ptr<AVFormatContext, InputContextDeleter>;
+
+        InputContextPtr openInput(const std::string &path, AVMediaType type, int *streamIndex, std::string *error)
+        {
+            AVFormatContext *context = nullptr;
+            if (avformat_open_input(&context, path.c_str(), nullptr, nullptr) < 0) {
+                *error = "Cannot open " + path;
+                return nullptr;
+            }
+            InputContextPtr input(context);
+            if (avformat_find_stream_info(context, nullptr) < 0) {
+                *error = "Cannot read stream info: " + path;
+                return nullptr;
+            }
+            *streamIndex = av_find_best_stream(context, type, -1, -1, nullptr, 0);
+            if (*streamIndex < 0) {
+                *error = std::string("No ") + (type == AVMEDIA_TYPE_VIDEO ? "video" : "audio") + " stream in " + path;
+                return nullptr;
+            }
+            return input;
+        }
+
+        bool sameVideoParameters(const AVCodecParameters *a, const AVCodecParameters *b)
+        {
+            return a->codec_id == b->codec_id && a->width == b->width && a->height == b->height &&
+                   a->format == b->format && a->extradata_size == b->extradata_size &&
+                   (a->extradata_size == 0 || std::memcmp(a->extradata, b->extradata, a->extradata_size) == 0);
+        }
+
+        // 工作进程渲染的子工程：分块只含 [beginScene, endScene) 的画面；音轨任务为整条时间线的 m4a
+        ProjectConfig videoChunkConfig(const ProjectConfig &config, size_t beginScene, size_t endScene, const std::string &outputPath)
+        {
+            ProjectConfig chunk = config;
+            chunk.scenes.assign(config.scenes.begin() + beginScene, config.scenes.begin() + endScene);
+            chunk.project.output_path = outputPath;
+            chunk.output.mode = "mp4";
+            chunk.output.renditions.clear();
+            chunk.audio_tracks.clear();
+            // 直接复制的素材带着自己的参数集，合并时各分块的编码参数必须一致
+            chunk.performance.smart_render = false;
+            return chunk;
+        }
+
+        ProjectConfig audioTrackConfig(const ProjectConfig &config, const std::string &outputPath)
+        {
+            ProjectConfig audio = config;
+            audio.project.output_path = outputPath;
+            audio.output.mode = "m4a";
+            audio.output.renditions.clear();
+            return audio;
+        }
+
+        // 断点续渲清单（工作目录下的 manifest.json）：任务 0 为音轨，其余依次为视频分块
+        constexpr int kManifestVersion = 1;
+
+        // 工程指纹：工程文件内容加上分块计划，任何一项变化都使已完成的分块失效
+        QString projectFingerprint(const QString &projectPath, const std::vector<RenderChunk> &chunks)
+        {
+            QFile file(projectPath);
+            if (!file.open(QIODevice::ReadOnly)) {
+                return QString();
+            }
+            QCryptographicHash hash(QCryptographicHash::Sha1);
+            hash.addData(file.readAll());
+            for (const auto &chunk : chunks) {
+                hash.addData(QByteArray::fromStdString(std::to_string(chunk.beginScene) + "-" + std::to_string(chunk.endScene) + ";"));
+            }
+            return QString::fromUtf8(hash.result().toHex());
+        }
+
+        // 读取清单中已完成的任务；清单缺失、版本或指纹不符时全部视为未完成
+        std::vector<bool> loadManifest(const QString &path, const QString &fingerprint, size_t jobCount)
+        {
+            std::vector<bool> done(jobCount, false);
+            QFile file(path);
+            if (fingerprint.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+                return done;
+            }
+            const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+            const QJsonObject root = doc.object();
+            if (!doc.isObject() || root.value("version").toInt() != kManifestVersion ||
+                root.value("fingerprint").toString() != fingerprint) {
+                qDebug() << "Render farm: manifest does not match the project, rendering from scratch";
+                return done;
+            }
+            const QJsonArray jobs = root.value("jobs").toArray();
+            for (int i = 0; i < jobs.size() && static_cast<size_t>(i) < jobCount; ++i) {
+                const QJsonObject job = jobs.at(i).toObject();
+                // 标记完成但文件已丢失的任务重新渲染
+                done[static_cast<size_t>(i)] = job.value("done").toBool() && QFileInfo(job.value("file").toString()).size() > 0;
+            }
+            return done;
+        }
+
+        // 原子替换清单，协调者在写入中途被终止也不会留下损坏的清单
+        bool writeManifest(const QString &path, const QString &fingerprint, const std::vector<QString> &files,
+                           const std::vector<bool> &done)
+        {
+            QJsonArray jobs;
+            for (size_t i = 0; i < files.size(); ++i) {
+                QJsonObject job;
+                job.insert("file", files[i]);
+                job.insert("done", static_cast<bool>(done[i]));
+                jobs.append(job);
+            }
+            QJsonObject root;
+            root.insert("version", kManifestVersion);
+            root.insert("fingerprint", fingerprint);
+            root.insert("jobs", jobs);
+
+            QSaveFile file(path);
+            if (!file.open(QIODevice::WriteOnly)) {
+                return false;
+            }
+            file.write(QJsonDocument(root).toJson());
+            return file.commit();
+        }
+    } // namespace
+
+    std::vector<RenderChunk> RenderFarm::planChunks(const ProjectConfig &config, int maxChunks)
+    {
+        std::vector<RenderChunk> chunks;
+        const size_t sceneCount = config.scenes.size();
+        if (sceneCount == 0 || maxChunks <= 0) {
+            return chunks;
+        }
+
+        double totalDuration = 0.0;
+        for (const auto &scene : config.scenes) {
+            totalDuration += std::max(0.0, scene.duration);
+        }
+        const double targetDuration = totalDuration / maxChunks;
+
+        RenderChunk current;
+        for (size_t i = 0; i < sceneCount; ++i) {
+            current.duration += std::max(0.0, config.scenes[i].duration);
+            const bool last = i + 1 == sceneCount;
+            // 只在两个普通场景之间切分：转场要取前一场景的末帧和后一场景的首帧
+            const bool canSplitAfter = !last && config.scenes[i].type != SceneType::TRANSITION &&
+                                       config.scenes[i + 1].type != SceneType::TRANSITION;
+            if (last || (canSplitAfter && current.duration >= targetDuration && static_cast<int>(chunks.size()) + 1 < maxChunks)) {
+                current.endScene = i + 1;
+                chunks.push_back(current);
+                current = RenderChunk{};
+                current.beginScene = i + 1;
+            }
+        }
+        return chunks;
+    }
+
+    bool RenderFarm::renderVideoChunk(const ProjectConfig &config, size_t beginScene, size_t endScene,
+                                      const std::string &outputPath, std::string *error)
+    {
+        if (beginScene >= endScene || endScene > config.scenes.size()) {
+            *error = "Invalid scene range";
+            return false;
+        }
+        const ProjectConfig chunk = videoChunkConfig(config, beginScene, endScene, outputPath);
+
+        RenderEngine engine;
+        engine.setAudioEnabled(false);
+        if (!engine.initialize(chunk) || !engine.render()) {
+            *error = engine.errorString();
+            return false;
+        }
+        return true;
+    }
+
+    bool RenderFarm::renderAudioTrack(const ProjectConfig &config, const std::string &outputPath, std::string *error)
+    {
+        const ProjectConfig audio = audioTrackConfig(config, outputPath);
+
+        RenderEngine engine;
+        if (!engine.initialize(audio) || !engine.render()) {
+            *error = engine.errorString();
+            return false;
+        }
+        return true;
+    }
+
+    bool RenderFarm::mergeChunks(const std::vector<std::string> &videoChunks, const std::string &audioPath,
+                                 const std::string &outputPath, std::string *error)
+    {
+        if (videoChunks.empty()) {
+            *error = "No video chunks to merge";
+            return false;
+        }
+
+        int firstIndex = -1;
+        InputContextPtr first = openInput(videoChunks.front(), AVMEDIA_TYPE_VIDEO, &firstIndex, error);
+        if (!first) {
+            return false;
+        }
+        const AVStream *firstStream = first->streams[firstIndex];
+
+        AVFormatContext *temp_ctx = nullptr;
+        if (avformat_alloc_output_context2(&temp_ctx, nullptr, "mp4", outputPath.c_str()) < 0) {
+            *error = "Failed to create output context: " + outputPath;
+            return false;
+        }
+        FFmpegUtils::AvFormatContextPtr output(temp_ctx);
+
+        AVStream *videoStream = avformat_new_stream(output.get(), nullptr);
+        if (!videoStream || avcodec_parameters_copy(videoStream->codecpar, firstStream->codecpar) < 0) {
+            *error = "Failed to create output video stream";
+            return false;
+        }
+        videoStream->codecpar->codec_tag = 0;
+        videoStream->time_base = firstStream->time_base;
+
+        int audioIndex = -1;
+        InputContextPtr audio;
+        AVStream *audioStream = nullptr;
+        if (!audioPath.empty()) {
+            audio = openInput(audioPath, AVMEDIA_TYPE_AUDIO, &audioIndex, error);
+            if (!audio) {
+                return false;
+            }
+            audioStream = avformat_new_stream(output.get(), nullptr);
+            if (!audioStream || avcodec_parameters_copy(audioStream->codecpar, audio->streams[audioIndex]->codecpar) < 0) {
+                *error = "Failed to create output audio stream";
+                return false;
+            }
+            audioStream->codecpar->codec_tag = 0;
+            audioStream->time_base = audio->streams[audioIndex]->time_base;
+        }
+
+        if (avio_open(&output->pb, outputPath.c_str(), AVIO_FLAG_WRITE) < 0) {
+            *error = "Cannot open output file: " + outputPath;
+            return false;
+        }
+        if (avformat_write_header(output.get(), nullptr) < 0) {
+            *error = "Failed to write output header: " + outputPath;
+            return false;
+        }
+
+        // 音频包按时间戳穿插在视频包之间写出，封装器无需缓存整条音轨
+        auto audioPacket = FFmpegUtils::createAvPacket();
+        bool audioPending = false;
+        bool audioFinished = !audio;
+        auto writeAudioUntil = [&](int64_t limit, AVRational limitTimeBase) {
+            while (!audioFinished) {
+                if (!audioPending) {
+                    if (av_read_frame(audio.get(), audioPacket.get()) < 0) {
+                        audioFinished = true;
+                        break;
+                    }
+                    if (audioPacket->stream_index != audioIndex) {
+                        av_packet_unref(audioPacket.get());
+                        continue;
+                    }
+                    av_packet_rescale_ts(audioPacket.get(), audio->streams[audioIndex]->time_base, audioStream->time_base);
+                    audioPacket->stream_index = audioStream->index;
+                    audioPacket->pos = -1;
+                    audioPending = true;
+                }
+                const int64_t ts = audioPacket->dts != AV_NOPTS_VALUE ? audioPacket->dts : audioPacket->pts;
+                if (limit != AV_NOPTS_VALUE && ts != AV_NOPTS_VALUE && av_compare_ts(ts, audioStream->time_base, limit, limitTimeBase) > 0) {
+                    break;
+                }
+                audioPending = false;
+                if (av_interleaved_write_frame(output.get(), audioPacket.get()) < 0) {
+                    *error = "Failed to write audio packet";
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        auto packet = FFmpegUtils::createAvPacket();
+        int64_t chunkOffset = 0;
+        int64_t lastDts = AV_NOPTS_VALUE;
+        for (size_t i = 0; i < videoChunks.size(); ++i) {
+            int inputIndex = firstIndex;
+            InputContextPtr input = i == 0 ? std::move(first) : openInput(videoChunks[i], AVMEDIA_TYPE_VIDEO, &inputIndex, error);
+            if (!input) {
+                return false;
+            }
+            const AVStream *inputStream = input->streams[inputIndex];
+            // 流复制要求所有分块使用同一组参数集
+            if (!sameVideoParameters(inputStream->codecpar, videoStream->codecpar)) {
+                *error = "Chunk encoding parameters differ: " + videoChunks[i];
+                return false;
+            }
+
+            const int64_t startPts = inputStream->start_time != AV_NOPTS_VALUE ? inputStream->start_time : 0;
+            int64_t chunkEnd = chunkOffset;
+            while (av_read_frame(input.get(), packet.get()) >= 0) {
+                if (packet->stream_index != inputIndex) {
+                    av_packet_unref(packet.get());
+                    continue;
+                }
+                // 以分块首帧为零点，平移到前面各分块之后
+                if (packet->pts != AV_NOPTS_VALUE) {
+                    packet->pts = chunkOffset + av_rescale_q(packet->pts - startPts, inputStream->time_base, videoStream->time_base);
+                }
+                if (packet->dts != AV_NOPTS_VALUE) {
+                    packet->dts = chunkOffset + av_rescale_q(packet->dts - startPts, inputStream->time_base, videoStream->time_base);
+                }
+                packet->duration = av_rescale_q(packet->duration, inputStream->time_base, videoStream->time_base);
+                if (packet->pts != AV_NOPTS_VALUE) {
+                    chunkEnd = std::max(chunkEnd, packet->pts + std::max<int64_t>(packet->duration, 1));
+                }
+                // 下一分块开头的 B 帧延迟使 DTS 可能回退，顺延以保持单调
+                if (packet->dts != AV_NOPTS_VALUE) {
+                    if (lastDts != AV_NOPTS_VALUE && packet->dts <= lastDts) {
+                        packet->dts = lastDts + 1;
+                        if (packet->pts != AV_NOPTS_VALUE && packet->pts < packet->dts) {
+                            packet->pts = packet->dts;
+                        }
+                    }
+                    lastDts = packet->dts;
+                }
+                packet->stream_index = videoStream->index;
+                packet->pos = -1;
+
+                if (!writeAudioUntil(packet->dts, videoStream->time_base)) {
+                    return false;
+                }
+                if (av_interleaved_write_frame(output.get(), packet.get()) < 0) {
+                    *error = "Failed to write video packet from " + videoChunks[i];
+                    return false;
+                }
+            }
+            chunkOffset = chunkEnd;
+        }
+
+        if (!writeAudioUntil(AV_NOPTS_VALUE, videoStream->time_base)) {
+            return false;
+        }
+        if (av_write_trailer(output.get()) < 0) {
+            *error = "Failed to write output trailer: " + outputPath;
+            return false;
+        }
+        return true;
+    }
+
+    bool RenderFarm::runWorkers(const QString &programPath, const std::vector<QStringList> &jobs,
+                                const std::vector<int64_t> &jobBytes, const std::function<bool(size_t)> &jobFinished)
+    {
+        struct RunningWorker
+        {
+            std::unique_ptr<QProcess> process;
+            size_t job;
+        };
+        std::vector<RunningWorker> running;
+        // 本机同时运行的工作进程受数量与预计峰值内存之和两方面限制；
+        // 经 launcher 启动的工作进程运行在其他主机上，不占用本机内存预算，只计入进程数
+        AdmissionController admission(m_memoryBudget, m_workerCount);
+        auto localBytes = [&](size_t job) { return m_launchers.empty() ? jobBytes[job] : int64_t{0}; };
+        auto stopAll = [&]() {
+            for (auto &worker : running) {
+                worker.process->kill();
+                worker.process->waitForFinished();
+            }
+        };
+
+        size_t nextJob = 0;
+        size_t finishedJobs = 0;
+        while (finishedJobs < jobs.size()) {
+            while (nextJob < jobs.size() && admission.tryAcquire(localBytes(nextJob))) {
+                QString program = programPath;
+                QStringList arguments;
+                if (!m_launchers.empty()) {
+                    // 如 "ssh render-02"：工作进程在远端以相同路径运行，输入输出均位于共享文件系统
+                    QStringList launcher = QProcess::splitCommand(m_launchers[static_cast<int>(nextJob % m_launchers.size())]);
+                    if (!launcher.empty()) {
+                        program = launcher.front();
+                        for (size_t k = 1; k < static_cast<size_t>(launcher.size()); ++k) {
+                            arguments.push_back(launcher[static_cast<int>(k)]);
+                        }
+                        arguments.push_back(programPath);
+                    }
+                }
+                for (const QString &argument : jobs[nextJob]) {
+                    arguments.push_back(argument);
+                }
+
+                auto process = std::make_unique<QProcess>();
+                process->setProcessChannelMode(QProcess::ForwardedChannels);
+                process->start(program, arguments);
+                if (!process->waitForStarted()) {
+                    admission.release(localBytes(nextJob));
+                    m_errorString = "Failed to start worker: " + process->errorString().toStdString();
+                    stopAll();
+                    return false;
+                }
+                running.push_back({std::move(process), nextJob});
+                ++nextJob;
+            }
+
+            for (auto it = running.begin(); it != running.end();) {
+                it->process->waitForFinished(100);
+                if (it->process->state() != QProcess::NotRunning) {
+                    ++it;
+                    continue;
+                }
+                admission.release(localBytes(it->job));
+                if (it->process->exitStatus() != QProcess::NormalExit || it->process->exitCode() != 0) {
+                    m_errorString = "Worker job " + std::to_string(it->job) + " failed with exit code " + std::to_string(it->process->exitCode());
+                    it = running.erase(it);
+                    stopAll();
+                    return false;
+                }
+                if (!jobFinished(it->job)) {
+                    it = running.erase(it);
+                    stopAll();
+                    return false;
+                }
+                ++finishedJobs;
+                qDebug() << "Render farm:" << finishedJobs << "/" << jobs.size() << "jobs finished";
+                it = running.erase(it);
+            }
+        }
+        return true;
+    }
+
+    bool RenderFarm::run(const QString &projectPath, const QString &programPath)
+    {
+        ConfigLoader loader;
+        ProjectConfig config;
+        if (!loader.loadFromFile(projectPath, config)) {
+            m_errorString = "Failed to load project: " + loader.errorString().toStdString();
+            return false;
+        }
+        if (config.output.mode != "mp4" || !config.output.renditions.empty()) {
+            m_errorString = "Render farm only supports plain mp4 output without renditions";
+            return false;
+        }
+        if (config.project.output_path.empty() || config.project.output_path == "-") {
+            m_errorString = "Render farm needs a file output_path";
+            return false;
+        }
+
+        // 工作目录与输出文件相邻，远端工作进程同样通过共享文件系统读写
+        const QFileInfo outputInfo(QString::fromStdString(config.project.output_path));
+        QDir workDir(outputInfo.absoluteFilePath() + ".farm");
+        if (!workDir.mkpath(".")) {
+            m_errorString = "Cannot create work directory: " + workDir.absolutePath().toStdString();
+            return false;
+        }
+        // 编译工程带媒体探测快照，工作进程加载时无需再探测素材
+        const QString compiledPath = workDir.absoluteFilePath("project.vcproj");
+        if (!loader.compileToFile(config, compiledPath)) {
+            m_errorString = "Failed to compile project: " + loader.errorString().toStdString();
+            return false;
+        }
+
+        // 分块数取工作进程数的两倍，先完成的进程继续领取剩余分块，平衡各分块的耗时差异；
+        // 指定分块时长时按时长继续细分，缩小中断后需要重新渲染的范围
+        const int workers = std::max(1, m_workerCount);
+        int maxChunks = workers * 2;
+        if (m_segmentDuration > 0.0) {
+            double totalDuration = 0.0;
+            for (const auto &scene : config.scenes) {
+                totalDuration += std::max(0.0, scene.duration);
+            }
+            maxChunks = std::max(maxChunks, static_cast<int>(std::ceil(totalDuration / m_segmentDuration)));
+        }
+        const std::vector<RenderChunk> chunks = planChunks(config, maxChunks);
+        if (chunks.empty()) {
+            m_errorString = "Project has no scenes to render";
+            return false;
+        }
+
+        // 音轨按整条时间线只渲染一次，最先启动并与各分块并行
+        const QString audioPath = workDir.absoluteFilePath("audio.m4a");
+        std::vector<QStringList> jobs;
+        std::vector<QString> jobFiles;
+        std::vector<int64_t> jobBytes;
+        jobs.push_back(QStringList{"--worker", compiledPath, "--audio", "--output", audioPath});
+        jobFiles.push_back(audioPath);
+        jobBytes.push_back(MemoryEstimate::fromConfig(audioTrackConfig(config, audioPath.toStdString())).total());
+        std::vector<std::string> chunkPaths;
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            const QString chunkPath = workDir.absoluteFilePath("chunk_" + QString::number(static_cast<int>(i)) + ".mp4");
+            chunkPaths.push_back(chunkPath.toStdString());
+            jobFiles.push_back(chunkPath);
+            MemoryEstimate chunkEstimate = MemoryEstimate::fromConfig(videoChunkConfig(config, chunks[i].beginScene, chunks[i].endScene, chunkPath.toStdString()));
+            chunkEstimate.audio = 0; // 分块工作进程不输出音频
+            jobBytes.push_back(chunkEstimate.total());
+            jobs.push_back(QStringList{"--worker", compiledPath, "--scenes",
+                                       QString::number(static_cast<int>(chunks[i].beginScene)),
+                                       QString::number(static_cast<int>(chunks[i].endScene)),
+                                       "--output", chunkPath});
+            qDebug() << "Chunk" << i << ": scenes" << chunks[i].beginScene << "-" << chunks[i].endScene - 1
+                     << "(" << chunks[i].duration << "s)";
+        }
+
+        const QString manifestPath = workDir.absoluteFilePath("manifest.json");
+        const QString fingerprint = projectFingerprint(projectPath, chunks);
+        std::vector<bool> done(jobs.size(), false);
+        if (m_resume) {
+            done = loadManifest(manifestPath, fingerprint, jobs.size());
+        }
+        if (!writeManifest(manifestPath, fingerprint, jobFiles, done)) {
+            m_errorString = "Cannot write manifest: " + manifestPath.toStdString();
+            return false;
+        }
+
+        std::vector<QStringList> pendingJobs;
+        std::vector<int64_t> pendingBytes;
+        std::vector<size_t> pendingIndices;
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            if (!done[i]) {
+                pendingJobs.push_back(jobs[i]);
+                pendingBytes.push_back(jobBytes[i]);
+                pendingIndices.push_back(i);
+            }
+        }
+        if (pendingJobs.size() < jobs.size()) {
+            qDebug() << "Render farm: resuming," << jobs.size() - pendingJobs.size() << "/" << jobs.size() << "jobs already completed";
+        }
+
+        // 每个任务完成后立即记入清单，协调者或节点中断后从最后完成的分块继续
+        auto jobFinished = [&](size_t pendingIndex) {
+            done[pendingIndices[pendingIndex]] = true;
+            if (!writeManifest(manifestPath, fingerprint, jobFiles, done)) {
+                m_errorString = "Cannot write manifest: " + manifestPath.toStdString();
+                return false;
+            }
+            return true;
+        };
+        if (!runWorkers(programPath, pendingJobs, pendingBytes, jobFinished)) {
+            return false;
+        }
+        if (!mergeChunks(chunkPaths, audioPath.toStdString(), config.project.output_path, &m_errorString)) {
+            return false;
+        }
+        workDir.removeRecursively();
+        return true;
+    }
+
+} // namespace VideoCreator
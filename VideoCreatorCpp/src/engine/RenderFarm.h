@@ -0,0 +1,80 @@
+#ifndef RENDER_FARM_H
+#define RENDER_FARM_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include <QString>
+#include <QStringList>
+#include "model/ProjectConfig.h"
+
+namespace VideoCreator
+{
+
+    // 时间线上的一个分块：场景区间 [beginScene, endScene)
+    struct RenderChunk
+    {
+        size_t beginScene = 0;
+        size_t endScene = 0;
+        double duration = 0.0;
+        std::string outputPath;
+    };
+
+    // 本机多进程渲染：在场景边界把时间线切成分块，由工作进程各自通过 RenderEngine 渲染画面，
+    // 整条音轨由一个纯音频任务渲染一次，最后以流复制把分块与音轨合并为输出文件
+    // 工作进程只依赖共享文件系统上的编译工程，也可以通过 launcher（如 "ssh host"）在其他主机上启动
+    class RenderFarm
+    {
+    public:
+        RenderFarm() = default;
+
+        // 并行运行的工作进程数
+        void setWorkerCount(int workers) { m_workerCount = workers; }
+        // 启动工作进程的前缀命令，多个时轮流使用；为空时直接在本机启动
+        void setLaunchers(const QStringList &launchers) { m_launchers = launchers; }
+        // 分块时长上限（秒），同时是断点续渲的检查点粒度；0 表示只按工作进程数切分
+        void setSegmentDuration(double seconds) { m_segmentDuration = seconds; }
+        // 断点续渲：工作目录中的清单与工程一致时，跳过已完成的分块与音轨
+        void setResume(bool resume) { m_resume = resume; }
+        // 本机工作进程的内存预算（字节）：按各任务的 MemoryEstimate 准入，0 表示只限制进程数
+        // 设置了 launcher 时工作进程在其他主机上运行，不按本机预算准入
+        void setMemoryBudget(int64_t bytes) { m_memoryBudget = bytes; }
+
+        // 协调者：加载工程并写出带探测快照的编译工程供工作进程读取，渲染各分块与音轨后合并到 output_path
+        // 每完成一个任务即更新工作目录中的清单；失败时保留工作目录供 resume 继续
+        // programPath 为工作进程使用的可执行文件（通常是当前程序）
+        bool run(const QString &projectPath, const QString &programPath);
+
+        std::string errorString() const { return m_errorString; }
+
+        // 在场景边界切分：转场与其前后场景必须落在同一分块，分块数不超过 maxChunks
+        static std::vector<RenderChunk> planChunks(const ProjectConfig &config, int maxChunks);
+
+        // 工作进程：只渲染 [beginScene, endScene) 的画面，不输出音频
+        static bool renderVideoChunk(const ProjectConfig &config, size_t beginScene, size_t endScene,
+                                     const std::string &outputPath, std::string *error);
+        // 工作进程：按整条时间线渲染音轨（m4a）
+        static bool renderAudioTrack(const ProjectConfig &config, const std::string &outputPath, std::string *error);
+
+        // 以流复制依次拼接视频分块，并混入音轨（可为空）
+        static bool mergeChunks(const std::vector<std::string> &videoChunks, const std::string &audioPath,
+                                const std::string &outputPath, std::string *error);
+
+    private:
+        // 运行一组工作进程参数，并行数与本机任务的 jobBytes 之和受 m_workerCount / m_memoryBudget 限制
+        // 每个任务成功后回调其下标，任一失败时终止其余进程
+        bool runWorkers(const QString &programPath, const std::vector<QStringList> &jobs,
+                        const std::vector<int64_t> &jobBytes, const std::function<bool(size_t)> &jobFinished);
+
+        int m_workerCount = 2;
+        double m_segmentDuration = 0.0;
+        bool m_resume = false;
+        int64_t m_memoryBudget = 0;
+        QStringList m_launchers;
+        std::string m_errorString;
+    };
+
+} // namespace VideoCreator
+
+#endif // RENDER_FARM_H
@@ -0,0 +1,190 @@
+#include "SceneAudioMixer.h"
+#include "RenderBuffers.h"
+#include <QDebug>
+#include <QString>
+#include <algorithm>
+#include <cmath>
+
+namespace VideoCreator
+{
+
+    bool SceneAudioMixer::open(const SceneConfig &scene, int sampleRate, bool requireSidechain, int64_t leadSamples)
+    {
+        m_layers.clear();
+        m_sceneId = scene.id;
+        m_longestDuration = -1.0;
+        m_requireSidechain = requireSidechain;
+
+        const bool isVideoScene = scene.type == SceneType::VIDEO_SCENE;
+        size_t expectedLayers = 0;
+        if (!scene.resources.audio.path.empty()) {
+            expectedLayers++;
+        }
+        expectedLayers += scene.resources.audio_layers.size();
+        if (isVideoScene && scene.resources.video.use_audio && !scene.resources.video.path.empty()) {
+            expectedLayers++;
+        }
+        m_layers.reserve(expectedLayers);
+
+        if (!scene.resources.audio.path.empty()) {
+            AudioConfig narrationConfig = scene.resources.audio;
+            narrationConfig.ducking.enabled = false;
+            if (!addLayer(scene, narrationConfig, true, true, sampleRate, leadSamples, false)) {
+                m_errorString = "Failed to initialize primary audio source";
+                return false;
+            }
+            if (!m_layers.empty()) {
+                m_layers.front()->isSidechain = true;
+            }
+        }
+
+        for (const auto &layerConfig : scene.resources.audio_layers) {
+            addLayer(scene, layerConfig, false, false, sampleRate, leadSamples, false);
+        }
+
+        if (isVideoScene && scene.resources.video.use_audio && !scene.resources.video.path.empty()) {
+            AudioConfig videoAudioConfig;
+            videoAudioConfig.path = scene.resources.video.path;
+            videoAudioConfig.volume = 1.0;
+            videoAudioConfig.start_offset = 0.0;
+            bool treatAsPrimary = scene.resources.audio.path.empty() && scene.resources.audio_layers.empty();
+            if (!addLayer(scene, videoAudioConfig, treatAsPrimary, treatAsPrimary, sampleRate, leadSamples, true) && treatAsPrimary) {
+                m_errorString = "Failed to initialize video audio";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool SceneAudioMixer::addLayer(const SceneConfig &scene, const AudioConfig &audioConfig, bool applySceneEffect, bool isCritical, int sampleRate, int64_t leadSamples, bool alignToVideo)
+    {
+        if (audioConfig.path.empty()) {
+            return true;
+        }
+
+        auto decoder = std::make_unique<AudioDecoder>();
+        if (!decoder->open(audioConfig.path, sampleRate)) {
+            qDebug() << "Failed to open audio:" << QString::fromStdString(audioConfig.path) << "reason:" << decoder->getErrorString().c_str();
+            return !isCritical;
+        }
+
+        double decoderDuration = decoder->getDuration();
+        if (decoderDuration > m_longestDuration) {
+            m_longestDuration = decoderDuration;
+        }
+
+        auto layer = std::make_unique<Layer>();
+        // 视频原声与画面同步，在预混区间内保持静音；其余图层从预混起点播放，包络覆盖预混与场景
+        const int64_t layerLead = alignToVideo ? 0 : leadSamples;
+        const double sceneDuration = scene.duration > 0 ? scene.duration + static_cast<double>(layerLead) / sampleRate : scene.duration;
+        // 不为每个图层构建 afade/volume 滤镜图，增益包络在 mix 中按块施加
+        if (applySceneEffect) {
+            const VolumeMixEffect &effect = scene.effects.volume_mix;
+            const double trackDuration = scene.duration > 0 ? sceneDuration : decoderDuration;
+            layer->gain = AudioMixKernels::GainEnvelope::fromSeconds(
+                audioConfig.volume,
+                effect.enabled ? effect.fade_in : 0.0,
+                effect.enabled ? effect.fade_out : 0.0,
+                trackDuration, sampleRate);
+        } else {
+            layer->gain = AudioMixKernels::GainEnvelope::fromSeconds(audioConfig.volume, 0.0, 0.0, sceneDuration, sampleRate);
+        }
+        if (audioConfig.ducking.enabled) {
+            const DuckingConfig &ducking = audioConfig.ducking;
+            layer->ducker = AudioMixKernels::Ducker::fromSettings(ducking.amount_db, ducking.threshold_db, ducking.attack, ducking.release, sampleRate);
+        }
+        if (audioConfig.start_offset > 0) {
+            layer->delaySamples = static_cast<int64_t>(std::round(audioConfig.start_offset * sampleRate));
+        }
+        if (alignToVideo) {
+            layer->delaySamples += leadSamples;
+        }
+        layer->source.start(std::move(decoder), static_cast<size_t>(sampleRate) * RenderBuffers::kAudioBufferSeconds);
+        m_layers.emplace_back(std::move(layer));
+        return true;
+    }
+
+    bool SceneAudioMixer::mix(int samples, float *left, float *right, bool &hasAudio)
+    {
+        hasAudio = false;
+        m_sidechainActive = false;
+        if (m_layers.empty() || samples <= 0) {
+            return true;
+        }
+
+        bool hasActiveLayer = false;
+        bool hasPendingAudio = false;
+
+        // 旁白总是第一个图层：先单独混入侧链缓冲，闪避图层/工程音轨据此计算增益
+        const bool hasSidechain = m_layers.front()->isSidechain;
+        m_sidechainActive = hasSidechain && (m_requireSidechain ||
+            std::any_of(m_layers.begin(), m_layers.end(), [](const std::unique_ptr<Layer> &layerPtr) {
+                return layerPtr->ducker.enabled;
+            }));
+        if (m_sidechainActive) {
+            m_sidechainLeft.assign(samples, 0.0f);
+            m_sidechainRight.assign(samples, 0.0f);
+        }
+
+        for (auto &layerPtr : m_layers) {
+            auto &layer = *layerPtr;
+            const bool writeToSidechain = m_sidechainActive && layer.isSidechain;
+            float *mixLeft = writeToSidechain ? m_sidechainLeft.data() : left;
+            float *mixRight = writeToSidechain ? m_sidechainRight.data() : right;
+            const bool ducked = m_sidechainActive && layer.ducker.enabled;
+            if (ducked) {
+                // 图层处于延迟期间也推进闪避状态，入场时增益已与旁白同步
+                m_duckGainBuffer.resize(static_cast<size_t>(samples));
+                AudioMixKernels::computeDuckingGains(layer.ducker, m_sidechainLeft.data(), m_sidechainRight.data(), samples, m_duckGainBuffer.data());
+            }
+            if (layer.delaySamples >= samples) {
+                layer.delaySamples -= samples;
+                if (layer.source.hasPendingAudio()) {
+                    hasPendingAudio = true;
+                }
+                continue;
+            }
+
+            int silentSamples = 0;
+            if (layer.delaySamples > 0) {
+                silentSamples = static_cast<int>(layer.delaySamples);
+                layer.delaySamples = 0;
+            }
+
+            const int requiredSamples = samples - silentSamples;
+            const float *gains = nullptr;
+            if (!layer.gain.isUnity() || ducked) {
+                m_gainBuffer.resize(static_cast<size_t>(requiredSamples));
+                AudioMixKernels::fillGain(layer.gain, layer.playedSamples, m_gainBuffer.data(), requiredSamples);
+                if (ducked) {
+                    AudioMixKernels::multiplyGains(m_gainBuffer.data(), m_duckGainBuffer.data() + silentSamples, requiredSamples);
+                }
+                gains = m_gainBuffer.data();
+            }
+
+            const int mixed = layer.source.mixInto(mixLeft + silentSamples, mixRight + silentSamples, requiredSamples, gains);
+            if (mixed < 0) {
+                m_errorString = layer.source.errorString();
+                return false;
+            }
+            if (mixed > 0) {
+                hasActiveLayer = true;
+            }
+            layer.playedSamples += mixed;
+            if (layer.source.hasPendingAudio()) {
+                hasPendingAudio = true;
+            }
+        }
+
+        if (m_sidechainActive) {
+            for (int i = 0; i < samples; ++i) {
+                left[i] += m_sidechainLeft[i];
+                right[i] += m_sidechainRight[i];
+            }
+        }
+
+        hasAudio = hasActiveLayer || hasPendingAudio;
+        return true;
+    }
+
+} // namespace VideoCreator
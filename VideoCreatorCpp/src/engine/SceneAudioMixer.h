@@ -0,0 +1,67 @@
+#ifndef SCENE_AUDIO_MIXER_H
+#define SCENE_AUDIO_MIXER_H
+
+#include <string>
+#include <memory>
+#include <vector>
+#include "model/ProjectConfig.h"
+#include "engine/AudioMixKernels.h"
+#include "engine/StreamingAudioSource.h"
+
+namespace VideoCreator
+{
+
+    // 单个场景的音频图层（旁白、audio_layers、视频原声）及其混音状态
+    // 与渲染流程解耦，交叉淡化转场提前打开下一场景的混音器进行预混（pre-roll），场景沿用同一混音器继续输出
+    class SceneAudioMixer
+    {
+    public:
+        SceneAudioMixer() = default;
+
+        // 打开场景引用的全部音频并启动解码线程
+        // requireSidechain: 即使场景内没有闪避图层也单独输出旁白（供工程音轨闪避）
+        // leadSamples: 混音器在场景画面之前开始输出的样本数（交叉淡化转场的预混）；
+        // 旁白与 audio_layers 从预混起点播放，视频原声延迟 leadSamples 与视频首帧对齐
+        bool open(const SceneConfig &scene, int sampleRate, bool requireSidechain, int64_t leadSamples = 0);
+
+        // 将 samples 个样本累加到 left/right（含旁白）
+        // hasAudio 为 false 表示所有图层均已结束，调用方可直接写入静音
+        bool mix(int samples, float *left, float *right, bool &hasAudio);
+
+        // 最近一次 mix 的旁白输出，未启用侧链时为空
+        const float *sidechainLeft() const { return m_sidechainActive ? m_sidechainLeft.data() : nullptr; }
+        const float *sidechainRight() const { return m_sidechainActive ? m_sidechainRight.data() : nullptr; }
+
+        bool empty() const { return m_layers.empty(); }
+        int sceneId() const { return m_sceneId; }
+        double longestDuration() const { return m_longestDuration; }
+        std::string errorString() const { return m_errorString; }
+
+    private:
+        struct Layer
+        {
+            StreamingAudioSource source;
+            int64_t delaySamples = 0;
+            AudioMixKernels::GainEnvelope gain; // 音量与淡入淡出在混音时按样本施加
+            int64_t playedSamples = 0;
+            bool isSidechain = false;           // 旁白，作为闪避的侧链输入
+            AudioMixKernels::Ducker ducker;
+        };
+
+        bool addLayer(const SceneConfig &scene, const AudioConfig &audioConfig, bool applySceneEffect, bool isCritical, int sampleRate, int64_t leadSamples, bool alignToVideo);
+
+        std::vector<std::unique_ptr<Layer>> m_layers;
+        int m_sceneId = 0;
+        double m_longestDuration = -1.0;
+        bool m_requireSidechain = false;
+        bool m_sidechainActive = false;
+        std::vector<float> m_sidechainLeft;
+        std::vector<float> m_sidechainRight;
+        std::vector<float> m_gainBuffer;
+        std::vector<float> m_duckGainBuffer;
+        std::string m_errorString;
+    };
+
+} // namespace VideoCreator
+
+#endif // SCENE_AUDIO_MIXER_H
@@ -0,0 +1,127 @@
+#include "StreamingAudioSource.h"
+#include "AudioMixKernels.h"
+#include <algorithm>
+
+namespace VideoCreator
+{
+
+    StreamingAudioSource::~StreamingAudioSource()
+    {
+        stop();
+    }
+
+    void StreamingAudioSource::start(std::unique_ptr<AudioDecoder> decoder, size_t maxBufferedSamples)
+    {
+        stop();
+        m_decoder = std::move(decoder);
+        m_finished = false;
+        m_error = false;
+        m_stopRequested.store(false);
+        m_worker = std::thread([this, maxBufferedSamples]() { decodeLoop(maxBufferedSamples); });
+    }
+
+    void StreamingAudioSource::stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopRequested.store(true);
+        }
+        m_cv.notify_all();
+        if (m_worker.joinable()) {
+            m_worker.join();
+        }
+    }
+
+    void StreamingAudioSource::decodeLoop(size_t maxBufferedSamples)
+    {
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_stopRequested.load()) {
+                    break;
+                }
+            }
+            FFmpegUtils::AvFramePtr frame;
+            int decodeResult = m_decoder->decodeFrame(frame);
+            if (decodeResult > 0 && frame) {
+                int channelCount = frame->ch_layout.nb_channels > 0 ? frame->ch_layout.nb_channels : 1;
+                channelCount = std::min(channelCount, 2);
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [&]() {
+                    return m_stopRequested.load() || m_channels[0].size() < maxBufferedSamples;
+                });
+                if (m_stopRequested.load()) {
+                    break;
+                }
+                for (int ch = 0; ch < channelCount; ++ch) {
+                    float *data = reinterpret_cast<float *>(frame->data[ch]);
+                    m_channels[ch].insert(m_channels[ch].end(), data, data + frame->nb_samples);
+                }
+                if (channelCount == 1) {
+                    auto copyBegin = m_channels[0].end() - frame->nb_samples;
+                    m_channels[1].insert(m_channels[1].end(), copyBegin, m_channels[0].end());
+                }
+                size_t maxSamples = std::max(m_channels[0].size(), m_channels[1].size());
+                m_channels[0].resize(maxSamples, 0.0f);
+                m_channels[1].resize(maxSamples, 0.0f);
+                lock.unlock();
+                m_cv.notify_all();
+            } else if (decodeResult == 0) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_finished = true;
+                m_cv.notify_all();
+                break;
+            } else {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_error = true;
+                m_errorString = m_decoder ? m_decoder->getErrorString() : std::string("Audio decode failed");
+                m_cv.notify_all();
+                break;
+            }
+        }
+    }
+
+    int StreamingAudioSource::mixInto(float *left, float *right, int count, const float *gains)
+    {
+        if (!m_decoder) {
+            return 0;
+        }
+        int consumed = 0;
+        while (consumed < count) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [&]() {
+                return m_stopRequested.load() || m_error || !m_channels[0].empty() || m_finished;
+            });
+            if (m_error) {
+                if (m_errorString.empty()) {
+                    m_errorString = "Audio decode failed";
+                }
+                return -1;
+            }
+            if (m_channels[0].empty()) {
+                // 解码结束（或已停止）且缓冲耗尽
+                break;
+            }
+
+            const int take = std::min(count - consumed, static_cast<int>(m_channels[0].size()));
+            if (gains) {
+                AudioMixKernels::accumulateFromQueueWithGain(m_channels[0], left + consumed, gains + consumed, take);
+                AudioMixKernels::accumulateFromQueueWithGain(m_channels[1], right + consumed, gains + consumed, take);
+            } else {
+                AudioMixKernels::accumulateFromQueue(m_channels[0], left + consumed, take);
+                AudioMixKernels::accumulateFromQueue(m_channels[1], right + consumed, take);
+            }
+            consumed += take;
+            lock.unlock();
+            m_cv.notify_all();
+        }
+        return consumed;
+    }
+
+    bool StreamingAudioSource::hasPendingAudio()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return !m_finished || !m_channels[0].empty();
+    }
+
+} // namespace VideoCreator
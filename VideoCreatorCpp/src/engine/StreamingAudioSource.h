@@ -0,0 +1,59 @@
+#ifndef STREAMING_AUDIO_SOURCE_H
+#define STREAMING_AUDIO_SOURCE_H
+
+#include <string>
+#include <memory>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include "decoder/AudioDecoder.h"
+
+namespace VideoCreator
+{
+
+    // 后台线程持续解码一个音频文件，混音线程按需取样累加
+    // 场景音频图层与跨场景的工程音轨共用
+    class StreamingAudioSource
+    {
+    public:
+        StreamingAudioSource() = default;
+        ~StreamingAudioSource();
+
+        StreamingAudioSource(const StreamingAudioSource &) = delete;
+        StreamingAudioSource &operator=(const StreamingAudioSource &) = delete;
+
+        // 接管已打开的解码器并启动解码线程，缓冲上限为 maxBufferedSamples（每声道）
+        void start(std::unique_ptr<AudioDecoder> decoder, size_t maxBufferedSamples);
+
+        // 停止并等待解码线程退出
+        void stop();
+
+        // 取出最多 count 个样本累加到 left/right，gains 为空时按单位增益累加
+        // 数据不足时阻塞等待解码线程；返回实际累加的样本数，-1 表示解码失败（见 errorString）
+        int mixInto(float *left, float *right, int count, const float *gains);
+
+        // 解码尚未结束或缓冲中仍有样本
+        bool hasPendingAudio();
+
+        AudioDecoder *decoder() const { return m_decoder.get(); }
+        std::string errorString() const { return m_errorString; }
+
+    private:
+        void decodeLoop(size_t maxBufferedSamples);
+
+        std::unique_ptr<AudioDecoder> m_decoder;
+        std::deque<float> m_channels[2];
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::thread m_worker;
+        bool m_finished = false;
+        bool m_error = false;
+        std::atomic<bool> m_stopRequested{false};
+        std::string m_errorString;
+    };
+
+} // namespace VideoCreator
+
+#endif // STREAMING_AUDIO_SOURCE_H
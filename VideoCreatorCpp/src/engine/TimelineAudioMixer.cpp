@@ -0,0 +1,325 @@
+#include "TimelineAudioMixer.h"
+#include "SceneAudioMixer.h"
+#include "RenderBuffers.h"
+#include "StreamingAudioSource.h"
+#include "decoder/AudioDecoder.h"
+#include <QDebug>
+#include <QString>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace VideoCreator
+{
+
+    namespace
+    {
+        constexpr int kDiscardChunk = 4096;
+
+        bool isCrossfadeTransition(const SceneConfig &scene)
+        {
+            return scene.type == SceneType::TRANSITION && scene.audio_crossfade;
+        }
+    } // namespace
+
+    // 工程级音轨：整个时间线只打开一次，按绝对样本位置跨场景/转场连续混入
+    struct TimelineAudioMixer::ProjectTrack
+    {
+        StreamingAudioSource source;
+        int64_t startSample = 0;
+        int64_t endSample = 0;
+        int64_t playedSamples = 0;
+        bool exhausted = false;
+        AudioMixKernels::GainEnvelope gain;
+        AudioMixKernels::Ducker ducker;
+    };
+
+    TimelineAudioMixer::TimelineAudioMixer()
+        : m_sampleRate(44100), m_position(0), m_sceneIndex(0), m_sceneActive(false), m_tracksDucked(false)
+    {
+    }
+
+    TimelineAudioMixer::~TimelineAudioMixer() = default;
+
+    bool TimelineAudioMixer::open(const ProjectConfig &config, int sampleRate)
+    {
+        if (sampleRate <= 0) {
+            m_errorString = "Invalid sample rate";
+            return false;
+        }
+        m_config = config;
+        m_sampleRate = sampleRate;
+        m_timeline = ProjectTimeline::build(m_config, m_sampleRate);
+        m_tracksDucked = std::any_of(m_config.audio_tracks.begin(), m_config.audio_tracks.end(),
+                                     [](const AudioTrackConfig &track) { return track.ducking.enabled; });
+        return seek(0);
+    }
+
+    bool TimelineAudioMixer::seek(int64_t sample)
+    {
+        sample = std::clamp<int64_t>(sample, 0, m_timeline.totalSamples);
+        m_mixer.reset();
+        m_prerolledMixer.reset();
+        m_transitionTail.reset(0);
+        m_sceneActive = false;
+
+        // 目标所在的场景；目标为时间线末尾时停在最后
+        size_t sceneIndex = m_timeline.entries.size();
+        for (size_t i = 0; i < m_timeline.entries.size(); ++i) {
+            const auto &entry = m_timeline.entries[i];
+            if (entry.sampleCount > 0 && sample < entry.startSample + entry.sampleCount) {
+                sceneIndex = i;
+                break;
+            }
+        }
+        if (sceneIndex == m_timeline.entries.size()) {
+            m_sceneIndex = sceneIndex;
+            m_position = m_timeline.totalSamples;
+            m_tracks.clear();
+            return true;
+        }
+
+        // 交叉淡化转场需要前一场景的尾部；紧随交叉淡化转场的场景，其混音器在转场开始时已经开始输出
+        size_t startIndex = sceneIndex;
+        if (startIndex > 0 && isCrossfadeTransition(m_config.scenes[startIndex])) {
+            --startIndex;
+        }
+        if (startIndex > 0 && m_config.scenes[startIndex].type != SceneType::TRANSITION &&
+            isCrossfadeTransition(m_config.scenes[startIndex - 1])) {
+            --startIndex;
+        }
+
+        if (!openProjectTracks(sample)) {
+            return false;
+        }
+        m_sceneIndex = startIndex;
+        m_position = m_timeline.entries[startIndex].startSample;
+
+        // 丢弃到目标位置；工程音轨已直接定位，不参与
+        m_discardLeft.resize(kDiscardChunk);
+        m_discardRight.resize(kDiscardChunk);
+        while (m_position < sample) {
+            const int chunk = static_cast<int>(std::min<int64_t>(kDiscardChunk, sample - m_position));
+            if (mixSamples(chunk, m_discardLeft.data(), m_discardRight.data(), false) < 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int TimelineAudioMixer::read(int samples, float *left, float *right)
+    {
+        return mixSamples(samples, left, right, true);
+    }
+
+    int TimelineAudioMixer::mixSamples(int samples, float *left, float *right, bool mixTracks)
+    {
+        int produced = 0;
+        while (produced < samples && m_position < m_timeline.totalSamples && m_sceneIndex < m_timeline.entries.size()) {
+            if (!m_sceneActive && !enterScene(m_sceneIndex)) {
+                return -1;
+            }
+            const auto &entry = m_timeline.entries[m_sceneIndex];
+            const int64_t sceneEnd = entry.startSample + entry.sampleCount;
+            if (m_position >= sceneEnd) {
+                leaveScene();
+                ++m_sceneIndex;
+                continue;
+            }
+            const int chunk = static_cast<int>(std::min<int64_t>(samples - produced, sceneEnd - m_position));
+            if (!mixChunk(chunk, left + produced, right + produced, mixTracks)) {
+                return -1;
+            }
+            produced += chunk;
+            m_position += chunk;
+        }
+        return produced;
+    }
+
+    bool TimelineAudioMixer::enterScene(size_t sceneIndex)
+    {
+        const SceneConfig &scene = m_config.scenes[sceneIndex];
+        const auto &entry = m_timeline.entries[sceneIndex];
+        m_sceneActive = true;
+        if (scene.type == SceneType::TRANSITION) {
+            if (scene.audio_crossfade && sceneIndex + 1 < m_config.scenes.size()) {
+                // 预混的混音器沿用到下一场景；视频原声延迟转场时长，与视频首帧对齐
+                m_mixer = openSceneMixer(m_config.scenes[sceneIndex + 1], entry.sampleCount);
+                return m_mixer != nullptr;
+            }
+            return true;
+        }
+
+        prepareTransitionTail(sceneIndex);
+        if (entry.sampleCount <= 0) {
+            return true;
+        }
+        if (m_prerolledMixer && m_prerolledMixer->sceneId() == scene.id) {
+            m_mixer = std::move(m_prerolledMixer);
+        } else {
+            m_mixer = openSceneMixer(scene);
+        }
+        m_prerolledMixer.reset();
+        return m_mixer != nullptr;
+    }
+
+    void TimelineAudioMixer::leaveScene()
+    {
+        if (m_config.scenes[m_sceneIndex].type == SceneType::TRANSITION) {
+            m_transitionTail.reset(0);
+            m_prerolledMixer = std::move(m_mixer);
+        }
+        m_mixer.reset();
+        m_sceneActive = false;
+    }
+
+    void TimelineAudioMixer::prepareTransitionTail(size_t sceneIndex)
+    {
+        size_t tailCapacity = 0;
+        if (sceneIndex + 1 < m_config.scenes.size()) {
+            const auto &nextScene = m_config.scenes[sceneIndex + 1];
+            if (isCrossfadeTransition(nextScene) && nextScene.duration > 0) {
+                tailCapacity = static_cast<size_t>(std::llround(nextScene.duration * m_sampleRate));
+            }
+        }
+        m_transitionTail.reset(tailCapacity);
+    }
+
+    std::unique_ptr<SceneAudioMixer> TimelineAudioMixer::openSceneMixer(const SceneConfig &scene, int64_t leadSamples)
+    {
+        auto mixer = std::make_unique<SceneAudioMixer>();
+        if (!mixer->open(scene, m_sampleRate, m_tracksDucked, leadSamples)) {
+            m_errorString = mixer->errorString();
+            return nullptr;
+        }
+        return mixer;
+    }
+
+    bool TimelineAudioMixer::mixChunk(int samples, float *left, float *right, bool mixTracks)
+    {
+        std::fill(left, left + samples, 0.0f);
+        std::fill(right, right + samples, 0.0f);
+
+        const SceneConfig &scene = m_config.scenes[m_sceneIndex];
+        const auto &entry = m_timeline.entries[m_sceneIndex];
+        const float *sidechainLeft = nullptr;
+        const float *sidechainRight = nullptr;
+        bool hasAudio = false;
+        if (m_mixer && !m_mixer->empty()) {
+            if (!m_mixer->mix(samples, left, right, hasAudio)) {
+                m_errorString = m_mixer->errorString();
+                return false;
+            }
+        }
+
+        if (scene.type == SceneType::TRANSITION) {
+            if (m_mixer) {
+                AudioMixKernels::crossfadeWithTail(m_transitionTail, m_position - entry.startSample, entry.sampleCount, left, right, samples);
+                sidechainLeft = m_mixer->sidechainLeft();
+                sidechainRight = m_mixer->sidechainRight();
+            }
+        } else if (!hasAudio) {
+            std::fill(left, left + samples, 0.0f);
+            std::fill(right, right + samples, 0.0f);
+            m_transitionTail.push(nullptr, nullptr, samples);
+        } else {
+            // 尾部只保留场景混音，工程音轨在转场中照常连续混入
+            m_transitionTail.push(left, right, samples);
+            sidechainLeft = m_mixer->sidechainLeft();
+            sidechainRight = m_mixer->sidechainRight();
+        }
+
+        if (mixTracks && !m_tracks.empty() && !mixProjectTracks(samples, sidechainLeft, sidechainRight, left, right)) {
+            return false;
+        }
+        AudioMixKernels::clampToPlanar(left, left, samples);
+        AudioMixKernels::clampToPlanar(right, right, samples);
+        return true;
+    }
+
+    bool TimelineAudioMixer::openProjectTracks(int64_t position)
+    {
+        m_tracks.clear();
+        for (const auto &trackConfig : m_config.audio_tracks) {
+            auto track = std::make_unique<ProjectTrack>();
+            track->startSample = static_cast<int64_t>(std::llround(std::max(0.0, trackConfig.start) * m_sampleRate));
+            track->endSample = trackConfig.end > trackConfig.start
+                ? static_cast<int64_t>(std::llround(trackConfig.end * m_sampleRate))
+                : std::numeric_limits<int64_t>::max();
+            if (position >= track->endSample) {
+                continue;
+            }
+
+            auto decoder = std::make_unique<AudioDecoder>();
+            if (!decoder->open(trackConfig.path, m_sampleRate)) {
+                qDebug() << "Failed to open audio track:" << QString::fromStdString(trackConfig.path) << "reason:" << decoder->getErrorString().c_str();
+                continue;
+            }
+            // 从音轨内的偏移处开始解码
+            track->playedSamples = std::max<int64_t>(0, position - track->startSample);
+            const double sourceStart = std::max(0.0, trackConfig.source_offset) + static_cast<double>(track->playedSamples) / m_sampleRate;
+            if (sourceStart > 0 && !decoder->seek(sourceStart)) {
+                qDebug() << "Failed to seek audio track:" << QString::fromStdString(trackConfig.path);
+            }
+
+            double trackDuration = trackConfig.end > trackConfig.start ? (trackConfig.end - trackConfig.start) : 0.0;
+            const double sourceRemaining = decoder->getDuration() - std::max(0.0, trackConfig.source_offset);
+            if (sourceRemaining > 0 && (trackDuration <= 0 || sourceRemaining < trackDuration)) {
+                trackDuration = sourceRemaining;
+            }
+            track->gain = AudioMixKernels::GainEnvelope::fromSeconds(trackConfig.volume, trackConfig.fade_in, trackConfig.fade_out, trackDuration, m_sampleRate);
+            if (trackConfig.ducking.enabled) {
+                const DuckingConfig &ducking = trackConfig.ducking;
+                track->ducker = AudioMixKernels::Ducker::fromSettings(ducking.amount_db, ducking.threshold_db, ducking.attack, ducking.release, m_sampleRate);
+            }
+            track->source.start(std::move(decoder), static_cast<size_t>(m_sampleRate) * RenderBuffers::kAudioBufferSeconds);
+            m_tracks.push_back(std::move(track));
+        }
+        return true;
+    }
+
+    bool TimelineAudioMixer::mixProjectTracks(int samples, const float *sidechainLeft, const float *sidechainRight, float *left, float *right)
+    {
+        const int64_t chunkStart = m_position;
+        const int64_t chunkEnd = chunkStart + samples;
+        for (auto &trackPtr : m_tracks) {
+            ProjectTrack &track = *trackPtr;
+            const bool ducked = track.ducker.enabled;
+            if (ducked) {
+                // 没有旁白的区间（无旁白场景、转场）以静音作为侧链，增益按 release 恢复
+                if (!sidechainLeft || !sidechainRight) {
+                    m_zeroBuffer.assign(static_cast<size_t>(samples), 0.0f);
+                    sidechainLeft = m_zeroBuffer.data();
+                    sidechainRight = m_zeroBuffer.data();
+                }
+                m_duckGainBuffer.resize(static_cast<size_t>(samples));
+                AudioMixKernels::computeDuckingGains(track.ducker, sidechainLeft, sidechainRight, samples, m_duckGainBuffer.data());
+            }
+
+            const int64_t activeStart = std::max(chunkStart, track.startSample);
+            const int64_t activeEnd = std::min(chunkEnd, track.endSample);
+            if (activeStart >= activeEnd || track.exhausted) {
+                continue;
+            }
+            const int offset = static_cast<int>(activeStart - chunkStart);
+            const int count = static_cast<int>(activeEnd - activeStart);
+
+            m_gainBuffer.resize(static_cast<size_t>(count));
+            AudioMixKernels::fillGain(track.gain, track.playedSamples, m_gainBuffer.data(), count);
+            if (ducked) {
+                AudioMixKernels::multiplyGains(m_gainBuffer.data(), m_duckGainBuffer.data() + offset, count);
+            }
+            const int mixed = track.source.mixInto(left + offset, right + offset, count, m_gainBuffer.data());
+            if (mixed < 0) {
+                m_errorString = "Audio track decode failed: " + track.source.errorString();
+                return false;
+            }
+            track.playedSamples += mixed;
+            if (mixed < count) {
+                track.exhausted = true;
+            }
+        }
+        return true;
+    }
+
+} // namespace VideoCreator
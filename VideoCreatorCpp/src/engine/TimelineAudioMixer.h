@@ -0,0 +1,76 @@
+#ifndef TIMELINE_AUDIO_MIXER_H
+#define TIMELINE_AUDIO_MIXER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "model/ProjectConfig.h"
+#include "engine/AudioMixKernels.h"
+#include "engine/ProjectTimeline.h"
+
+namespace VideoCreator
+{
+
+    class SceneAudioMixer;
+
+    // 按时间线输出混音后的 PCM（立体声 float，已限幅），不经过编码器
+    // 场景混音器、转场交叉淡化、工程音轨及其闪避只在这里实现：RenderEngine 把结果送入音频编码器，
+    // 预览播放直接交付；可定位到任意样本
+    class TimelineAudioMixer
+    {
+    public:
+        TimelineAudioMixer();
+        ~TimelineAudioMixer();
+
+        TimelineAudioMixer(const TimelineAudioMixer &) = delete;
+        TimelineAudioMixer &operator=(const TimelineAudioMixer &) = delete;
+
+        bool open(const ProjectConfig &config, int sampleRate);
+
+        // 定位到时间线样本 sample：从所在场景（转场交叉淡化时从其前一场景）开头混音并丢弃到目标位置，
+        // 场景音频无法直接跳转，场景越长定位越慢；工程音轨直接跳转
+        bool seek(int64_t sample);
+
+        // 从当前位置混音最多 samples 个样本写入 left/right（覆盖），返回实际样本数，0 表示时间线结束，-1 表示失败
+        int read(int samples, float *left, float *right);
+
+        int64_t position() const { return m_position; }
+        int64_t totalSamples() const { return m_timeline.totalSamples; }
+        int sampleRate() const { return m_sampleRate; }
+        std::string errorString() const { return m_errorString; }
+
+    private:
+        struct ProjectTrack;
+
+        bool openProjectTracks(int64_t position);
+        bool mixProjectTracks(int samples, const float *sidechainLeft, const float *sidechainRight, float *left, float *right);
+        bool enterScene(size_t sceneIndex);
+        void leaveScene();
+        void prepareTransitionTail(size_t sceneIndex);
+        std::unique_ptr<SceneAudioMixer> openSceneMixer(const SceneConfig &scene, int64_t leadSamples = 0);
+        bool mixChunk(int samples, float *left, float *right, bool mixTracks);
+        int mixSamples(int samples, float *left, float *right, bool mixTracks);
+
+        ProjectConfig m_config;
+        ProjectTimeline m_timeline;
+        int m_sampleRate;
+        int64_t m_position;
+        size_t m_sceneIndex;
+        bool m_sceneActive;
+        std::unique_ptr<SceneAudioMixer> m_mixer;
+        std::unique_ptr<SceneAudioMixer> m_prerolledMixer; // 转场已预混的下一场景
+        AudioMixKernels::AudioTailBuffer m_transitionTail;
+        std::vector<std::unique_ptr<ProjectTrack>> m_tracks;
+        bool m_tracksDucked;
+        std::vector<float> m_gainBuffer;
+        std::vector<float> m_duckGainBuffer;
+        std::vector<float> m_zeroBuffer;
+        std::vector<float> m_discardLeft;
+        std::vector<float> m_discardRight;
+        std::string m_errorString;
+    };
+
+} // namespace VideoCreator
+
+#endif // TIMELINE_AUDIO_MIXER_H
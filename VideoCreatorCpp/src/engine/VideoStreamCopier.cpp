@@ -0,0 +1,236 @@
+#include "VideoStreamCopier.h"
+
+namespace VideoCreator
+{
+
+    namespace
+    {
+        // Annex B 包中第一个 VCL NAL 的类型，没有 VCL NAL 时返回 -1
+        int firstVclNalType(const AVPacket *packet, bool hevc)
+        {
+            const uint8_t *data = packet->data;
+            const int size = packet->size;
+            for (int i = 0; i + 3 < size; ++i) {
+                if (data[i] != 0 || data[i + 1] != 0 || data[i + 2] != 1) {
+                    continue;
+                }
+                const uint8_t header = data[i + 3];
+                const int type = hevc ? (header >> 1) & 0x3f : header & 0x1f;
+                if (hevc ? type < 32 : (type >= 1 && type <= 5)) {
+                    return type;
+                }
+                i += 2;
+            }
+            return -1;
+        }
+
+        // 复制的第一个画面必须不依赖素材中更早的帧：H.264 为 IDR；
+        // HEVC 为 IDR 或 BLA_N_LP，CRA/其余 BLA 之后可能跟着引用更早帧的 RASL 前导画面
+        bool startsWithIdr(const AVPacket *packet, bool hevc)
+        {
+            if (!(packet->flags & AV_PKT_FLAG_KEY)) {
+                return false;
+            }
+            const int type = firstVclNalType(packet, hevc);
+            if (hevc) {
+                return type == 18 || type == 19 || type == 20; // BLA_N_LP, IDR_W_RADL, IDR_N_LP
+            }
+            return type == 5;
+        }
+    } // namespace
+
+    VideoStreamCopier::~VideoStreamCopier()
+    {
+        cleanup();
+    }
+
+    bool VideoStreamCopier::open(const std::string &filePath, const AVCodecContext *encoder, int fps)
+    {
+        cleanup();
+        if (avformat_open_input(&m_formatContext, filePath.c_str(), nullptr, nullptr) < 0) {
+            m_errorString = "Cannot open video: " + filePath;
+            return false;
+        }
+        if (avformat_find_stream_info(m_formatContext, nullptr) < 0) {
+            m_errorString = "Cannot read stream info: " + filePath;
+            cleanup();
+            return false;
+        }
+        m_streamIndex = av_find_best_stream(m_formatContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (m_streamIndex < 0) {
+            m_errorString = "No video stream: " + filePath;
+            cleanup();
+            return false;
+        }
+
+        AVStream *stream = m_formatContext->streams[m_streamIndex];
+        if (!checkCompatibility(stream, encoder, fps)) {
+            cleanup();
+            return false;
+        }
+
+        // 源为 MP4/MKV 时包是长度前缀格式且参数集在 extradata 中，转成每个 IDR 前带参数集的 Annex B
+        const char *filterName = stream->codecpar->codec_id == AV_CODEC_ID_HEVC ? "hevc_mp4toannexb" : "h264_mp4toannexb";
+        const AVBitStreamFilter *filter = av_bsf_get_by_name(filterName);
+        if (!filter || av_bsf_alloc(filter, &m_bsfContext) < 0) {
+            m_errorString = std::string("Bitstream filter unavailable: ") + filterName;
+            cleanup();
+            return false;
+        }
+        avcodec_parameters_copy(m_bsfContext->par_in, stream->codecpar);
+        m_bsfContext->time_base_in = stream->time_base;
+        if (av_bsf_init(m_bsfContext) < 0) {
+            m_errorString = std::string("Failed to initialize ") + filterName;
+            cleanup();
+            return false;
+        }
+
+        m_timeBase = stream->time_base;
+        m_startPts = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : AV_NOPTS_VALUE;
+        if (stream->duration != AV_NOPTS_VALUE) {
+            m_duration = stream->duration * av_q2d(stream->time_base);
+        } else if (m_formatContext->duration != AV_NOPTS_VALUE) {
+            m_duration = static_cast<double>(m_formatContext->duration) / AV_TIME_BASE;
+        }
+        m_inputFinished = false;
+
+        // 预读首包：必须是可独立解码的 IDR；其 PTS 与 DTS 之差是素材的 B 帧重排延迟。拼接时整段 DTS 对齐到编码器的延迟，
+        // 素材延迟更大时 DTS 只能前移到 PTS 之后，不能直接复制
+        auto firstPacket = FFmpegUtils::createAvPacket();
+        if (!firstPacket || readPacket(firstPacket.get()) <= 0) {
+            m_errorString = "No video packets: " + filePath;
+            cleanup();
+            return false;
+        }
+        if (!startsWithIdr(firstPacket.get(), stream->codecpar->codec_id == AV_CODEC_ID_HEVC)) {
+            m_errorString = "first packet is not an IDR picture";
+            cleanup();
+            return false;
+        }
+        int64_t leadingDelay = 0;
+        if (firstPacket->pts != AV_NOPTS_VALUE && firstPacket->dts != AV_NOPTS_VALUE) {
+            leadingDelay = firstPacket->pts - firstPacket->dts;
+        }
+        if (leadingDelay > av_rescale_q(encoder->has_b_frames, AVRational{1, fps}, m_timeBase)) {
+            m_errorString = "B-frame reorder delay exceeds the output encoder's";
+            cleanup();
+            return false;
+        }
+        m_firstPacket = std::move(firstPacket);
+        return true;
+    }
+
+    bool VideoStreamCopier::checkCompatibility(AVStream *stream, const AVCodecContext *encoder, int fps)
+    {
+        const AVCodecParameters *par = stream->codecpar;
+        if (par->codec_id != AV_CODEC_ID_H264 && par->codec_id != AV_CODEC_ID_HEVC) {
+            m_errorString = "codec is not H.264/HEVC";
+            return false;
+        }
+        if (par->codec_id != encoder->codec_id) {
+            m_errorString = "codec differs from the output encoder";
+            return false;
+        }
+        if (par->width != encoder->width || par->height != encoder->height) {
+            m_errorString = "resolution differs from the project";
+            return false;
+        }
+        if (par->format != encoder->pix_fmt) {
+            m_errorString = "pixel format differs from the project";
+            return false;
+        }
+        // 输出统一标记为 limited range，全范围素材复制后颜色会被错误解释
+        if (par->color_range == AVCOL_RANGE_JPEG) {
+            m_errorString = "full-range source";
+            return false;
+        }
+        if (par->field_order != AV_FIELD_UNKNOWN && par->field_order != AV_FIELD_PROGRESSIVE) {
+            m_errorString = "interlaced source";
+            return false;
+        }
+
+        // 每个包计为输出时间线上的一帧，只接受与工程帧率一致的恒定帧率素材
+        const AVRational projectRate{fps, 1};
+        AVRational guessed = av_guess_frame_rate(m_formatContext, stream, nullptr);
+        if (guessed.num <= 0 || guessed.den <= 0 || av_cmp_q(guessed, projectRate) != 0) {
+            m_errorString = "frame rate differs from the project";
+            return false;
+        }
+        if (stream->avg_frame_rate.num > 0 && stream->avg_frame_rate.den > 0 && av_cmp_q(stream->avg_frame_rate, projectRate) != 0) {
+            m_errorString = "variable frame rate source";
+            return false;
+        }
+        return true;
+    }
+
+    int VideoStreamCopier::readPacket(AVPacket *packet)
+    {
+        if (!m_formatContext || !m_bsfContext) {
+            m_errorString = "Stream copier is not open";
+            return -1;
+        }
+
+        if (m_firstPacket) {
+            av_packet_move_ref(packet, m_firstPacket.get());
+            m_firstPacket.reset();
+            return 1;
+        }
+
+        while (true) {
+            int ret = av_bsf_receive_packet(m_bsfContext, packet);
+            if (ret == 0) {
+                if (packet->pts == AV_NOPTS_VALUE) {
+                    packet->pts = packet->dts;
+                }
+                if (m_startPts == AV_NOPTS_VALUE) {
+                    m_startPts = packet->pts != AV_NOPTS_VALUE ? packet->pts : 0;
+                }
+                return 1;
+            }
+            if (ret == AVERROR_EOF) {
+                return 0;
+            }
+            if (ret != AVERROR(EAGAIN)) {
+                m_errorString = "Bitstream filter failed";
+                return -1;
+            }
+            if (m_inputFinished) {
+                return 0;
+            }
+
+            ret = av_read_frame(m_formatContext, packet);
+            if (ret < 0) {
+                // 读到结尾后冲洗比特流过滤器
+                m_inputFinished = true;
+                av_bsf_send_packet(m_bsfContext, nullptr);
+                continue;
+            }
+            if (packet->stream_index != m_streamIndex) {
+                av_packet_unref(packet);
+                continue;
+            }
+            ret = av_bsf_send_packet(m_bsfContext, packet);
+            av_packet_unref(packet);
+            if (ret < 0) {
+                m_errorString = "Failed to send packet to bitstream filter";
+                return -1;
+            }
+        }
+    }
+
+    void VideoStreamCopier::cleanup()
+    {
+        m_firstPacket.reset();
+        if (m_bsfContext) {
+            av_bsf_free(&m_bsfContext);
+        }
+        if (m_formatContext) {
+            avformat_close_input(&m_formatContext);
+        }
+        m_streamIndex = -1;
+        m_startPts = 0;
+        m_duration = 0.0;
+        m_inputFinished = false;
+    }
+
+} // namespace VideoCreator
@@ -0,0 +1,56 @@
+#ifndef VIDEO_STREAM_COPIER_H
+#define VIDEO_STREAM_COPIER_H
+
+#include <string>
+#include "ffmpeg_utils/FFmpegHeaders.h"
+#include "ffmpeg_utils/AvPacketWrapper.h"
+
+extern "C" {
+#include <libavcodec/bsf.h>
+}
+
+namespace VideoCreator
+{
+
+    // 智能渲染：与输出编码参数一致的视频素材不解码、不缩放、不重新编码，压缩包直接复制到输出
+    // 包经 *_mp4toannexb 转成带内参数集的 Annex B；输出轨为 avc3/hev1 样本描述，解码器在 IDR 处切换到素材的参数集
+    class VideoStreamCopier
+    {
+    public:
+        VideoStreamCopier() = default;
+        ~VideoStreamCopier();
+
+        VideoStreamCopier(const VideoStreamCopier &) = delete;
+        VideoStreamCopier &operator=(const VideoStreamCopier &) = delete;
+
+        // 打开素材并检查编码格式、分辨率、帧率、像素格式与 encoder 一致，首包为 IDR，B 帧延迟不超过 encoder
+        // 返回 false 时 errorString 给出不能直接复制的原因，调用方回退到解码重编码
+        bool open(const std::string &filePath, const AVCodecContext *encoder, int fps);
+
+        // 读取下一个视频包（源时间基）；返回 1 成功，0 结束，-1 失败
+        int readPacket(AVPacket *packet);
+
+        AVRational timeBase() const { return m_timeBase; }
+        // 首帧的显示时间戳，复制时以此为零点重新定位到输出时间线
+        int64_t startPts() const { return m_startPts; }
+        double duration() const { return m_duration; }
+        std::string errorString() const { return m_errorString; }
+
+    private:
+        bool checkCompatibility(AVStream *stream, const AVCodecContext *encoder, int fps);
+        void cleanup();
+
+        AVFormatContext *m_formatContext = nullptr;
+        AVBSFContext *m_bsfContext = nullptr;
+        FFmpegUtils::AvPacketPtr m_firstPacket; // open 时预读的首包，readPacket 先返回它
+        int m_streamIndex = -1;
+        AVRational m_timeBase{1, 1};
+        int64_t m_startPts = 0;
+        double m_duration = 0.0;
+        bool m_inputFinished = false;
+        std::string m_errorString;
+    };
+
+} // namespace VideoCreator
+
+#endif // VIDEO_STREAM_COPIER_H
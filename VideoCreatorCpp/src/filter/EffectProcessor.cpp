@@ -31,7 +31,7 @@ namespace VideoCreator
         return true;
     }
 
-    bool EffectProcessor::startKenBurnsSequence(const KenBurnsEffect& effect, const AVFrame* inputImage, int total_frames)
+    bool EffectProcessor::startKenBurnsSequence(const KenBurnsEffect& effect, const AVFrame* inputImage, int total_frames, int first_frame)
     {
         resetSequenceState();
         if (!effect.enabled) {
@@ -46,6 +46,14 @@ namespace VideoCreator
             m_errorString = "Ken Burns total frames must be positive.";
             return false;
         }
+        if (first_frame < 0 || first_frame >= total_frames) {
+            m_errorString = "Ken Burns first frame is out of range.";
+            return false;
+        }
+
+        // zoompan 的表达式只依赖输出帧序号 on，从中途开始时把 on 平移 first_frame，结果与完整序列的对应帧一致
+        const std::string on = first_frame > 0 ? "(on+" + std::to_string(first_frame) + ")" : std::string("on");
+        const int frames = total_frames - first_frame;
 
         KenBurnsEffect params = effect;
         std::stringstream ss;
@@ -57,12 +65,12 @@ namespace VideoCreator
             double end_z = (params.preset == "zoom_in") ? 1.2 : 1.0;
 
             std::stringstream zoom_ss;
-            zoom_ss << std::fixed << std::setprecision(10) << start_z << "+(" << (end_z - start_z) << ")*on/" << total_frames;
+            zoom_ss << std::fixed << std::setprecision(10) << start_z << "+(" << (end_z - start_z) << ")*" << on << "/" << total_frames;
             std::string zoom_expr = zoom_ss.str();
 
             ss << "zoompan="
                << "z='" << zoom_expr << "':"
-               << "d=" << total_frames << ":s=" << m_width << "x" << m_height << ":fps=" << m_fps;
+               << "d=" << frames << ":s=" << m_width << "x" << m_height << ":fps=" << m_fps;
         }
         else if (params.preset == "pan_right" || params.preset == "pan_left")
         {
@@ -80,17 +88,17 @@ namespace VideoCreator
 
             ss << "zoompan="
                << "z='" << pan_scale << "':"
-               << "x='" << start_x << "+(" << end_x - start_x << ")*on/" << total_frames << "':"
+               << "x='" << start_x << "+(" << end_x - start_x << ")*" << on << "/" << total_frames << "':"
                << "y='" << start_y << "':"
-               << "d=" << total_frames << ":s=" << m_width << "x" << m_height << ":fps=" << m_fps;
+               << "d=" << frames << ":s=" << m_width << "x" << m_height << ":fps=" << m_fps;
         }
         else
         {
             ss << "zoompan="
-               << "z='" << params.start_scale << "+(" << params.end_scale - params.start_scale << ")*on/" << total_frames << "':"
-               << "x='" << params.start_x << "+(" << params.end_x - params.start_x << ")*on/" << total_frames << "':"
-               << "y='" << params.start_y << "+(" << params.end_y - params.start_y << ")*on/" << total_frames << "':"
-               << "d=" << total_frames << ":s=" << m_width << "x" << m_height << ":fps=" << m_fps;
+               << "z='" << params.start_scale << "+(" << params.end_scale - params.start_scale << ")*" << on << "/" << total_frames << "':"
+               << "x='" << params.start_x << "+(" << params.end_x - params.start_x << ")*" << on << "/" << total_frames << "':"
+               << "y='" << params.start_y << "+(" << params.end_y - params.start_y << ")*" << on << "/" << total_frames << "':"
+               << "d=" << frames << ":s=" << m_width << "x" << m_height << ":fps=" << m_fps;
         }
 
         if (!initFilterGraph(ss.str())) {
@@ -117,7 +125,7 @@ namespace VideoCreator
         }
 
         m_sequenceType = SequenceType::KenBurns;
-        m_expectedFrames = total_frames;
+        m_expectedFrames = frames;
         m_generatedFrames = 0;
         return true;
     }
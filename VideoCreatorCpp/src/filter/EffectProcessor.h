@@ -18,7 +18,8 @@ namespace VideoCreator
         bool initialize(int width, int height, AVPixelFormat format, int fps);
 
         // Ken Burns streaming helpers
-        bool startKenBurnsSequence(const KenBurnsEffect& effect, const AVFrame* inputImage, int total_frames);
+        // first_frame > 0 时从完整序列的第 first_frame 帧开始输出（随机访问与取末帧时无需生成前面的帧）
+        bool startKenBurnsSequence(const KenBurnsEffect& effect, const AVFrame* inputImage, int total_frames, int first_frame = 0);
         bool fetchKenBurnsFrame(FFmpegUtils::AvFramePtr &outFrame);
 
         // Transition streaming helpers
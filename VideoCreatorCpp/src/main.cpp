@@ -1,9 +1,17 @@
 #include <QCoreApplication>
 #include <QDebug>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <future>
 #include <string>
 #include "model/ProjectConfig.h"
 #include "model/ConfigLoader.h"
 #include "engine/RenderEngine.h"
+#include "engine/RenderFarm.h"
+#include "engine/RenderDaemon.h"
+#include "engine/MemoryEstimate.h"
+#include "engine/PreviewPlayer.h"
 #include "ffmpeg_utils/FFmpegHeaders.h"
 
 // 使用命名空间
@@ -171,6 +179,235 @@ int main(int argc, char *argv[])
     app.setApplicationName("VideoCreatorCpp");
     app.setApplicationVersion("1.0");
 
+    // 编译模式：VideoCreatorCpp --compile <project.json> <project.vcproj>
+    const QStringList args = app.arguments();
+    if (args.size() >= 4 && args.at(1) == "--compile")
+    {
+        avformat_network_init();
+        ConfigLoader loader;
+        ProjectConfig config;
+        if (!loader.loadFromFile(args.at(2), config))
+        {
+            qDebug() << "配置文件加载失败:" << loader.errorString();
+            return 1;
+        }
+        if (!loader.compileToFile(config, args.at(3)))
+        {
+            qDebug() << "编译工程失败:" << loader.errorString();
+            return 1;
+        }
+        qDebug() << "编译工程已写入:" << args.at(3);
+        return 0;
+    }
+
+    // 估算峰值内存：VideoCreatorCpp --estimate-memory <project>
+    if (args.size() >= 3 && args.at(1) == "--estimate-memory")
+    {
+        ConfigLoader loader;
+        ProjectConfig config;
+        if (!loader.loadFromFile(args.at(2), config))
+        {
+            qDebug() << "配置文件加载失败:" << loader.errorString();
+            return 1;
+        }
+        const MemoryEstimate estimate = MemoryEstimate::fromConfig(config);
+        const double mb = 1024.0 * 1024.0;
+        qDebug() << "预计峰值内存:" << estimate.total() / mb << "MB";
+        qDebug() << "  固定开销:" << estimate.base / mb << "MB";
+        qDebug() << "  视频编码器:" << estimate.encoder / mb << "MB";
+        qDebug() << "  场景帧队列与特效:" << estimate.videoPipeline / mb << "MB";
+        qDebug() << "  视频首帧预取:" << estimate.prefetch / mb << "MB";
+        qDebug() << "  场景首末帧缓存:" << estimate.sceneFrames / mb << "MB";
+        qDebug() << "  音频缓冲:" << estimate.audio / mb << "MB";
+        qDebug() << "  额外输出档位:" << estimate.renditions / mb << "MB";
+        return 0;
+    }
+
+    // 实时预览（无界面）：VideoCreatorCpp --preview <project> [--from S]
+    // 按实时速度播放到结尾，丢弃画面与音频，报告交付与跳过的帧数，用于检查工程能否实时预览
+    if (args.size() >= 3 && args.at(1) == "--preview")
+    {
+        avformat_network_init();
+        double from = 0.0;
+        for (int i = 3; i < args.size(); ++i)
+        {
+            if (args.at(i) == "--from" && i + 1 < args.size())
+            {
+                from = std::max(0.0, args.at(++i).toDouble());
+            }
+        }
+        ConfigLoader loader;
+        ProjectConfig config;
+        if (!loader.loadFromFile(args.at(2), config))
+        {
+            qDebug() << "配置文件加载失败:" << loader.errorString();
+            return 1;
+        }
+
+        std::atomic<int64_t> audioSamples{0};
+        std::promise<bool> finished;
+        std::atomic<bool> finishedSet{false};
+        PreviewPlayer player;
+        player.setOutputFormat(FrameRenderer::OutputFormat::YUV420P);
+        player.setAudioCallback([&](const float *, const float *, int samples, double) { audioSamples += samples; });
+        player.setFinishedCallback([&](bool ok) {
+            if (!finishedSet.exchange(true))
+            {
+                finished.set_value(ok);
+            }
+        });
+        if (!player.open(config))
+        {
+            qDebug() << "预览打开失败:" << QString::fromStdString(player.errorString());
+            return 1;
+        }
+        player.seek(from);
+        player.play();
+        const bool ok = finished.get_future().get();
+        player.close();
+        if (!ok)
+        {
+            qDebug() << "预览失败:" << QString::fromStdString(player.errorString());
+            return 1;
+        }
+        const int sampleRate = config.project.sample_rate > 0 ? config.project.sample_rate : 44100;
+        qDebug() << "预览结束: 交付" << player.presentedFrames() << "帧, 跳过" << player.droppedFrames() << "帧, 音频"
+                 << static_cast<double>(audioSamples.load()) / sampleRate << "秒";
+        return 0;
+    }
+
+    // 常驻渲染服务：VideoCreatorCpp --daemon <socket> [--image-cache-mb N] [--max-jobs N] [--memory-budget-mb N]
+    if (args.size() >= 3 && args.at(1) == "--daemon")
+    {
+        avformat_network_init();
+        int imageCacheMb = 256;
+        int maxJobs = 1;
+        int memoryBudgetMb = 0;
+        for (int i = 3; i < args.size(); ++i)
+        {
+            if (args.at(i) == "--image-cache-mb" && i + 1 < args.size())
+            {
+                imageCacheMb = std::max(0, args.at(++i).toInt());
+            }
+            else if (args.at(i) == "--max-jobs" && i + 1 < args.size())
+            {
+                maxJobs = std::max(1, args.at(++i).toInt());
+            }
+            else if (args.at(i) == "--memory-budget-mb" && i + 1 < args.size())
+            {
+                memoryBudgetMb = std::max(0, args.at(++i).toInt());
+            }
+        }
+        RenderDaemon daemon;
+        daemon.setImageCacheCapacity(static_cast<size_t>(imageCacheMb) * 1024 * 1024);
+        daemon.setMaxConcurrentJobs(maxJobs);
+        daemon.setMemoryBudget(static_cast<int64_t>(memoryBudgetMb) * 1024 * 1024);
+        if (!daemon.listen(args.at(2)))
+        {
+            qDebug() << "渲染服务启动失败:" << QString::fromStdString(daemon.errorString());
+            return 1;
+        }
+        return app.exec();
+    }
+
+    // 分块渲染协调者：VideoCreatorCpp --farm <project> [--workers N] [--launcher "<cmd>"]... [--segment-seconds S] [--resume] [--memory-budget-mb N]
+    if (args.size() >= 3 && args.at(1) == "--farm")
+    {
+        avformat_network_init();
+        // 每个工作进程的 libx264 最多使用 8 个线程，默认按硬件线程数的 1/4 启动工作进程
+        int workers = std::max(2, QThread::idealThreadCount() / 4);
+        double segmentSeconds = 0.0;
+        bool resume = false;
+        int memoryBudgetMb = 0;
+        QStringList launchers;
+        for (int i = 3; i < args.size(); ++i)
+        {
+            if (args.at(i) == "--workers" && i + 1 < args.size())
+            {
+                workers = args.at(++i).toInt();
+            }
+            else if (args.at(i) == "--launcher" && i + 1 < args.size())
+            {
+                launchers.push_back(args.at(++i));
+            }
+            else if (args.at(i) == "--segment-seconds" && i + 1 < args.size())
+            {
+                segmentSeconds = args.at(++i).toDouble();
+            }
+            else if (args.at(i) == "--resume")
+            {
+                resume = true;
+            }
+            else if (args.at(i) == "--memory-budget-mb" && i + 1 < args.size())
+            {
+                memoryBudgetMb = std::max(0, args.at(++i).toInt());
+            }
+        }
+        RenderFarm farm;
+        farm.setWorkerCount(workers);
+        farm.setLaunchers(launchers);
+        farm.setSegmentDuration(segmentSeconds);
+        farm.setResume(resume);
+        farm.setMemoryBudget(static_cast<int64_t>(memoryBudgetMb) * 1024 * 1024);
+        if (!farm.run(args.at(2), QCoreApplication::applicationFilePath()))
+        {
+            qDebug() << "分块渲染失败:" << QString::fromStdString(farm.errorString());
+            qDebug() << "已完成的分块保留在工作目录中，可加 --resume 继续";
+            return 1;
+        }
+        qDebug() << "分块渲染完成";
+        return 0;
+    }
+
+    // 分块渲染工作进程：VideoCreatorCpp --worker <project> (--scenes <begin> <end> | --audio) --output <file>
+    if (args.size() >= 3 && args.at(1) == "--worker")
+    {
+        avformat_network_init();
+        bool audioOnly = false;
+        int beginScene = -1;
+        int endScene = -1;
+        QString outputPath;
+        for (int i = 3; i < args.size(); ++i)
+        {
+            if (args.at(i) == "--audio")
+            {
+                audioOnly = true;
+            }
+            else if (args.at(i) == "--scenes" && i + 2 < args.size())
+            {
+                beginScene = args.at(++i).toInt();
+                endScene = args.at(++i).toInt();
+            }
+            else if (args.at(i) == "--output" && i + 1 < args.size())
+            {
+                outputPath = args.at(++i);
+            }
+        }
+        if (outputPath.isEmpty() || (!audioOnly && (beginScene < 0 || endScene <= beginScene)))
+        {
+            qDebug() << "工作进程参数无效";
+            return 1;
+        }
+
+        ConfigLoader loader;
+        ProjectConfig config;
+        if (!loader.loadFromFile(args.at(2), config))
+        {
+            qDebug() << "配置文件加载失败:" << loader.errorString();
+            return 1;
+        }
+        std::string error;
+        const bool ok = audioOnly
+                            ? RenderFarm::renderAudioTrack(config, outputPath.toStdString(), &error)
+                            : RenderFarm::renderVideoChunk(config, static_cast<size_t>(beginScene), static_cast<size_t>(endScene), outputPath.toStdString(), &error);
+        if (!ok)
+        {
+            qDebug() << "工作进程渲染失败:" << QString::fromStdString(error);
+            return 1;
+        }
+        return 0;
+    }
+
     VideoCreatorDemo demo;
     demo.runDemo();
 
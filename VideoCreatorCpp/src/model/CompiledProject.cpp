@@ -0,0 +1,656 @@
+#include "CompiledProject.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QDebug>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace VideoCreator
+{
+    namespace
+    {
+        constexpr char kMagic[8] = {'V', 'C', 'P', 'R', 'O', 'J', '\0', '\1'};
+        constexpr uint32_t kFormatVersion = 9;
+        constexpr uint32_t kByteOrderMark = 0x01020304;
+
+        // 所有记录均为定长 POD，写入前整体清零以保证填充字节确定
+        struct StringRef
+        {
+            uint32_t offset;
+            uint32_t length;
+        };
+
+        struct FileHeader
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t byte_order;
+            uint64_t project_offset;
+            uint64_t scene_offset;
+            uint64_t scene_count;
+            uint64_t layer_offset;
+            uint64_t layer_count;
+            uint64_t probe_offset;
+            uint64_t probe_count;
+            uint64_t track_offset;
+            uint64_t track_count;
+            uint64_t rendition_offset;
+            uint64_t rendition_count;
+            uint64_t string_offset;
+            uint64_t string_bytes;
+        };
+
+        struct DuckingRecord
+        {
+            uint8_t enabled;
+            double amount_db;
+            double threshold_db;
+            double attack;
+            double release;
+        };
+
+        struct AudioRecord
+        {
+            StringRef path;
+            double volume;
+            double start_offset;
+            DuckingRecord ducking;
+        };
+
+        struct AudioTrackRecord
+        {
+            StringRef path;
+            double start;
+            double end;
+            double source_offset;
+            double volume;
+            double fade_in;
+            double fade_out;
+            DuckingRecord ducking;
+        };
+
+        struct RenditionRecord
+        {
+            StringRef output_path;
+            int32_t width;
+            int32_t height;
+            StringRef bitrate;
+            int32_t crf;
+        };
+
+        struct ProjectRecord
+        {
+            StringRef name;
+            StringRef output_path;
+            StringRef background_color;
+            int32_t width;
+            int32_t height;
+            int32_t fps;
+            int32_t sample_rate;
+            uint8_t normalization_enabled;
+            double normalization_target_level;
+            StringRef video_codec;
+            StringRef video_bitrate;
+            StringRef video_preset;
+            int32_t video_crf;
+            StringRef audio_codec;
+            StringRef audio_bitrate;
+            int32_t audio_channels;
+            StringRef output_mode;
+            StringRef segment_type;
+            double fragment_duration;
+            double segment_duration;
+            uint8_t align_to_scenes;
+            uint8_t audio_prerender;
+            uint8_t smart_render;
+            int32_t scale_threads;
+        };
+
+        struct SceneRecord
+        {
+            int32_t id;
+            int32_t type;
+            int32_t transition_type;
+            int32_t from_scene;
+            int32_t to_scene;
+            uint8_t audio_crossfade;
+            double duration;
+
+            StringRef image_path;
+            int32_t image_x;
+            int32_t image_y;
+            double image_scale;
+            double image_rotation;
+
+            AudioRecord audio;
+
+            StringRef video_path;
+            double video_trim_start;
+            double video_trim_end;
+            uint8_t video_use_audio;
+
+            uint32_t layer_begin;
+            uint32_t layer_count;
+
+            uint8_t ken_burns_enabled;
+            StringRef ken_burns_preset;
+            double ken_burns_start_scale;
+            double ken_burns_end_scale;
+            int32_t ken_burns_start_x;
+            int32_t ken_burns_start_y;
+            int32_t ken_burns_end_x;
+            int32_t ken_burns_end_y;
+
+            uint8_t volume_mix_enabled;
+            double volume_mix_fade_in;
+            double volume_mix_fade_out;
+        };
+
+        struct ProbeRecord
+        {
+            StringRef path;
+            uint32_t is_video;
+            double duration;
+        };
+
+        static_assert(std::is_trivially_copyable<ProjectRecord>::value, "ProjectRecord must be POD");
+        static_assert(std::is_trivially_copyable<SceneRecord>::value, "SceneRecord must be POD");
+
+        template <typename T>
+        T zeroed()
+        {
+            T value;
+            std::memset(&value, 0, sizeof(T));
+            return value;
+        }
+
+        template <typename T>
+        void appendRecords(QByteArray &out, const std::vector<T> &records)
+        {
+            if (!records.empty())
+            {
+                out.append(reinterpret_cast<const char *>(records.data()), static_cast<qsizetype>(records.size() * sizeof(T)));
+            }
+        }
+
+        void alignTo8(QByteArray &out)
+        {
+            while (out.size() % 8 != 0)
+            {
+                out.append('\0');
+            }
+        }
+
+        // 去重字符串表
+        class StringTable
+        {
+        public:
+            StringRef intern(const std::string &value)
+            {
+                auto it = m_offsets.find(value);
+                if (it != m_offsets.end())
+                {
+                    return {it->second, static_cast<uint32_t>(value.size())};
+                }
+                const uint32_t offset = static_cast<uint32_t>(m_data.size());
+                m_data.insert(m_data.end(), value.begin(), value.end());
+                m_offsets.emplace(value, offset);
+                return {offset, static_cast<uint32_t>(value.size())};
+            }
+
+            const std::vector<char> &data() const { return m_data; }
+
+        private:
+            std::vector<char> m_data;
+            std::unordered_map<std::string, uint32_t> m_offsets;
+        };
+
+        // 只读映射视图，所有偏移在访问前做边界检查
+        class MappedView
+        {
+        public:
+            MappedView(const uchar *data, qint64 size) : m_data(data), m_size(static_cast<uint64_t>(size)) {}
+
+            bool contains(uint64_t offset, uint64_t bytes) const
+            {
+                return offset <= m_size && bytes <= m_size - offset;
+            }
+
+            template <typename T>
+            const T *records(uint64_t offset, uint64_t count) const
+            {
+                if (offset % alignof(T) != 0 || count > m_size / sizeof(T) || !contains(offset, count * sizeof(T)))
+                {
+                    return nullptr;
+                }
+                return reinterpret_cast<const T *>(m_data + offset);
+            }
+
+            const uchar *data() const { return m_data; }
+
+        private:
+            const uchar *m_data;
+            uint64_t m_size;
+        };
+
+        DuckingRecord makeDuckingRecord(const DuckingConfig &ducking)
+        {
+            DuckingRecord record = zeroed<DuckingRecord>();
+            record.enabled = ducking.enabled ? 1 : 0;
+            record.amount_db = ducking.amount_db;
+            record.threshold_db = ducking.threshold_db;
+            record.attack = ducking.attack;
+            record.release = ducking.release;
+            return record;
+        }
+
+        DuckingConfig toDuckingConfig(const DuckingRecord &record)
+        {
+            DuckingConfig ducking;
+            ducking.enabled = record.enabled != 0;
+            ducking.amount_db = record.amount_db;
+            ducking.threshold_db = record.threshold_db;
+            ducking.attack = record.attack;
+            ducking.release = record.release;
+            return ducking;
+        }
+
+        AudioRecord makeAudioRecord(const AudioConfig &audio, StringTable &strings)
+        {
+            AudioRecord record = zeroed<AudioRecord>();
+            record.path = strings.intern(audio.path);
+            record.volume = audio.volume;
+            record.start_offset = audio.start_offset;
+            record.ducking = makeDuckingRecord(audio.ducking);
+            return record;
+        }
+    } // namespace
+
+    bool CompiledProject::isCompiledProject(const QByteArray &header)
+    {
+        return header.size() >= static_cast<qsizetype>(sizeof(kMagic)) &&
+               std::memcmp(header.constData(), kMagic, sizeof(kMagic)) == 0;
+    }
+
+    bool CompiledProject::write(const ProjectConfig &config, const ProbeSnapshot &probes, const QString &filePath, QString *error)
+    {
+        StringTable strings;
+
+        ProjectRecord project = zeroed<ProjectRecord>();
+        project.name = strings.intern(config.project.name);
+        project.output_path = strings.intern(config.project.output_path);
+        project.background_color = strings.intern(config.project.background_color);
+        project.width = config.project.width;
+        project.height = config.project.height;
+        project.fps = config.project.fps;
+        project.sample_rate = config.project.sample_rate;
+        project.normalization_enabled = config.global_effects.audio_normalization.enabled ? 1 : 0;
+        project.normalization_target_level = config.global_effects.audio_normalization.target_level;
+        project.video_codec = strings.intern(config.global_effects.video_encoding.codec);
+        project.video_bitrate = strings.intern(config.global_effects.video_encoding.bitrate);
+        project.video_preset = strings.intern(config.global_effects.video_encoding.preset);
+        project.video_crf = config.global_effects.video_encoding.crf;
+        project.audio_codec = strings.intern(config.global_effects.audio_encoding.codec);
+        project.audio_bitrate = strings.intern(config.global_effects.audio_encoding.bitrate);
+        project.audio_channels = config.global_effects.audio_encoding.channels;
+        project.output_mode = strings.intern(config.output.mode);
+        project.segment_type = strings.intern(config.output.segment_type);
+        project.fragment_duration = config.output.fragment_duration;
+        project.segment_duration = config.output.segment_duration;
+        project.align_to_scenes = config.output.align_to_scenes ? 1 : 0;
+        project.audio_prerender = config.performance.audio_prerender ? 1 : 0;
+        project.smart_render = config.performance.smart_render ? 1 : 0;
+        project.scale_threads = config.performance.scale_threads;
+
+        std::vector<SceneRecord> scenes;
+        std::vector<AudioRecord> layers;
+        scenes.reserve(config.scenes.size());
+        for (const auto &scene : config.scenes)
+        {
+            SceneRecord record = zeroed<SceneRecord>();
+            record.id = scene.id;
+            record.type = static_cast<int32_t>(scene.type);
+            record.transition_type = static_cast<int32_t>(scene.transition_type);
+            record.from_scene = scene.from_scene;
+            record.to_scene = scene.to_scene;
+            record.audio_crossfade = scene.audio_crossfade ? 1 : 0;
+            record.duration = scene.duration;
+
+            record.image_path = strings.intern(scene.resources.image.path);
+            record.image_x = scene.resources.image.x;
+            record.image_y = scene.resources.image.y;
+            record.image_scale = scene.resources.image.scale;
+            record.image_rotation = scene.resources.image.rotation;
+
+            record.audio = makeAudioRecord(scene.resources.audio, strings);
+
+            record.video_path = strings.intern(scene.resources.video.path);
+            record.video_trim_start = scene.resources.video.trim_start;
+            record.video_trim_end = scene.resources.video.trim_end;
+            record.video_use_audio = scene.resources.video.use_audio ? 1 : 0;
+
+            record.layer_begin = static_cast<uint32_t>(layers.size());
+            record.layer_count = static_cast<uint32_t>(scene.resources.audio_layers.size());
+            for (const auto &layer : scene.resources.audio_layers)
+            {
+                layers.push_back(makeAudioRecord(layer, strings));
+            }
+
+            const auto &kenBurns = scene.effects.ken_burns;
+            record.ken_burns_enabled = kenBurns.enabled ? 1 : 0;
+            record.ken_burns_preset = strings.intern(kenBurns.preset);
+            record.ken_burns_start_scale = kenBurns.start_scale;
+            record.ken_burns_end_scale = kenBurns.end_scale;
+            record.ken_burns_start_x = kenBurns.start_x;
+            record.ken_burns_start_y = kenBurns.start_y;
+            record.ken_burns_end_x = kenBurns.end_x;
+            record.ken_burns_end_y = kenBurns.end_y;
+
+            record.volume_mix_enabled = scene.effects.volume_mix.enabled ? 1 : 0;
+            record.volume_mix_fade_in = scene.effects.volume_mix.fade_in;
+            record.volume_mix_fade_out = scene.effects.volume_mix.fade_out;
+            scenes.push_back(record);
+        }
+
+        std::vector<ProbeRecord> probeRecords;
+        probeRecords.reserve(probes.audio_durations.size() + probes.video_durations.size());
+        auto appendProbes = [&](const std::unordered_map<std::string, double> &durations, bool isVideo) {
+            for (const auto &entry : durations)
+            {
+                ProbeRecord record = zeroed<ProbeRecord>();
+                record.path = strings.intern(entry.first);
+                record.is_video = isVideo ? 1 : 0;
+                record.duration = entry.second;
+                probeRecords.push_back(record);
+            }
+        };
+        appendProbes(probes.audio_durations, false);
+        appendProbes(probes.video_durations, true);
+
+        std::vector<AudioTrackRecord> trackRecords;
+        trackRecords.reserve(config.audio_tracks.size());
+        for (const auto &track : config.audio_tracks)
+        {
+            AudioTrackRecord record = zeroed<AudioTrackRecord>();
+            record.path = strings.intern(track.path);
+            record.start = track.start;
+            record.end = track.end;
+            record.source_offset = track.source_offset;
+            record.volume = track.volume;
+            record.fade_in = track.fade_in;
+            record.fade_out = track.fade_out;
+            record.ducking = makeDuckingRecord(track.ducking);
+            trackRecords.push_back(record);
+        }
+
+        std::vector<RenditionRecord> renditionRecords;
+        renditionRecords.reserve(config.output.renditions.size());
+        for (const auto &rendition : config.output.renditions)
+        {
+            RenditionRecord record = zeroed<RenditionRecord>();
+            record.output_path = strings.intern(rendition.output_path);
+            record.width = rendition.width;
+            record.height = rendition.height;
+            record.bitrate = strings.intern(rendition.bitrate);
+            record.crf = rendition.crf;
+            renditionRecords.push_back(record);
+        }
+
+        FileHeader header = zeroed<FileHeader>();
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kFormatVersion;
+        header.byte_order = kByteOrderMark;
+
+        QByteArray out;
+        out.append(reinterpret_cast<const char *>(&header), sizeof(header));
+        alignTo8(out);
+
+        header.project_offset = static_cast<uint64_t>(out.size());
+        out.append(reinterpret_cast<const char *>(&project), sizeof(project));
+        alignTo8(out);
+
+        header.scene_offset = static_cast<uint64_t>(out.size());
+        header.scene_count = scenes.size();
+        appendRecords(out, scenes);
+        alignTo8(out);
+
+        header.layer_offset = static_cast<uint64_t>(out.size());
+        header.layer_count = layers.size();
+        appendRecords(out, layers);
+        alignTo8(out);
+
+        header.probe_offset = static_cast<uint64_t>(out.size());
+        header.probe_count = probeRecords.size();
+        appendRecords(out, probeRecords);
+        alignTo8(out);
+
+        header.track_offset = static_cast<uint64_t>(out.size());
+        header.track_count = trackRecords.size();
+        appendRecords(out, trackRecords);
+        alignTo8(out);
+
+        header.rendition_offset = static_cast<uint64_t>(out.size());
+        header.rendition_count = renditionRecords.size();
+        appendRecords(out, renditionRecords);
+        alignTo8(out);
+
+        header.string_offset = static_cast<uint64_t>(out.size());
+        header.string_bytes = strings.data().size();
+        if (!strings.data().empty())
+        {
+            out.append(strings.data().data(), static_cast<qsizetype>(strings.data().size()));
+        }
+
+        std::memcpy(out.data(), &header, sizeof(header));
+
+        QSaveFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly) || file.write(out) != out.size() || !file.commit())
+        {
+            if (error)
+            {
+                *error = QString("无法写入编译工程文件: %1").arg(filePath);
+            }
+            return false;
+        }
+        return true;
+    }
+
+    bool CompiledProject::load(const QString &filePath, ProjectConfig &config, ProbeSnapshot *probes, QString *error)
+    {
+        auto fail = [error](const QString &message) {
+            if (error)
+            {
+                *error = message;
+            }
+            return false;
+        };
+
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return fail(QString("无法打开编译工程文件: %1").arg(filePath));
+        }
+
+        const qint64 fileSize = file.size();
+        const uchar *mapped = file.map(0, fileSize);
+        if (!mapped)
+        {
+            return fail(QString("无法映射编译工程文件: %1").arg(filePath));
+        }
+        MappedView view(mapped, fileSize);
+
+        const FileHeader *header = view.records<FileHeader>(0, 1);
+        if (!header || std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0)
+        {
+            return fail("不是有效的编译工程文件");
+        }
+        if (header->version != kFormatVersion || header->byte_order != kByteOrderMark)
+        {
+            return fail("编译工程文件版本或字节序不匹配，请重新编译");
+        }
+
+        const ProjectRecord *project = view.records<ProjectRecord>(header->project_offset, 1);
+        const SceneRecord *scenes = view.records<SceneRecord>(header->scene_offset, header->scene_count);
+        const AudioRecord *layers = view.records<AudioRecord>(header->layer_offset, header->layer_count);
+        const ProbeRecord *probeRecords = view.records<ProbeRecord>(header->probe_offset, header->probe_count);
+        const AudioTrackRecord *tracks = view.records<AudioTrackRecord>(header->track_offset, header->track_count);
+        const RenditionRecord *renditions = view.records<RenditionRecord>(header->rendition_offset, header->rendition_count);
+        if (!project || !scenes || !layers || !probeRecords || !tracks || !renditions || !view.contains(header->string_offset, header->string_bytes))
+        {
+            return fail("编译工程文件已损坏");
+        }
+
+        const char *stringBase = reinterpret_cast<const char *>(view.data() + header->string_offset);
+        const uint64_t stringBytes = header->string_bytes;
+        bool stringsValid = true;
+        auto str = [&](const StringRef &ref) -> std::string {
+            if (static_cast<uint64_t>(ref.offset) + ref.length > stringBytes)
+            {
+                stringsValid = false;
+                return std::string();
+            }
+            return std::string(stringBase + ref.offset, ref.length);
+        };
+        auto toAudio = [&](const AudioRecord &record) {
+            AudioConfig audio;
+            audio.path = str(record.path);
+            audio.volume = record.volume;
+            audio.start_offset = record.start_offset;
+            audio.ducking = toDuckingConfig(record.ducking);
+            return audio;
+        };
+
+        ProjectConfig loaded;
+        loaded.project.name = str(project->name);
+        loaded.project.output_path = str(project->output_path);
+        loaded.project.background_color = str(project->background_color);
+        loaded.project.width = project->width;
+        loaded.project.height = project->height;
+        loaded.project.fps = project->fps;
+        loaded.project.sample_rate = project->sample_rate;
+        loaded.global_effects.audio_normalization.enabled = project->normalization_enabled != 0;
+        loaded.global_effects.audio_normalization.target_level = project->normalization_target_level;
+        loaded.global_effects.video_encoding.codec = str(project->video_codec);
+        loaded.global_effects.video_encoding.bitrate = str(project->video_bitrate);
+        loaded.global_effects.video_encoding.preset = str(project->video_preset);
+        loaded.global_effects.video_encoding.crf = project->video_crf;
+        loaded.global_effects.audio_encoding.codec = str(project->audio_codec);
+        loaded.global_effects.audio_encoding.bitrate = str(project->audio_bitrate);
+        loaded.global_effects.audio_encoding.channels = project->audio_channels;
+        loaded.output.mode = str(project->output_mode);
+        loaded.output.segment_type = str(project->segment_type);
+        loaded.output.fragment_duration = project->fragment_duration;
+        loaded.output.segment_duration = project->segment_duration;
+        loaded.output.align_to_scenes = project->align_to_scenes != 0;
+        loaded.performance.audio_prerender = project->audio_prerender != 0;
+        loaded.performance.smart_render = project->smart_render != 0;
+        loaded.performance.scale_threads = project->scale_threads;
+
+        loaded.scenes.resize(header->scene_count);
+        for (uint64_t i = 0; i < header->scene_count; ++i)
+        {
+            const SceneRecord &record = scenes[i];
+            SceneConfig &scene = loaded.scenes[i];
+            // 枚举按整数写入，超出范围说明文件损坏或由不兼容的版本生成
+            if (record.type < 0 || record.type > static_cast<int32_t>(SceneType::TRANSITION) ||
+                record.transition_type < 0 || record.transition_type > static_cast<int32_t>(TransitionType::SLIDE))
+            {
+                return fail("编译工程文件已损坏");
+            }
+            scene.id = record.id;
+            scene.type = static_cast<SceneType>(record.type);
+            scene.transition_type = static_cast<TransitionType>(record.transition_type);
+            scene.from_scene = record.from_scene;
+            scene.to_scene = record.to_scene;
+            scene.audio_crossfade = record.audio_crossfade != 0;
+            scene.duration = record.duration;
+
+            scene.resources.image.path = str(record.image_path);
+            scene.resources.image.x = record.image_x;
+            scene.resources.image.y = record.image_y;
+            scene.resources.image.scale = record.image_scale;
+            scene.resources.image.rotation = record.image_rotation;
+
+            scene.resources.audio = toAudio(record.audio);
+
+            scene.resources.video.path = str(record.video_path);
+            scene.resources.video.trim_start = record.video_trim_start;
+            scene.resources.video.trim_end = record.video_trim_end;
+            scene.resources.video.use_audio = record.video_use_audio != 0;
+
+            if (static_cast<uint64_t>(record.layer_begin) + record.layer_count > header->layer_count)
+            {
+                return fail("编译工程文件已损坏");
+            }
+            scene.resources.audio_layers.reserve(record.layer_count);
+            for (uint32_t layer = 0; layer < record.layer_count; ++layer)
+            {
+                scene.resources.audio_layers.push_back(toAudio(layers[record.layer_begin + layer]));
+            }
+
+            auto &kenBurns = scene.effects.ken_burns;
+            kenBurns.enabled = record.ken_burns_enabled != 0;
+            kenBurns.preset = str(record.ken_burns_preset);
+            kenBurns.start_scale = record.ken_burns_start_scale;
+            kenBurns.end_scale = record.ken_burns_end_scale;
+            kenBurns.start_x = record.ken_burns_start_x;
+            kenBurns.start_y = record.ken_burns_start_y;
+            kenBurns.end_x = record.ken_burns_end_x;
+            kenBurns.end_y = record.ken_burns_end_y;
+
+            scene.effects.volume_mix.enabled = record.volume_mix_enabled != 0;
+            scene.effects.volume_mix.fade_in = record.volume_mix_fade_in;
+            scene.effects.volume_mix.fade_out = record.volume_mix_fade_out;
+        }
+
+        loaded.audio_tracks.resize(header->track_count);
+        for (uint64_t i = 0; i < header->track_count; ++i)
+        {
+            const AudioTrackRecord &record = tracks[i];
+            AudioTrackConfig &track = loaded.audio_tracks[i];
+            track.path = str(record.path);
+            track.start = record.start;
+            track.end = record.end;
+            track.source_offset = record.source_offset;
+            track.volume = record.volume;
+            track.fade_in = record.fade_in;
+            track.fade_out = record.fade_out;
+            track.ducking = toDuckingConfig(record.ducking);
+        }
+
+        loaded.output.renditions.resize(header->rendition_count);
+        for (uint64_t i = 0; i < header->rendition_count; ++i)
+        {
+            const RenditionRecord &record = renditions[i];
+            RenditionConfig &rendition = loaded.output.renditions[i];
+            rendition.output_path = str(record.output_path);
+            rendition.width = record.width;
+            rendition.height = record.height;
+            rendition.bitrate = str(record.bitrate);
+            rendition.crf = record.crf;
+        }
+
+        if (probes)
+        {
+            probes->audio_durations.clear();
+            probes->video_durations.clear();
+            for (uint64_t i = 0; i < header->probe_count; ++i)
+            {
+                const ProbeRecord &record = probeRecords[i];
+                auto &target = record.is_video ? probes->video_durations : probes->audio_durations;
+                target[str(record.path)] = record.duration;
+            }
+        }
+
+        if (!stringsValid)
+        {
+            return fail("编译工程文件已损坏");
+        }
+
+        config = std::move(loaded);
+        qDebug() << "已加载编译工程:" << filePath << "场景数:" << config.scenes.size();
+        return true;
+    }
+
+} // namespace VideoCreator
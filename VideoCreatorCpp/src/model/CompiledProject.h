@@ -0,0 +1,40 @@
+#ifndef COMPILED_PROJECT_H
+#define COMPILED_PROJECT_H
+
+#include <QString>
+#include <QByteArray>
+#include <string>
+#include <unordered_map>
+#include "ProjectConfig.h"
+
+namespace VideoCreator
+{
+
+    // 编译后的二进制工程格式
+    //
+    // 由 JSON 工程一次性生成，包含已推导的场景时长和媒体探测快照。
+    // 文件是定长记录 + 去重字符串表的平铺布局，加载时直接 mmap，
+    // 按偏移读取记录，不做任何文本解析。使用本机字节序，仅在同架构间通用。
+    class CompiledProject
+    {
+    public:
+        // 媒体时长探测快照（规范化路径 -> 秒）
+        struct ProbeSnapshot
+        {
+            std::unordered_map<std::string, double> audio_durations;
+            std::unordered_map<std::string, double> video_durations;
+        };
+
+        // 判断文件头是否为编译工程
+        static bool isCompiledProject(const QByteArray &header);
+
+        // 将已加载（时长已推导）的工程写为编译格式
+        static bool write(const ProjectConfig &config, const ProbeSnapshot &probes, const QString &filePath, QString *error = nullptr);
+
+        // 通过 mmap 加载编译工程
+        static bool load(const QString &filePath, ProjectConfig &config, ProbeSnapshot *probes = nullptr, QString *error = nullptr);
+    };
+
+} // namespace VideoCreator
+
+#endif // COMPILED_PROJECT_H
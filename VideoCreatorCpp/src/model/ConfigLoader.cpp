@@ -1,6 +1,13 @@
 #include "ConfigLoader.h"
+#include "CompiledProject.h"
+#include <QDateTime>
 #include <QDebug>
 #include <QProcess>
+#include <algorithm>
+#include <map>
+#include <atomic>
+#include <thread>
+#include <unordered_set>
 
 extern "C"
 {
@@ -10,6 +17,173 @@ extern "C"
 
 namespace VideoCreator
 {
+    namespace
+    {
+        // 快速探测只读取容器头部（MP4 moov、WAV 头、MP3 Xing/VBRI 等）
+        constexpr const char *kFastProbeSize = "65536";
+        constexpr const char *kFastAnalyzeDuration = "0";
+
+        // 文件大小与修改时间；网络地址等非本地文件为 (-1, -1)，始终视为未变化
+        std::pair<int64_t, int64_t> fileStamp(const std::string &path)
+        {
+            QFileInfo info(QString::fromStdString(path));
+            if (!info.exists())
+            {
+                return {-1, -1};
+            }
+            return {info.size(), info.lastModified().toMSecsSinceEpoch()};
+        }
+
+        const char *mediaTypeLabel(AVMediaType type)
+        {
+            return type == AVMEDIA_TYPE_VIDEO ? "video" : "audio";
+        }
+
+        void logProbeError(const char *message, AVMediaType type, const QString &path, int ret)
+        {
+            char errbuf[256];
+            av_strerror(ret, errbuf, sizeof(errbuf));
+            qDebug() << message << mediaTypeLabel(type) << "file:" << path;
+            qDebug() << "FFmpeg error:" << errbuf;
+        }
+
+        // 首个音频流的采样率；没有音频流时为 0（确定结果），有音频流但头部未给出采样率时为 -1
+        int readAudioSampleRate(const AVFormatContext *formatCtx)
+        {
+            for (unsigned int i = 0; i < formatCtx->nb_streams; i++)
+            {
+                const AVCodecParameters *codecpar = formatCtx->streams[i]->codecpar;
+                if (codecpar->codec_type == AVMEDIA_TYPE_AUDIO)
+                {
+                    return codecpar->sample_rate > 0 ? codecpar->sample_rate : -1;
+                }
+            }
+            return 0;
+        }
+
+        // 返回 type 类型首个流的时长（秒），优先使用容器时长；没有对应流时返回 -2
+        double readContainerDuration(const AVFormatContext *formatCtx, AVMediaType type)
+        {
+            const AVStream *stream = nullptr;
+            for (unsigned int i = 0; i < formatCtx->nb_streams; i++)
+            {
+                if (formatCtx->streams[i]->codecpar->codec_type == type)
+                {
+                    stream = formatCtx->streams[i];
+                    break;
+                }
+            }
+            if (!stream)
+            {
+                return -2.0;
+            }
+
+            double duration = 0.0;
+            if (formatCtx->duration != AV_NOPTS_VALUE && formatCtx->duration > 0)
+            {
+                duration = formatCtx->duration / (double)AV_TIME_BASE;
+            }
+            else if (stream->duration != AV_NOPTS_VALUE && stream->duration > 0)
+            {
+                duration = stream->duration * av_q2d(stream->time_base);
+            }
+            return duration > 0 ? duration : -1.0;
+        }
+
+        // 头部快速探测：不调用 avformat_find_stream_info，时长缺失时返回 -1 以便回退完整分析
+        double fastProbeDuration(const std::string &path, AVMediaType type, int *sampleRate)
+        {
+            AVDictionary *options = nullptr;
+            av_dict_set(&options, "probesize", kFastProbeSize, 0);
+            av_dict_set(&options, "analyzeduration", kFastAnalyzeDuration, 0);
+
+            AVFormatContext *formatCtx = nullptr;
+            int ret = avformat_open_input(&formatCtx, path.c_str(), nullptr, &options);
+            av_dict_free(&options);
+            if (ret < 0)
+            {
+                return -1.0;
+            }
+
+            // 某些封装（裸流、MPEG-TS 等）只能在分析数据包后才知道流类型和时长
+            double duration = readContainerDuration(formatCtx, type);
+            if (sampleRate)
+            {
+                *sampleRate = readAudioSampleRate(formatCtx);
+            }
+            avformat_close_input(&formatCtx);
+            return duration;
+        }
+
+        // 完整分析失败时仍采用头部时长，采样率按未知处理
+        double fallbackDuration(double fastDuration, int *sampleRate)
+        {
+            if (sampleRate && *sampleRate < 0)
+            {
+                *sampleRate = 0;
+            }
+            return fastDuration > 0 ? fastDuration : -1.0;
+        }
+    } // namespace
+
+    double ConfigLoader::probeMediaDuration(const std::string &path, AVMediaType type, int *sampleRate)
+    {
+        if (path.empty())
+        {
+            return -1.0;
+        }
+
+        QFileInfo info(QString::fromStdString(path));
+        QFile file(info.absoluteFilePath());
+        if (!file.exists())
+        {
+            qDebug() << "Media file not found (" << mediaTypeLabel(type) << "):" << info.absoluteFilePath();
+            return -1.0;
+        }
+
+        // 头部给出的时长总是采用；只有存在音频流而采样率未知时，才为采样率回退到完整分析
+        // 没有音频流的视频（sampleRate 为 0）不回退
+        const double fastDuration = fastProbeDuration(path, type, sampleRate);
+        if (fastDuration > 0 && (!sampleRate || *sampleRate >= 0))
+        {
+            return fastDuration;
+        }
+
+        // 回退到完整分析：avformat_find_stream_info 会读取并解码部分数据包来补全时长与采样率
+        AVFormatContext *formatCtx = nullptr;
+        int ret = avformat_open_input(&formatCtx, path.c_str(), nullptr, nullptr);
+        if (ret < 0)
+        {
+            logProbeError("Failed to open", type, info.absoluteFilePath(), ret);
+            return fallbackDuration(fastDuration, sampleRate);
+        }
+
+        ret = avformat_find_stream_info(formatCtx, nullptr);
+        if (ret < 0)
+        {
+            logProbeError("Failed to read stream info of", type, info.absoluteFilePath(), ret);
+            avformat_close_input(&formatCtx);
+            return fallbackDuration(fastDuration, sampleRate);
+        }
+
+        double duration = fastDuration > 0 ? fastDuration : readContainerDuration(formatCtx, type);
+        if (sampleRate)
+        {
+            *sampleRate = std::max(0, readAudioSampleRate(formatCtx));
+        }
+        if (duration == -2.0)
+        {
+            qDebug() << "No" << mediaTypeLabel(type) << "stream in file:" << info.absoluteFilePath();
+        }
+        else if (duration > 0 && formatCtx->duration_estimation_method == AVFMT_DURATION_FROM_BITRATE)
+        {
+            qDebug() << "Duration estimated from bitrate, may be inaccurate:" << info.absoluteFilePath();
+        }
+
+        avformat_close_input(&formatCtx);
+        return duration > 0 ? duration : -1.0;
+    }
+
 
     bool ConfigLoader::loadFromFile(const QString &filePath, ProjectConfig &config)
     {
@@ -20,16 +194,47 @@ namespace VideoCreator
             return false;
         }
 
+        // 编译工程通过 mmap 直接加载，跳过 JSON 解析和媒体探测
+        if (CompiledProject::isCompiledProject(file.peek(8)))
+        {
+            file.close();
+            CompiledProject::ProbeSnapshot probes;
+            if (!CompiledProject::load(filePath, config, &probes, &m_errorString))
+            {
+                return false;
+            }
+            m_audioDurationCache = std::move(probes.audio_durations);
+            m_videoDurationCache = std::move(probes.video_durations);
+            m_probeStamps.clear();
+            return true;
+        }
+
         QByteArray jsonData = file.readAll();
         file.close();
 
         return loadFromString(QString::fromUtf8(jsonData), config);
     }
 
+    bool ConfigLoader::compileToFile(const ProjectConfig &config, const QString &filePath)
+    {
+        CompiledProject::ProbeSnapshot probes;
+        probes.audio_durations = m_audioDurationCache;
+        probes.video_durations = m_videoDurationCache;
+        return CompiledProject::write(config, probes, filePath, &m_errorString);
+    }
+
     bool ConfigLoader::loadFromString(const QString &jsonString, ProjectConfig &config)
     {
-        m_audioDurationCache.clear();
-        m_videoDurationCache.clear();
+        if (m_retainProbeCache)
+        {
+            dropStaleProbes();
+        }
+        else
+        {
+            m_audioDurationCache.clear();
+            m_videoDurationCache.clear();
+            m_sampleRateCache.clear();
+        }
 
         QJsonParseError parseError;
         QJsonDocument doc = QJsonDocument::fromJson(jsonString.toUtf8(), &parseError);
@@ -63,6 +268,8 @@ namespace VideoCreator
             QJsonArray scenesArray = root["scenes"].toArray();
             config.scenes.clear();
 
+            // 第一阶段：只解析 JSON，记录需要由媒体时长推导 duration 的场景
+            std::vector<size_t> pendingDurationScenes;
             int sceneId = 1; // 从1开始分配场景ID
             for (const QJsonValue &sceneValue : scenesArray)
             {
@@ -70,8 +277,13 @@ namespace VideoCreator
                 {
                     SceneConfig scene;
                     scene.id = sceneId; // 自动分配场景ID
-                    if (parseSceneConfig(sceneValue.toObject(), scene))
+                    QJsonObject sceneObject = sceneValue.toObject();
+                    if (parseSceneConfig(sceneObject, scene))
                     {
+                        if (!(sceneObject.contains("duration") && sceneObject["duration"].isDouble()))
+                        {
+                            pendingDurationScenes.push_back(config.scenes.size());
+                        }
                         config.scenes.push_back(scene);
                         sceneId++;
                     }
@@ -81,6 +293,13 @@ namespace VideoCreator
                     }
                 }
             }
+
+            // 第二阶段：并行探测所有去重后的媒体文件；第三阶段：从缓存推导场景时长
+            prefetchMediaDurations(config.scenes, pendingDurationScenes);
+            for (size_t sceneIndex : pendingDurationScenes)
+            {
+                resolveSceneDuration(config.scenes[sceneIndex]);
+            }
         }
 
         // 解析全局效果配置
@@ -92,6 +311,49 @@ namespace VideoCreator
             }
         }
 
+        // 解析工程级音轨
+        if (root.contains("audio_tracks") && root["audio_tracks"].isArray())
+        {
+            config.audio_tracks.clear();
+            for (const QJsonValue &trackValue : root["audio_tracks"].toArray())
+            {
+                if (!trackValue.isObject())
+                {
+                    continue;
+                }
+                AudioTrackConfig track;
+                if (!parseAudioTrackConfig(trackValue.toObject(), track))
+                {
+                    return false;
+                }
+                config.audio_tracks.push_back(track);
+            }
+        }
+
+        // 解析输出容器配置
+        if (root.contains("output") && root["output"].isObject())
+        {
+            if (!parseOutputConfig(root["output"].toObject(), config.output))
+            {
+                return false;
+            }
+        }
+
+        // 解析渲染性能配置
+        if (root.contains("performance") && root["performance"].isObject())
+        {
+            if (!parsePerformanceConfig(root["performance"].toObject(), config.performance))
+            {
+                return false;
+            }
+        }
+
+        // 未指定输出采样率时取输入素材中占主导的采样率，避免对大多数素材重采样
+        if (config.project.sample_rate <= 0)
+        {
+            config.project.sample_rate = resolveDominantSampleRate(config);
+        }
+
         return true;
     }
 
@@ -127,6 +389,16 @@ namespace VideoCreator
             project.background_color = json["background_color"].toString().toUtf8().toStdString();
         }
 
+        if (json.contains("sample_rate") && json["sample_rate"].isDouble())
+        {
+            project.sample_rate = json["sample_rate"].toInt();
+            if (project.sample_rate < 0)
+            {
+                m_errorString = "sample_rate 不能为负数";
+                return false;
+            }
+        }
+
         return true;
     }
 
@@ -176,93 +448,99 @@ namespace VideoCreator
             scene.to_scene = json["to_scene"].toInt();
         }
 
-        // Auto derive duration from audio/video resources when JSON omits it
+        if (json.contains("audio_crossfade") && json["audio_crossfade"].isBool())
+        {
+            scene.audio_crossfade = json["audio_crossfade"].toBool();
+        }
+
+        // 未显式指定 duration 时，时长在所有场景解析完成后由媒体探测统一推导（见 resolveSceneDuration）
         if (json.contains("duration") && json["duration"].isDouble())
         {
             scene.duration = json["duration"].toDouble();
         }
-        else
-        {
-            double audioDrivenDuration = -1.0;
-            bool hasAudioResource = false;
-            auto updateAudioDuration = [&](const std::string &path) {
-                if (path.empty())
-                {
-                    return;
-                }
-                hasAudioResource = true;
-                double audioDuration = getAudioDuration(path);
-                if (audioDuration > audioDrivenDuration)
-                {
-                    audioDrivenDuration = audioDuration;
-                }
-            };
+        return true;
+    }
 
-            updateAudioDuration(scene.resources.audio.path);
-            for (const auto &layerConfig : scene.resources.audio_layers)
+    void ConfigLoader::resolveSceneDuration(SceneConfig &scene)
+    {
+        double audioDrivenDuration = -1.0;
+        bool hasAudioResource = false;
+        auto updateAudioDuration = [&](const std::string &path) {
+            if (path.empty())
+            {
+                return;
+            }
+            hasAudioResource = true;
+            double audioDuration = getAudioDuration(path);
+            if (audioDuration > audioDrivenDuration)
             {
-                updateAudioDuration(layerConfig.path);
+                audioDrivenDuration = audioDuration;
             }
+        };
 
-            if (scene.type == SceneType::IMAGE_SCENE && audioDrivenDuration > 0)
+        updateAudioDuration(scene.resources.audio.path);
+        for (const auto &layerConfig : scene.resources.audio_layers)
+        {
+            updateAudioDuration(layerConfig.path);
+        }
+
+        if (scene.type == SceneType::IMAGE_SCENE && audioDrivenDuration > 0)
+        {
+            scene.duration = audioDrivenDuration;
+            qDebug() << "Scene duration synced to audio length:"
+                     << audioDrivenDuration
+                     << "seconds";
+        }
+        else if (scene.type == SceneType::VIDEO_SCENE && !scene.resources.video.path.empty())
+        {
+            double videoDuration = getVideoDuration(scene.resources.video.path);
+            if (videoDuration > 0)
+            {
+                scene.duration = videoDuration;
+                qDebug() << "Scene duration synced to video length:"
+                         << videoDuration
+                         << "seconds";
+            }
+            else if (audioDrivenDuration > 0)
             {
                 scene.duration = audioDrivenDuration;
-                qDebug() << "Scene duration synced to audio length:"
+                qDebug() << "Scene duration uses audio length for video scene:"
                          << audioDrivenDuration
                          << "seconds";
             }
-            else if (scene.type == SceneType::VIDEO_SCENE && !scene.resources.video.path.empty())
+            else
             {
-                double videoDuration = getVideoDuration(scene.resources.video.path);
-                if (videoDuration > 0)
-                {
-                    scene.duration = videoDuration;
-                    qDebug() << "Scene duration synced to video length:"
-                             << videoDuration
-                             << "seconds";
-                }
-                else if (audioDrivenDuration > 0)
-                {
-                    scene.duration = audioDrivenDuration;
-                    qDebug() << "Scene duration uses audio length for video scene:"
-                             << audioDrivenDuration
-                             << "seconds";
-                }
-                else
-                {
-                    scene.duration = 5.0;
-                    qDebug() << "Failed to get video duration, fallback to 5 seconds.";
-                }
+                scene.duration = 5.0;
+                qDebug() << "Failed to get video duration, fallback to 5 seconds.";
             }
-            else if (scene.type == SceneType::IMAGE_SCENE)
+        }
+        else if (scene.type == SceneType::IMAGE_SCENE)
+        {
+            scene.duration = 5.0;
+            if (hasAudioResource)
             {
-                scene.duration = 5.0;
-                if (hasAudioResource)
-                {
-                    qDebug() << "Failed to get audio duration, fallback to 5 seconds.";
-                }
-                else
-                {
-                    qDebug() << "Scene has no audio, fallback to 5 seconds.";
-                }
+                qDebug() << "Failed to get audio duration, fallback to 5 seconds.";
             }
-            else if (scene.type == SceneType::VIDEO_SCENE)
+            else
             {
-                if (audioDrivenDuration > 0)
-                {
-                    scene.duration = audioDrivenDuration;
-                    qDebug() << "Scene duration uses audio length for video scene:"
-                             << audioDrivenDuration
-                             << "seconds";
-                }
-                else
-                {
-                    scene.duration = 5.0;
-                    qDebug() << "Video scene missing resources, fallback to 5 seconds.";
-                }
+                qDebug() << "Scene has no audio, fallback to 5 seconds.";
+            }
+        }
+        else if (scene.type == SceneType::VIDEO_SCENE)
+        {
+            if (audioDrivenDuration > 0)
+            {
+                scene.duration = audioDrivenDuration;
+                qDebug() << "Scene duration uses audio length for video scene:"
+                         << audioDrivenDuration
+                         << "seconds";
+            }
+            else
+            {
+                scene.duration = 5.0;
+                qDebug() << "Video scene missing resources, fallback to 5 seconds.";
             }
         }
-        return true;
     }
 
     bool ConfigLoader::parseResourcesConfig(const QJsonObject &json, ResourcesConfig &resources)
@@ -366,6 +644,80 @@ namespace VideoCreator
             audio.start_offset = json["start_offset"].toDouble();
         }
 
+        if (json.contains("ducking") && json["ducking"].isObject())
+        {
+            parseDuckingConfig(json["ducking"].toObject(), audio.ducking);
+        }
+
+        return true;
+    }
+
+    void ConfigLoader::parseDuckingConfig(const QJsonObject &json, DuckingConfig &ducking)
+    {
+        ducking.enabled = json.contains("enabled") ? json["enabled"].toBool() : true;
+        if (json.contains("amount_db") && json["amount_db"].isDouble())
+        {
+            ducking.amount_db = json["amount_db"].toDouble();
+        }
+        if (json.contains("threshold_db") && json["threshold_db"].isDouble())
+        {
+            ducking.threshold_db = json["threshold_db"].toDouble();
+        }
+        if (json.contains("attack") && json["attack"].isDouble())
+        {
+            ducking.attack = json["attack"].toDouble();
+        }
+        if (json.contains("release") && json["release"].isDouble())
+        {
+            ducking.release = json["release"].toDouble();
+        }
+    }
+
+    bool ConfigLoader::parseAudioTrackConfig(const QJsonObject &json, AudioTrackConfig &track)
+    {
+        if (json.contains("path") && json["path"].isString())
+        {
+            track.path = json["path"].toString().toUtf8().toStdString();
+        }
+        if (track.path.empty())
+        {
+            m_errorString = "audio_tracks 中的音轨缺少 path";
+            return false;
+        }
+
+        if (json.contains("start") && json["start"].isDouble())
+        {
+            track.start = json["start"].toDouble();
+        }
+        if (json.contains("end") && json["end"].isDouble())
+        {
+            track.end = json["end"].toDouble();
+        }
+        if (track.end >= 0 && track.end <= track.start)
+        {
+            m_errorString = QString("音轨 end 必须大于 start: %1").arg(QString::fromStdString(track.path));
+            return false;
+        }
+        if (json.contains("source_offset") && json["source_offset"].isDouble())
+        {
+            track.source_offset = json["source_offset"].toDouble();
+        }
+        if (json.contains("volume") && json["volume"].isDouble())
+        {
+            track.volume = json["volume"].toDouble();
+        }
+        if (json.contains("fade_in") && json["fade_in"].isDouble())
+        {
+            track.fade_in = json["fade_in"].toDouble();
+        }
+        if (json.contains("fade_out") && json["fade_out"].isDouble())
+        {
+            track.fade_out = json["fade_out"].toDouble();
+        }
+        if (json.contains("ducking") && json["ducking"].isObject())
+        {
+            parseDuckingConfig(json["ducking"].toObject(), track.ducking);
+        }
         return true;
     }
 
@@ -574,6 +926,141 @@ namespace VideoCreator
         return true;
     }
 
+    bool ConfigLoader::parseOutputConfig(const QJsonObject &json, OutputConfig &output)
+    {
+        if (json.contains("mode") && json["mode"].isString())
+        {
+            QString mode = json["mode"].toString();
+            if (mode != "mp4" && mode != "fragmented_mp4" && mode != "hls" && mode != "dash"
+                && mode != "m4a" && mode != "mp3" && mode != "wav")
+            {
+                m_errorString = QString("不支持的输出模式: %1").arg(mode);
+                return false;
+            }
+            output.mode = mode.toStdString();
+        }
+
+        if (json.contains("fragment_duration") && json["fragment_duration"].isDouble())
+        {
+            output.fragment_duration = json["fragment_duration"].toDouble();
+        }
+
+        if (json.contains("segment_duration") && json["segment_duration"].isDouble())
+        {
+            output.segment_duration = json["segment_duration"].toDouble();
+            if (output.segment_duration <= 0)
+            {
+                m_errorString = "segment_duration 必须大于 0";
+                return false;
+            }
+        }
+
+        if (json.contains("segment_type") && json["segment_type"].isString())
+        {
+            QString segmentType = json["segment_type"].toString();
+            if (segmentType != "fmp4" && segmentType != "mpegts")
+            {
+                m_errorString = QString("不支持的分段格式: %1").arg(segmentType);
+                return false;
+            }
+            output.segment_type = segmentType.toStdString();
+        }
+
+        if (json.contains("align_to_scenes") && json["align_to_scenes"].isBool())
+        {
+            output.align_to_scenes = json["align_to_scenes"].toBool();
+        }
+
+        if (json.contains("renditions") && json["renditions"].isArray())
+        {
+            output.renditions.clear();
+            for (const QJsonValue &renditionValue : json["renditions"].toArray())
+            {
+                if (!renditionValue.isObject())
+                {
+                    continue;
+                }
+                RenditionConfig rendition;
+                if (!parseRenditionConfig(renditionValue.toObject(), rendition))
+                {
+                    return false;
+                }
+                output.renditions.push_back(rendition);
+            }
+            // 额外档位各自写一个完整的 mp4 文件，分片/分段与纯音频输出不支持
+            if (!output.renditions.empty() && output.mode != "mp4")
+            {
+                m_errorString = QString("renditions 仅支持 mp4 输出模式，当前为: %1").arg(QString::fromStdString(output.mode));
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool ConfigLoader::parseRenditionConfig(const QJsonObject &json, RenditionConfig &rendition)
+    {
+        if (json.contains("output_path") && json["output_path"].isString())
+        {
+            rendition.output_path = json["output_path"].toString().toUtf8().toStdString();
+        }
+        if (rendition.output_path.empty())
+        {
+            m_errorString = "renditions 中的档位缺少 output_path";
+            return false;
+        }
+
+        if (json.contains("width") && json["width"].isDouble())
+        {
+            rendition.width = json["width"].toInt();
+        }
+        if (json.contains("height") && json["height"].isDouble())
+        {
+            rendition.height = json["height"].toInt();
+        }
+        // yuv420p 要求宽高为偶数
+        if (rendition.width <= 0 || rendition.height <= 0 || rendition.width % 2 != 0 || rendition.height % 2 != 0)
+        {
+            m_errorString = QString("档位宽高必须为正偶数: %1").arg(QString::fromStdString(rendition.output_path));
+            return false;
+        }
+
+        if (json.contains("bitrate") && json["bitrate"].isString())
+        {
+            rendition.bitrate = json["bitrate"].toString().toStdString();
+        }
+        if (json.contains("crf") && json["crf"].isDouble())
+        {
+            rendition.crf = json["crf"].toInt();
+        }
+        return true;
+    }
+
+    bool ConfigLoader::parsePerformanceConfig(const QJsonObject &json, PerformanceConfig &performance)
+    {
+        if (json.contains("audio_prerender") && json["audio_prerender"].isBool())
+        {
+            performance.audio_prerender = json["audio_prerender"].toBool();
+        }
+
+        if (json.contains("smart_render") && json["smart_render"].isBool())
+        {
+            performance.smart_render = json["smart_render"].toBool();
+        }
+
+        if (json.contains("scale_threads"))
+        {
+            performance.scale_threads = json["scale_threads"].toInt();
+            if (performance.scale_threads < 0)
+            {
+                m_errorString = "performance.scale_threads 不能为负数";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
     SceneType ConfigLoader::stringToSceneType(const QString &typeStr)
     {
         if (typeStr == "image_scene")
@@ -596,6 +1083,95 @@ namespace VideoCreator
         return TransitionType::CROSSFADE; // 默认值
     }
 
+    void ConfigLoader::prefetchMediaDurations(const std::vector<SceneConfig> &scenes, const std::vector<size_t> &sceneIndices)
+    {
+        struct ProbeTask
+        {
+            std::string path;
+            bool isVideo;
+            double duration;
+            int sampleRate;
+        };
+
+        // 与 resolveSceneDuration 的访问集合一致：所有音频资源，以及视频场景的视频文件
+        std::vector<ProbeTask> tasks;
+        std::unordered_set<std::string> queuedAudio;
+        std::unordered_set<std::string> queuedVideo;
+        auto enqueue = [&](const std::string &path, bool isVideo) {
+            const std::string key = normalizedPath(path);
+            if (key.empty())
+            {
+                return;
+            }
+            auto &cache = isVideo ? m_videoDurationCache : m_audioDurationCache;
+            auto &queued = isVideo ? queuedVideo : queuedAudio;
+            if (cache.count(key) || !queued.insert(key).second)
+            {
+                return;
+            }
+            tasks.push_back({key, isVideo, -1.0, 0});
+        };
+
+        for (size_t sceneIndex : sceneIndices)
+        {
+            const SceneConfig &scene = scenes[sceneIndex];
+            enqueue(scene.resources.audio.path, false);
+            for (const auto &layerConfig : scene.resources.audio_layers)
+            {
+                enqueue(layerConfig.path, false);
+            }
+            if (scene.type == SceneType::VIDEO_SCENE)
+            {
+                enqueue(scene.resources.video.path, true);
+            }
+        }
+
+        if (tasks.empty())
+        {
+            return;
+        }
+
+        // 探测以 I/O 等待为主（网络存储），线程数可以略高于核心数，但需有上限
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        if (hardwareThreads == 0)
+        {
+            hardwareThreads = 4;
+        }
+        const size_t workerCount = std::min<size_t>(tasks.size(), std::min(16u, hardwareThreads * 2));
+
+        // 每个任务只写自己的槽位，探测函数不访问成员状态，无需加锁
+        std::atomic<size_t> nextTask{0};
+        auto worker = [&tasks, &nextTask]() {
+            size_t index;
+            while ((index = nextTask.fetch_add(1)) < tasks.size())
+            {
+                ProbeTask &task = tasks[index];
+                task.duration = task.isVideo ? probeVideoDuration(task.path, &task.sampleRate) : probeAudioDuration(task.path, &task.sampleRate);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(workerCount > 0 ? workerCount - 1 : 0);
+        for (size_t i = 1; i < workerCount; ++i)
+        {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto &thread : workers)
+        {
+            thread.join();
+        }
+
+        for (const auto &task : tasks)
+        {
+            auto &cache = task.isVideo ? m_videoDurationCache : m_audioDurationCache;
+            cache[task.path] = task.duration;
+            m_sampleRateCache[task.path] = task.sampleRate;
+            recordProbeStamp(task.path);
+        }
+        qDebug() << "Probed" << tasks.size() << "media files with" << workerCount << "threads";
+    }
+
     double ConfigLoader::getAudioDuration(const std::string &audioPath)
     {
         const std::string key = normalizedPath(audioPath);
@@ -611,8 +1187,11 @@ namespace VideoCreator
             return cachedIt->second;
         }
 
-        double duration = probeAudioDuration(key);
+        int sampleRate = 0;
+        double duration = probeAudioDuration(key, &sampleRate);
         m_audioDurationCache[key] = duration;
+        m_sampleRateCache[key] = sampleRate;
+        recordProbeStamp(key);
         return duration;
     }
 
@@ -631,147 +1210,82 @@ namespace VideoCreator
             return cachedIt->second;
         }
 
-        double duration = probeVideoDuration(key);
+        int sampleRate = 0;
+        double duration = probeVideoDuration(key, &sampleRate);
         m_videoDurationCache[key] = duration;
+        m_sampleRateCache[key] = sampleRate;
+        recordProbeStamp(key);
         return duration;
     }
 
-    double ConfigLoader::probeAudioDuration(const std::string &audioPath)
+    double ConfigLoader::probeAudioDuration(const std::string &audioPath, int *sampleRate)
     {
-        if (audioPath.empty())
-        {
-            return -1.0;
-        }
-
-        QFileInfo info(QString::fromStdString(audioPath));
-        QFile file(info.absoluteFilePath());
-        if (!file.exists())
-        {
-            qDebug() << "Audio file not found:" << info.absoluteFilePath();
-            return -1.0;
-        }
-
-        AVFormatContext *formatCtx = nullptr;
-        int ret = avformat_open_input(&formatCtx, audioPath.c_str(), nullptr, nullptr);
-        if (ret < 0)
-        {
-            char errbuf[256];
-            av_strerror(ret, errbuf, sizeof(errbuf));
-            qDebug() << "Failed to open audio file:" << info.absoluteFilePath();
-            qDebug() << "FFmpeg error:" << errbuf;
-            return -1.0;
-        }
-
-        ret = avformat_find_stream_info(formatCtx, nullptr);
-        if (ret < 0)
-        {
-            char errbuf[256];
-            av_strerror(ret, errbuf, sizeof(errbuf));
-            qDebug() << "Failed to read audio stream info:" << info.absoluteFilePath();
-            qDebug() << "FFmpeg error:" << errbuf;
-            avformat_close_input(&formatCtx);
-            return -1.0;
-        }
-
-        int audioStreamIndex = -1;
-        for (unsigned int i = 0; i < formatCtx->nb_streams; i++)
-        {
-            if (formatCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO)
-            {
-                audioStreamIndex = i;
-                break;
-            }
-        }
-
-        if (audioStreamIndex == -1)
-        {
-            qDebug() << "No audio stream in file:" << info.absoluteFilePath();
-            avformat_close_input(&formatCtx);
-            return -1.0;
-        }
-
-        double duration = 0.0;
-        if (formatCtx->duration != AV_NOPTS_VALUE)
-        {
-            duration = formatCtx->duration / (double)AV_TIME_BASE;
-        }
-        else if (formatCtx->streams[audioStreamIndex]->duration != AV_NOPTS_VALUE)
-        {
-            AVStream *stream = formatCtx->streams[audioStreamIndex];
-            duration = stream->duration * av_q2d(stream->time_base);
-        }
-
-        avformat_close_input(&formatCtx);
-        return duration > 0 ? duration : -1.0;
+        return probeMediaDuration(audioPath, AVMEDIA_TYPE_AUDIO, sampleRate);
     }
 
-    double ConfigLoader::probeVideoDuration(const std::string &videoPath)
+    double ConfigLoader::probeVideoDuration(const std::string &videoPath, int *sampleRate)
     {
-        if (videoPath.empty())
-        {
-            return -1.0;
-        }
+        return probeMediaDuration(videoPath, AVMEDIA_TYPE_VIDEO, sampleRate);
+    }
 
-        QFileInfo info(QString::fromStdString(videoPath));
-        QFile file(info.absoluteFilePath());
-        if (!file.exists())
-        {
-            qDebug() << "Video file not found:" << info.absoluteFilePath();
-            return -1.0;
-        }
+    int ConfigLoader::resolveDominantSampleRate(const ProjectConfig &config)
+    {
+        constexpr int kDefaultSampleRate = 44100;
 
-        AVFormatContext *formatCtx = nullptr;
-        int ret = avformat_open_input(&formatCtx, videoPath.c_str(), nullptr, nullptr);
-        if (ret < 0)
+        // 显式时长的场景此前未被探测，这里补齐（已缓存的路径会被跳过）
+        std::vector<size_t> allScenes(config.scenes.size());
+        for (size_t i = 0; i < allScenes.size(); ++i)
         {
-            char errbuf[256];
-            av_strerror(ret, errbuf, sizeof(errbuf));
-            qDebug() << "Failed to open video file:" << info.absoluteFilePath();
-            qDebug() << "FFmpeg error:" << errbuf;
-            return -1.0;
+            allScenes[i] = i;
         }
+        prefetchMediaDurations(config.scenes, allScenes);
 
-        ret = avformat_find_stream_info(formatCtx, nullptr);
-        if (ret < 0)
-        {
-            char errbuf[256];
-            av_strerror(ret, errbuf, sizeof(errbuf));
-            qDebug() << "Failed to read video stream info:" << info.absoluteFilePath();
-            qDebug() << "FFmpeg error:" << errbuf;
-            avformat_close_input(&formatCtx);
-            return -1.0;
-        }
+        // 按素材时长加权统计各采样率，时长未知的素材计 1 秒
+        std::map<int, double> weights;
+        auto addInput = [&](const std::string &path, bool isVideo) {
+            if (path.empty())
+            {
+                return;
+            }
+            const double duration = isVideo ? getVideoDuration(path) : getAudioDuration(path);
+            auto it = m_sampleRateCache.find(normalizedPath(path));
+            if (it == m_sampleRateCache.end() || it->second <= 0)
+            {
+                return;
+            }
+            weights[it->second] += duration > 0 ? duration : 1.0;
+        };
 
-        int videoStreamIndex = -1;
-        for (unsigned int i = 0; i < formatCtx->nb_streams; i++)
+        for (const auto &scene : config.scenes)
         {
-            if (formatCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
+            addInput(scene.resources.audio.path, false);
+            for (const auto &layerConfig : scene.resources.audio_layers)
+            {
+                addInput(layerConfig.path, false);
+            }
+            if (scene.type == SceneType::VIDEO_SCENE && scene.resources.video.use_audio)
             {
-                videoStreamIndex = i;
-                break;
+                addInput(scene.resources.video.path, true);
             }
         }
-
-        if (videoStreamIndex == -1)
+        for (const auto &track : config.audio_tracks)
         {
-            qDebug() << "No video stream in file:" << info.absoluteFilePath();
-            avformat_close_input(&formatCtx);
-            return -1.0;
+            addInput(track.path, false);
         }
 
-        double duration = 0.0;
-        if (formatCtx->duration != AV_NOPTS_VALUE)
+        int dominantRate = kDefaultSampleRate;
+        double dominantWeight = 0.0;
+        for (const auto &entry : weights)
         {
-            duration = formatCtx->duration / (double)AV_TIME_BASE;
-        }
-        else if (formatCtx->streams[videoStreamIndex]->duration != AV_NOPTS_VALUE)
-        {
-            AVStream *stream = formatCtx->streams[videoStreamIndex];
-            duration = stream->duration * av_q2d(stream->time_base);
+            // 权重相同时取较高的采样率（map 升序遍历，>= 使后者胜出）
+            if (entry.second >= dominantWeight)
+            {
+                dominantRate = entry.first;
+                dominantWeight = entry.second;
+            }
         }
-
-        avformat_close_input(&formatCtx);
-        return duration > 0 ? duration : -1.0;
+        qDebug() << "Project sample rate resolved to" << dominantRate << "Hz from" << weights.size() << "input rate(s)";
+        return dominantRate;
     }
 
     std::string ConfigLoader::normalizedPath(const std::string &path) const
@@ -786,4 +1300,37 @@ namespace VideoCreator
         return normalized.toStdString();
     }
 
+    void ConfigLoader::recordProbeStamp(const std::string &normalizedPath)
+    {
+        if (!m_retainProbeCache)
+        {
+            return;
+        }
+        m_probeStamps[normalizedPath] = fileStamp(normalizedPath);
+    }
+
+    void ConfigLoader::dropStaleProbes()
+    {
+        std::vector<std::string> stale;
+        auto collect = [&](const auto &cache) {
+            for (const auto &entry : cache)
+            {
+                auto stampIt = m_probeStamps.find(entry.first);
+                if (stampIt == m_probeStamps.end() || fileStamp(entry.first) != stampIt->second)
+                {
+                    stale.push_back(entry.first);
+                }
+            }
+        };
+        collect(m_audioDurationCache);
+        collect(m_videoDurationCache);
+        for (const auto &path : stale)
+        {
+            m_audioDurationCache.erase(path);
+            m_videoDurationCache.erase(path);
+            m_sampleRateCache.erase(path);
+            m_probeStamps.erase(path);
+        }
+    }
+
 } // namespace VideoCreator
@@ -11,6 +11,11 @@
 #include <unordered_map>
 #include "ProjectConfig.h"
 
+extern "C"
+{
+#include <libavutil/avutil.h>
+}
+
 namespace VideoCreator
 {
 
@@ -19,19 +24,28 @@ namespace VideoCreator
     public:
         ConfigLoader() = default;
 
-        // 从JSON文件加载配置
+        // 从JSON文件或编译工程文件加载配置（按文件头自动识别）
         bool loadFromFile(const QString &filePath, ProjectConfig &config);
 
+        // 将本加载器载入的工程（含媒体探测快照）写为编译工程文件
+        bool compileToFile(const ProjectConfig &config, const QString &filePath);
+
         // 从JSON字符串加载配置
         bool loadFromString(const QString &jsonString, ProjectConfig &config);
 
+        // 在多次加载之间保留媒体探测缓存（守护模式），文件大小或修改时间变化的条目在下次加载时重新探测
+        void setRetainProbeCache(bool retain) { m_retainProbeCache = retain; }
+
         // 获取错误信息
         QString errorString() const { return m_errorString; }
 
     private:
         QString m_errorString;
+        bool m_retainProbeCache = false;
+        std::unordered_map<std::string, std::pair<int64_t, int64_t>> m_probeStamps; // 规范化路径 -> 探测时的文件大小与修改时间（保留缓存时记录）
         std::unordered_map<std::string, double> m_audioDurationCache;
         std::unordered_map<std::string, double> m_videoDurationCache;
+        std::unordered_map<std::string, int> m_sampleRateCache; // 规范化路径 -> 首个音频流采样率（0 表示未知）
 
         // 解析项目配置
         bool parseProjectConfig(const QJsonObject &json, ProjectInfoConfig &project);
@@ -71,13 +85,47 @@ namespace VideoCreator
         // 解析音频编码配置
         bool parseAudioEncodingConfig(const QJsonObject &json, AudioEncodingConfig &config);
 
+        // 解析工程级音轨
+        bool parseAudioTrackConfig(const QJsonObject &json, AudioTrackConfig &track);
+
+        // 解析闪避配置
+        void parseDuckingConfig(const QJsonObject &json, DuckingConfig &ducking);
+
+        // 解析输出容器配置
+        bool parseOutputConfig(const QJsonObject &json, OutputConfig &output);
+
+        // 解析额外输出档位
+        bool parseRenditionConfig(const QJsonObject &json, RenditionConfig &rendition);
+
+        // 解析渲染性能配置
+        bool parsePerformanceConfig(const QJsonObject &json, PerformanceConfig &performance);
+
+        // 根据媒体时长推导未显式指定 duration 的场景时长（需先调用 prefetchMediaDurations）
+        void resolveSceneDuration(SceneConfig &scene);
+
+        // 收集场景引用的去重媒体路径，在有界线程池中并行探测并写入时长缓存
+        void prefetchMediaDurations(const std::vector<SceneConfig> &scenes, const std::vector<size_t> &sceneIndices);
+
         // 获取音频文件时长（秒）
         double getAudioDuration(const std::string &audioPath);
         double getVideoDuration(const std::string &videoPath);
-        double probeAudioDuration(const std::string &normalizedPath);
-        double probeVideoDuration(const std::string &normalizedPath);
+
+        // 探测函数不访问成员状态，可在工作线程中并发调用
+        static double probeAudioDuration(const std::string &normalizedPath, int *sampleRate = nullptr);
+        static double probeVideoDuration(const std::string &normalizedPath, int *sampleRate = nullptr);
+
+        // 先做头部快速探测，时长缺失或不可靠时回退到 avformat_find_stream_info
+        // sampleRate 非空时同时返回首个音频流的采样率
+        static double probeMediaDuration(const std::string &normalizedPath, AVMediaType type, int *sampleRate = nullptr);
+
+        // 统计所有音频输入（按时长加权）中占主导的采样率
+        int resolveDominantSampleRate(const ProjectConfig &config);
         std::string normalizedPath(const std::string &path) const;
 
+        // 保留探测缓存时记录文件状态，并在加载前丢弃文件已变化的条目
+        void recordProbeStamp(const std::string &normalizedPath);
+        void dropStaleProbes();
+
         // 字符串到枚举转换
         SceneType stringToSceneType(const QString &typeStr);
         TransitionType stringToTransitionType(const QString &typeStr);
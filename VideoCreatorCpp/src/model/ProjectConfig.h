@@ -49,12 +49,36 @@ namespace VideoCreator
         double rotation = 0.0; // 旋转角度
     };
 
+    // 闪避配置：旁白(resources.audio)响起时自动压低该图层
+    struct DuckingConfig
+    {
+        bool enabled = false;       // 是否启用
+        double amount_db = -12.0;   // 旁白出现时的增益衰减(dB)
+        double threshold_db = -40.0; // 旁白 RMS 超过该电平(dBFS)视为有声
+        double attack = 0.05;       // 压低时间常数(秒)
+        double release = 0.4;       // 恢复时间常数(秒)
+    };
+
     // 音频配置
     struct AudioConfig
     {
         std::string path;          // 音频文件路径
         double volume = 1.0;       // 音量
         double start_offset = 0.0; // 开始偏移时间
+        DuckingConfig ducking;     // 闪避（仅对 audio_layers 生效）
+    };
+
+    // 工程级音轨：按绝对时间跨越多个场景与转场，整个渲染只打开一次
+    struct AudioTrackConfig
+    {
+        std::string path;           // 音频文件路径
+        double start = 0.0;         // 在工程时间线上的起点(秒)
+        double end = -1.0;          // 终点(秒)，-1 表示播放到文件结束
+        double source_offset = 0.0; // 从音频文件的该位置开始播放(秒)
+        double volume = 1.0;        // 音量
+        double fade_in = 0.0;       // 淡入时长(秒)
+        double fade_out = 0.0;      // 淡出时长(秒)，相对音轨结束
+        DuckingConfig ducking;      // 旁白出现时自动压低
     };
 
     // 视频配置
@@ -116,6 +140,7 @@ namespace VideoCreator
         TransitionType transition_type = TransitionType::CROSSFADE; // 转场类型
         int from_scene = 0;                                         // 起始场景ID
         int to_scene = 0;                                           // 目标场景ID
+        bool audio_crossfade = false;                               // 转场期间交叉淡化前后场景音频（否则为静音）
     };
 
     // 音频标准化配置
@@ -158,15 +183,51 @@ namespace VideoCreator
         int width = 1920;                         // 视频宽度
         int height = 1080;                        // 视频高度
         int fps = 30;                             // 帧率
+        int sample_rate = 0;                      // 输出采样率，0 表示取输入素材中占主导的采样率
         std::string background_color = "#000000"; // 背景颜色
     };
 
+    // 额外输出档位（ABR 阶梯）：与主输出共用一次合成与混音，编码前单独缩放
+    struct RenditionConfig
+    {
+        std::string output_path; // 输出路径（mp4）
+        int width = 0;           // 视频宽度
+        int height = 0;          // 视频高度
+        std::string bitrate;     // 视频码率（如 "2500k"），设置后按码率编码
+        int crf = -1;            // 未设置 bitrate 时使用的 crf，-1 表示沿用 video_encoding.crf
+    };
+
+    // 输出容器配置
+    struct OutputConfig
+    {
+        std::string mode = "mp4";       // 输出模式: mp4 / fragmented_mp4 / hls / dash，纯音频导出: m4a / mp3 / wav
+        double fragment_duration = 2.0; // 分片最短时长(秒)，到达后在下一个关键帧切分片
+
+        // 分段输出(hls / dash)，output_path 为播放列表路径(.m3u8 / .mpd)
+        double segment_duration = 4.0;   // 目标分段时长(秒)，按该间隔强制关键帧
+        std::string segment_type = "fmp4"; // HLS 分段格式: fmp4 / mpegts（DASH 固定为 fmp4）
+        bool align_to_scenes = true;     // 在每个场景/转场起点强制关键帧，使分段可在场景边界切分
+
+        std::vector<RenditionConfig> renditions; // 额外输出档位，仅 mp4 模式
+    };
+
+    // 渲染性能相关配置
+    struct PerformanceConfig
+    {
+        bool audio_prerender = false; // 在独立线程中提前混音并编码整条音频时间线，视频线程只负责交错写入
+        bool smart_render = false;    // 与输出编码参数一致、无裁剪无特效的视频场景直接复制压缩包，不重新编码
+        int scale_threads = 0;        // 视频/图片缩放的条带线程数，0 表示按硬件线程数自动选择
+    };
+
     // 项目全局配置
     struct ProjectConfig
     {
         ProjectInfoConfig project;          // 项目基本信息
         std::vector<SceneConfig> scenes;    // 场景列表
         GlobalEffectsConfig global_effects; // 全局效果配置
+        OutputConfig output;                // 输出容器配置
+        std::vector<AudioTrackConfig> audio_tracks; // 工程级音轨
+        PerformanceConfig performance;      // 渲染性能配置
 
         // 默认构造函数
         ProjectConfig()